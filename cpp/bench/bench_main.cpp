@@ -0,0 +1,432 @@
+// OOOP C++ model benchmarks
+//
+// Microbenchmarks for the per-cycle hot paths plus an end-to-end
+// simulation-speed run over trace programs and built-in synthetic loops.
+// Results are CSV on stdout (benchmark,metric,value,unit). With
+// --baseline, each result is compared against a stored CSV and
+// regressions beyond --threshold make the run exit non-zero.
+
+#include "core_impl.h"
+#include "rv32i.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Result {
+    std::string bench;
+    std::string metric;
+    double value;
+    std::string unit;
+};
+
+struct Options {
+    std::vector<std::string> traces;
+    std::string baseline;
+    std::string filter;
+    double threshold = 0.10;
+    uint64_t e2e_cycles = 200000;
+    int reps = 5;
+    bool quick = false;
+};
+
+volatile uint64_t g_sink;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedSec(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+// ---------------------------------------------------------------------------
+// Synthetic throughput loops (never terminate; run for a fixed cycle count)
+// ---------------------------------------------------------------------------
+
+// Dependent ALU chain closed by a backward jump
+std::vector<uint32_t> synthAluChain() {
+    std::vector<uint32_t> p;
+    p.push_back(rv32::addi(5, 0, 1));
+    for (int i = 0; i < 12; i++) {
+        p.push_back(rv32::add(6, 5, 5));
+        p.push_back(rv32::addi(5, 6, -3));
+    }
+    p.push_back(rv32::jal(0, -4 * 24));          // loop
+    return p;
+}
+
+// Independent ALU work, loads/stores and a taken-sometimes branch
+std::vector<uint32_t> synthMemMix() {
+    std::vector<uint32_t> p;
+    p.push_back(rv32::addi(5, 0, 0));
+    p.push_back(rv32::addi(9, 0, 7));
+    // loop:
+    p.push_back(rv32::lw(6, 5, 0));
+    p.push_back(rv32::addi(7, 0, 3));
+    p.push_back(rv32::addi(8, 0, 5));
+    p.push_back(rv32::add(6, 6, 6));
+    p.push_back(rv32::sw(6, 5, 4));
+    p.push_back(rv32::addi(5, 5, 4));
+    p.push_back(rv32::andi(5, 5, 0xFC));
+    p.push_back(rv32::addi(9, 9, -1));
+    p.push_back(rv32::branch(rv32::F3_BNE, 9, 0, -4 * 8));   // loop
+    p.push_back(rv32::addi(9, 0, 7));
+    p.push_back(rv32::jal(0, -4 * 10));          // loop
+    return p;
+}
+
+// ---------------------------------------------------------------------------
+// Harness
+// ---------------------------------------------------------------------------
+
+class Bench {
+public:
+    explicit Bench(const Options& o) : opt(o) {}
+
+    bool selected(const std::string& name) const {
+        return opt.filter.empty() || name.find(opt.filter) != std::string::npos;
+    }
+
+    // Best-of-reps ns per call of fn
+    void micro(const std::string& name, uint64_t iters, const std::function<void()>& setup,
+               const std::function<void(uint64_t)>& fn) {
+        if (!selected(name)) return;
+        if (opt.quick) iters /= 10;
+        double best = 1e30;
+        for (int r = 0; r < opt.reps; r++) {
+            setup();
+            auto t0 = Clock::now();
+            for (uint64_t i = 0; i < iters; i++) {
+                fn(i);
+            }
+            double ns = elapsedSec(t0) * 1e9 / static_cast<double>(iters);
+            if (ns < best) best = ns;
+        }
+        results.push_back({name, "ns_per_op", best, "ns"});
+    }
+
+    // Best-of-reps simulation speed. A program with an end (the trace
+    // programs halt in a self-loop or run off their last word into NOPs)
+    // runs from reset until done(core), again and again until the cycle
+    // budget is used, so that what follows the end is not timed as
+    // pipeline work. The synthetic loops never end and run the budget in
+    // one go.
+    template <typename CoreT = Core, typename Load, typename Done>
+    void endToEnd(const std::string& name, const Load& load, const Done& done) {
+        if (!selected(name)) return;
+        uint64_t budget = opt.quick ? opt.e2e_cycles / 10 : opt.e2e_cycles;
+        double best = 1e30;     // seconds per cycle
+        uint64_t cycles = 0;
+        uint64_t commits = 0;
+        for (int r = 0; r < opt.reps; r++) {
+            CoreT core;
+            load(core);
+            uint64_t run_cycles = 0;
+            uint64_t run_commits = 0;
+            double sec = 0.0;
+            while (run_cycles < budget) {
+                core.reset();
+                uint64_t left = budget - run_cycles;
+                auto t0 = Clock::now();
+                while (core.getCycleCount() < left && !done(core)) {
+                    core.tick();
+                }
+                sec += elapsedSec(t0);
+                run_cycles += core.getCycleCount();
+                run_commits += core.getCommitCount();
+            }
+            if (sec / run_cycles < best) {
+                best = sec / run_cycles;
+                cycles = run_cycles;
+                commits = run_commits;
+            }
+        }
+        double sec = best * cycles;
+        results.push_back({name, "sim_khz", cycles / sec / 1e3, "kHz"});
+        results.push_back({name, "mips", commits / sec / 1e6, "MIPS"});
+        results.push_back({name, "ipc", static_cast<double>(commits) / cycles, "inst/cycle"});
+    }
+
+    const std::vector<Result>& getResults() const { return results; }
+
+private:
+    const Options& opt;
+    std::vector<Result> results;
+};
+
+// The program's words, without the NOPs that fill the rest of the ICache
+std::vector<uint32_t> programWords(const std::string& trace) {
+    ICache ic;
+    std::vector<uint32_t> words;
+    if (!ic.loadProgram(trace)) return words;
+    for (int i = 0; i < ic.getDepthWords(); i++) {
+        words.push_back(ic.peek(i * 4));
+    }
+    while (!words.empty() && words.back() == rv32::NOP) {
+        words.pop_back();
+    }
+    return words;
+}
+
+void runMicro(Bench& b, const std::vector<uint32_t>& mix) {
+    Decode dec;
+
+    // Decode over the instruction mix
+    b.micro("decode", 2000000, [] {}, [&](uint64_t i) {
+        DecodePkt p = dec.decode(true, i * 4, mix[i % mix.size()]);
+        g_sink += p.rd + static_cast<uint64_t>(p.fu_type);
+    });
+
+    // Rename over the same mix (RAT/free list state held fixed)
+    std::vector<DecodePkt> dmix;
+    for (size_t i = 0; i < mix.size(); i++) {
+        dmix.push_back(dec.decode(true, i * 4, mix[i]));
+    }
+    MapTable mt;
+    FreeList fl;
+    Rename ren(&mt, &fl);
+    std::bitset<N_PHYS_REGS> prf_valid;
+    prf_valid.set();
+    b.micro("rename", 2000000, [] {}, [&](uint64_t i) {
+        RenamePkt p = ren.rename(dmix[i % dmix.size()], true, prf_valid, true,
+                                 i & (ROB_DEPTH - 1), true, i % N_CKPT, true);
+        g_sink += p.prd + p.prs1;
+    });
+
+    // FreeList: allocate every cycle, free the preg allocated 64 cycles ago,
+    // checkpoint every fourth cycle
+    std::vector<preg_t> ring(64, 0);
+    b.micro("free_list_tick", 2000000, [&] { fl.reset(); ring.assign(64, 0); },
+            [&](uint64_t i) {
+        preg_t p = fl.getAllocPreg();
+        preg_t old = ring[i & 63];
+        fl.tick(false, false, 0, true, old != 0, old, false, 0, (i & 3) == 0, i % N_CKPT);
+        ring[i & 63] = p;
+    });
+
+    // ROBTagAlloc: 12 of 16 tags live, one allocation and one dispatch per cycle
+    ROBTagAlloc ta;
+    b.micro("rob_tag_alloc_tick", 2000000, [&] { ta.reset(); }, [&](uint64_t i) {
+        std::bitset<ROB_DEPTH> live;
+        for (int k = 0; k < 12; k++) live.set((i + k) & (ROB_DEPTH - 1));
+        rob_tag_t t = ta.getTag(live);
+        ta.tick(false, false, 0, ta.getAllocOk(live), live, true, (t - 1) & (ROB_DEPTH - 1),
+                (i & 3) == 0, t % N_CKPT);
+        g_sink += t;
+    });
+
+    // PRF: three writebacks and one allocation per cycle
+    PRF prf;
+    auto prf_tick = [&](uint64_t i, bool ckpt) {
+        WBPkt a = {true, 0, static_cast<preg_t>(32 + (i % 96)), static_cast<xlen_t>(i), true};
+        WBPkt l = {true, 1, static_cast<preg_t>(32 + ((i + 31) % 96)), static_cast<xlen_t>(i * 3), true};
+        WBPkt r = {true, 2, static_cast<preg_t>(32 + ((i + 63) % 96)), 0, false};
+        prf.tick(false, false, 0, a, l, r, {}, true, static_cast<preg_t>(32 + ((i + 7) % 96)),
+                 ckpt, i % N_CKPT);
+    };
+    b.micro("prf_tick", 2000000, [&] { prf.reset(); }, [&](uint64_t i) { prf_tick(i, false); });
+    b.micro("prf_tick_ckpt", 2000000, [&] { prf.reset(); }, [&](uint64_t i) { prf_tick(i, true); });
+
+    // RS at full occupancy: every entry waits on a preg that never arrives
+    RS rs;
+    std::bitset<N_PHYS_REGS> none;
+    auto fill_rs = [&] {
+        rs.reset();
+        for (int k = 0; k < RS_DEPTH; k++) {
+            RSEntry e = {};
+            e.valid = true;
+            e.rs1_used = true;
+            e.prs1 = static_cast<preg_t>(100 + k);
+            e.prs2_ready = true;
+            e.rob_tag = k;
+            rs.tick(false, false, {}, true, e, {}, {}, {}, {}, false, none);
+        }
+    };
+    b.micro("rs_tick_full", 2000000, fill_rs, [&](uint64_t i) {
+        WBPkt a = {true, 0, static_cast<preg_t>(32 + (i & 63)), 0, true};
+        rs.tick(false, false, {}, false, {}, a, {}, {}, {}, rs.getIssueValid(), none);
+    });
+}
+
+// Counts every pipeline event: the cost of a minimal real observer
+struct CountingObserver : NoObserver {
+    uint64_t events = 0;
+    void onFetch(uint64_t, const FetchPkt&) { events++; }
+    void onDecode(uint64_t, const DecodePkt&) { events++; }
+    void onRename(uint64_t, const RenamePkt&) { events++; }
+    void onDispatch(uint64_t, const RSEntry&) { events++; }
+    void onIssue(uint64_t, const RSEntry&) { events++; }
+    void onWriteback(uint64_t, FUType, const WBPkt&) { events++; }
+    void onCommit(uint64_t, const CommitPkt&) { events++; }
+    void onMispredict(uint64_t, rob_tag_t, xlen_t) { events++; }
+    void onRecover(uint64_t, rob_tag_t, xlen_t) { events++; }
+    void onSquash(uint64_t, rob_tag_t) { events++; }
+};
+
+void runEndToEnd(Bench& b, const Options& opt) {
+    for (const auto& t : opt.traces) {
+        std::string name = t.substr(t.find_last_of('/') + 1);
+        name = "e2e:" + name.substr(0, name.find_last_of('.'));
+        std::vector<uint32_t> words = programWords(t);
+        if (words.empty()) continue;
+        xlen_t end_pc = static_cast<xlen_t>(words.size() * 4);
+        b.endToEnd(name, [&](Core& c) { c.loadProgramWords(words); }, [end_pc](const Core& c) {
+            return c.isHalted() || c.getLastCommitPC() >= end_pc;
+        });
+    }
+
+    std::vector<uint32_t> alu = synthAluChain();
+    std::vector<uint32_t> mem = synthMemMix();
+    auto never = [](const auto&) { return false; };
+    b.endToEnd("e2e:synth_alu_chain", [&](Core& c) { c.loadProgramWords(alu); }, never);
+    b.endToEnd("e2e:synth_mem_mix", [&](Core& c) { c.loadProgramWords(mem); }, never);
+    
+    // Same program through BasicCore<CountingObserver>; e2e:synth_mem_mix
+    // above is BasicCore<NoObserver>, which must not lose speed to the hooks
+    b.endToEnd<BasicCore<CountingObserver>>("e2e:synth_mem_mix_observed",
+        [&](BasicCore<CountingObserver>& c) { c.loadProgramWords(mem); }, never);
+}
+
+// ---------------------------------------------------------------------------
+// Baseline compare
+// ---------------------------------------------------------------------------
+
+bool loadBaseline(const std::string& path, std::map<std::string, double>& out) {
+    std::ifstream f(path);
+    if (!f.is_open()) {
+        std::cerr << "[bench] ERROR: Could not open baseline: " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.empty() || line[0] == '#' || line.rfind("benchmark,", 0) == 0) continue;
+        std::stringstream ss(line);
+        std::string bench, metric, value;
+        std::getline(ss, bench, ',');
+        std::getline(ss, metric, ',');
+        std::getline(ss, value, ',');
+        try {
+            out[bench + "," + metric] = std::stod(value);
+        } catch (...) {
+            continue;
+        }
+    }
+    return true;
+}
+
+// Lower is better for latency metrics, higher for throughput
+bool lowerIsBetter(const std::string& metric) {
+    return metric == "ns_per_op";
+}
+
+int compare(const std::vector<Result>& results, const std::map<std::string, double>& base,
+            double threshold) {
+    int regressions = 0;
+    std::cout << "benchmark,metric,value,unit,baseline,delta_pct,status" << std::endl;
+    for (const auto& r : results) {
+        auto it = base.find(r.bench + "," + r.metric);
+        std::cout << r.bench << "," << r.metric << "," << r.value << "," << r.unit << ",";
+        if (it == base.end() || it->second == 0.0 || r.metric == "ipc") {
+            // IPC is a model property, not a speed; report but never flag it
+            std::cout << (it == base.end() ? "" : std::to_string(it->second)) << ",,"
+                      << (it == base.end() ? "NEW" : "INFO") << std::endl;
+            continue;
+        }
+        double delta = (r.value - it->second) / it->second;
+        bool worse = lowerIsBetter(r.metric) ? (delta > threshold) : (delta < -threshold);
+        bool better = lowerIsBetter(r.metric) ? (delta < -threshold) : (delta > threshold);
+        const char* status = worse ? "REGRESSION" : (better ? "IMPROVED" : "OK");
+        if (worse) regressions++;
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.1f", delta * 100.0);
+        std::cout << it->second << "," << buf << "," << status << std::endl;
+    }
+    return regressions;
+}
+
+void printUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options] [trace.txt ...]" << std::endl;
+    std::cerr << "  --baseline FILE   Compare against a stored CSV and flag regressions" << std::endl;
+    std::cerr << "  --threshold F     Relative change counted as a regression (default: 0.10)" << std::endl;
+    std::cerr << "  --cycles N        Cycles per end-to-end benchmark (default: 200000)" << std::endl;
+    std::cerr << "  --reps N          Repetitions, best is reported (default: 5)" << std::endl;
+    std::cerr << "  --filter STR      Only run benchmarks whose name contains STR" << std::endl;
+    std::cerr << "  --quick           Run a tenth of the iterations" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                printUsage(argv[0]);
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (a == "--baseline") opt.baseline = next();
+        else if (a == "--threshold") opt.threshold = std::stod(next());
+        else if (a == "--cycles") opt.e2e_cycles = std::stoull(next());
+        else if (a == "--reps") opt.reps = std::stoi(next());
+        else if (a == "--filter") opt.filter = next();
+        else if (a == "--quick") opt.quick = true;
+        else if (a == "-h" || a == "--help") { printUsage(argv[0]); return 0; }
+        else if (!a.empty() && a[0] == '-') { printUsage(argv[0]); return 1; }
+        else opt.traces.push_back(a);
+    }
+
+    // Keep the icache loader quiet; only CSV goes to stdout
+    std::streambuf* saved = std::cout.rdbuf();
+    std::ostringstream quiet;
+    std::cout.rdbuf(quiet.rdbuf());
+
+    // Real instruction mix for decode/rename: the trace programs, or the
+    // synthetic loops if none were given
+    std::vector<uint32_t> mix;
+    for (const auto& t : opt.traces) {
+        std::vector<uint32_t> w = programWords(t);
+        for (uint32_t x : w) {
+            if (x != 0x00000013) mix.push_back(x);
+        }
+    }
+    if (mix.empty()) {
+        mix = synthMemMix();
+        std::vector<uint32_t> alu = synthAluChain();
+        mix.insert(mix.end(), alu.begin(), alu.end());
+    }
+
+    Bench b(opt);
+    runMicro(b, mix);
+    runEndToEnd(b, opt);
+
+    std::cout.rdbuf(saved);
+
+    if (!opt.baseline.empty()) {
+        std::map<std::string, double> base;
+        if (!loadBaseline(opt.baseline, base)) return 1;
+        int n = compare(b.getResults(), base, opt.threshold);
+        if (n > 0) {
+            std::cerr << "[bench] " << n << " regression(s) beyond "
+                      << opt.threshold * 100.0 << "%" << std::endl;
+            return 2;
+        }
+        return 0;
+    }
+
+    std::cout << "benchmark,metric,value,unit" << std::endl;
+    for (const auto& r : b.getResults()) {
+        std::cout << r.bench << "," << r.metric << "," << r.value << "," << r.unit << std::endl;
+    }
+    return 0;
+}
@@ -20,8 +20,8 @@ public:
     // Output
     WBPkt getWB() const;
     
-private:
-    xlen_t execute(const RSEntry& entry, xlen_t a, xlen_t b) const;
+    // Combinational ALU (also the first half of a fused compare-and-branch)
+    static xlen_t execute(const RSEntry& entry, xlen_t a, xlen_t b);
 };
 
 #endif // ALU_FU_H
@@ -0,0 +1,165 @@
+#ifndef BATCH_CORE_H
+#define BATCH_CORE_H
+
+#include "types.h"
+#include <array>
+#include <vector>
+
+// LANES independent instances of the Core pipeline advanced in lockstep.
+//
+// Same cycle model as Core::tick, but every piece of state is stored as
+// structure-of-arrays, [index][lane], so one cycle is a sequence of loops
+// over lanes. There are no explicit SIMD lanes: decode, RS select and
+// wakeup, ROB writeback and the checkpoint free-map update are written
+// without per-lane branches so that GCC auto-vectorizes them at -O3 (the
+// ones tagged "// vectorized" in batch_core.cpp, checked by make
+// batch-vec). Per-lane results are bit-identical to Core: same commits,
+// recoveries, registers and memory on every cycle, for RV32I programs
+// (RV32M and its MDU are not modelled).
+//
+// State is roughly 8 KB per lane (mostly instruction and data memory), so
+// allocate large batches on the heap. Instantiated for 4, 8, 16, 32 and 64
+// lanes in batch_core.cpp.
+template <int LANES>
+class BatchCore {
+public:
+    static constexpr int IMEM_WORDS = 512;    // ICache depth
+    static constexpr int DMEM_WORDS = 1024;   // DMem depth
+
+private:
+    template <typename T> using Lanes = std::array<T, LANES>;
+    template <typename T, int N> using Table = std::array<Lanes<T>, N>;
+
+    // Memories
+    Table<uint32_t, IMEM_WORDS> imem;
+    Table<uint32_t, DMEM_WORDS> dmem;
+    Lanes<bool> dm_v1, dm_v2;
+    Lanes<uint32_t> dm_rdata1, dm_rdata2;
+
+    // Fetch and pipeline latches (decoded fields are re-derived from instr)
+    Lanes<uint8_t> fetch_state;               // 0 IDLE, 1 REQ, 2 HAVE
+    Lanes<xlen_t> fetch_pc;
+    Lanes<uint32_t> fetch_instr;
+    Lanes<bool> f2d_valid, d2r_valid;
+    Lanes<xlen_t> f2d_pc, d2r_pc;
+    Lanes<uint32_t> f2d_instr, d2r_instr;
+
+    // Renamed instruction (r2d latch and the one-entry dispatch FIFO)
+    struct RenamedSoA {
+        Lanes<bool> valid;
+        Lanes<xlen_t> pc;
+        Lanes<uint32_t> instr;
+        Lanes<preg_t> prs1, prs2, prd, old_prd;
+        Lanes<bool> prs1_ready, prs2_ready;
+        Lanes<rob_tag_t> rob_tag;
+        Lanes<ckpt_t> ckpt;
+    };
+    RenamedSoA r2d;
+    RenamedSoA disp;
+
+    // Rename state
+    Table<preg_t, N_ARCH_REGS> rat;
+    Table<preg_t, N_ARCH_REGS> arch_rat;
+    std::array<Table<preg_t, N_ARCH_REGS>, N_CKPT> ckpt_rat;
+    Table<uint64_t, 2> free_map;                      // pregs 0-63, 64-127
+    std::array<Table<uint64_t, 2>, N_CKPT> ckpt_free_map;
+    Lanes<rob_tag_t> next_tag;
+    Lanes<uint16_t> tag_reserved;
+    Table<rob_tag_t, N_CKPT> ckpt_next_tag;
+
+    // Checkpoint pool (CkptPool): busy slot mask and the tag holding each
+    Lanes<uint32_t> ckpt_busy;
+    Table<rob_tag_t, N_CKPT> ckpt_owner;
+
+    // PRF (Core's PRF checkpoints are never restored, so they are omitted)
+    Table<xlen_t, N_PHYS_REGS> prf;
+    Table<uint64_t, 2> prf_valid;
+
+    // ROB (flags the lane loops combine are uint8_t 0/1 so they vectorize)
+    Table<uint8_t, ROB_DEPTH> rob_valid, rob_done;
+    Table<bool, ROB_DEPTH> rob_rd_used;
+    Table<rob_tag_t, ROB_DEPTH> rob_tag;
+    Table<xlen_t, ROB_DEPTH> rob_pc;
+    Table<reg_t, ROB_DEPTH> rob_rd;
+    Table<preg_t, ROB_DEPTH> rob_prd, rob_old_prd;
+    Lanes<rob_tag_t> rob_head, rob_tail;
+    Lanes<uint8_t> rob_count;
+    Table<rob_tag_t, N_CKPT> rob_ckpt_tail;
+
+    // Reservation stations (0 ALU, 1 BRU, 2 LSU)
+    struct RSSoA {
+        Table<uint8_t, RS_DEPTH> occupied;
+        Table<xlen_t, RS_DEPTH> pc;
+        Table<uint32_t, RS_DEPTH> instr;
+        Table<preg_t, RS_DEPTH> prs1, prs2, prd;
+        Table<uint8_t, RS_DEPTH> prs1_ready, prs2_ready;
+        Table<rob_tag_t, RS_DEPTH> rob_tag;
+        Table<ckpt_t, RS_DEPTH> ckpt;
+        Table<uint32_t, RS_DEPTH> age;
+        Lanes<uint32_t> age_ctr;
+        bool in_order;
+    };
+    std::array<RSSoA, 3> rs;
+
+    // Writeback pipeline registers
+    struct WBSoA {
+        Lanes<bool> valid;
+        Lanes<rob_tag_t> rob_tag;
+        Lanes<preg_t> prd;          // already 0 when !rd_used
+        Lanes<xlen_t> data;
+        Lanes<bool> rd_used;
+    };
+    WBSoA alu_wb;                   // result computed at issue (execute is pure)
+    WBSoA bru_wb;
+    Lanes<bool> bru_mp;
+    Lanes<xlen_t> bru_tgt;
+    Lanes<rob_tag_t> bru_rtag;
+    Lanes<ckpt_t> bru_ckpt;
+
+    // LSU stages
+    struct LSUMetaSoA {
+        Lanes<bool> v, is_load, rd_used, uns;
+        Lanes<rob_tag_t> rob_tag;
+        Lanes<preg_t> prd;
+        Lanes<uint8_t> size, off;
+    };
+    LSUMetaSoA lsu_m0, lsu_m1;
+    Lanes<uint8_t> lsu_block;
+
+    // Recovery controller
+    Lanes<bool> rc_mp, rc_flush, rc_recover;
+    Lanes<xlen_t> rc_flush_pc;
+    Lanes<rob_tag_t> rc_recover_tag;
+    Lanes<ckpt_t> rc_recover_ckpt;
+
+    // Stats
+    uint64_t cycle_count;
+    Lanes<uint64_t> commit_count;
+    Lanes<uint64_t> recover_count;
+    Lanes<xlen_t> last_commit_pc;
+    Lanes<uint32_t> same_pc_commits;
+
+public:
+    BatchCore();
+
+    void loadProgramWords(int lane, const std::vector<uint32_t>& words);
+    void reset();
+    void tick();
+    void run(uint64_t cycles);
+
+    static constexpr int getLanes() { return LANES; }
+    uint64_t getCycleCount() const { return cycle_count; }
+
+    // Per-lane results, same meaning as the Core getters
+    uint32_t getArchRegValue(int lane, reg_t arch_reg) const;
+    uint64_t getCommitCount(int lane) const { return commit_count[lane]; }
+    uint64_t getRecoverCount(int lane) const { return recover_count[lane]; }
+    xlen_t getLastCommitPC(int lane) const { return last_commit_pc[lane]; }
+    bool isHalted(int lane) const { return same_pc_commits[lane] >= 2; }
+    uint32_t readMemWord(int lane, uint32_t addr) const {
+        return dmem[(addr >> 2) & (DMEM_WORDS - 1)][lane];
+    }
+    int getROBCount(int lane) const { return rob_count[lane]; }
+};
+
+#endif // BATCH_CORE_H
@@ -9,6 +9,14 @@ private:
     bool mp_q;
     xlen_t tgt_q;
     rob_tag_t rtag_q;
+    ckpt_t ckpt_q;          // checkpoint slot of the branch in wb_q
+    FetchPred pred_q;       // fetch-time prediction of the mispredicted one
+    
+    // JAL/JALR in wb_q and where it actually went (predictor training)
+    bool jump_q;
+    xlen_t jump_pc_q;
+    uint32_t jump_instr_q;
+    xlen_t jump_target_q;
 
 public:
     BranchFU();
@@ -22,6 +30,13 @@ public:
     bool getMispredict() const { return mp_q; }
     xlen_t getTargetPC() const { return tgt_q; }
     rob_tag_t getRecoverTag() const { return rtag_q; }
+    ckpt_t getCkptID() const { return ckpt_q; }
+    const FetchPred& getRecoverPred() const { return pred_q; }
+    
+    bool getJumpValid() const { return jump_q; }
+    xlen_t getJumpPC() const { return jump_pc_q; }
+    uint32_t getJumpInstr() const { return jump_instr_q; }
+    xlen_t getJumpTarget() const { return jump_target_q; }
     
 private:
     bool computeTaken(const RSEntry& entry, xlen_t src1, xlen_t src2) const;
@@ -0,0 +1,74 @@
+#ifndef BRANCH_PRED_H
+#define BRANCH_PRED_H
+
+#include "types.h"
+#include <array>
+
+// Fetch-time JAL/JALR prediction from the instruction word in fetch: JAL
+// targets come from predecode, returns from a return address stack and
+// other JALRs from a PC-indexed indirect target table (ITT). Conditional
+// branches stay predicted not-taken. Depth 0 turns prediction off, which
+// is the RTL's always-not-taken front end.
+class BranchPred {
+public:
+    static constexpr int MAX_RAS_DEPTH = 32;
+    static constexpr int ITT_ENTRIES = 32;
+    
+    enum class Kind : uint8_t {
+        NONE,
+        JUMP,       // jal, rd not a link register
+        CALL,       // jal/jalr, rd = x1/x5: pushes pc + 4
+        RETURN,     // jalr, rs1 = x1/x5, rd not a link register: pops
+        INDIRECT    // any other jalr
+    };
+    
+    // JAL/JALR resolved in the BRU on the correct path, by kind
+    struct Stats {
+        uint64_t jumps, jump_miss;
+        uint64_t calls, call_miss;
+        uint64_t returns, return_miss;
+        uint64_t indirect, indirect_miss;
+    };
+    
+private:
+    int ras_depth;
+    std::array<xlen_t, MAX_RAS_DEPTH> ras;
+    uint8_t tos;
+    uint8_t count;          // valid entries, saturating at ras_depth
+    
+    struct ITTEntry {
+        bool valid;
+        xlen_t pc;
+        xlen_t target;
+    };
+    std::array<ITTEntry, ITT_ENTRIES> itt;
+    
+    Stats stats;
+    
+public:
+    BranchPred();
+    void reset();
+    
+    void setRASDepth(int depth);
+    int getRASDepth() const { return ras_depth; }
+    
+    // Combinational: prediction for the instruction in fetch
+    FetchPred predict(xlen_t pc, uint32_t instr) const;
+    
+    // flush: restore the RAS from the mispredicted instruction's pred.
+    // fire: the instruction in fetch moved on, apply its push/pop.
+    // resolve: a JAL/JALR wrote back (train the ITT, count).
+    void tick(bool flush, const FetchPred& recover_pred,
+              bool fire, const FetchPred& fire_pred,
+              bool resolve, xlen_t res_pc, uint32_t res_instr,
+              xlen_t res_target, bool res_mispredict);
+    
+    const Stats& getStats() const { return stats; }
+    
+    static Kind classify(uint32_t instr);
+    
+private:
+    const ITTEntry* lookup(xlen_t pc) const;
+};
+
+#endif // BRANCH_PRED_H
@@ -0,0 +1,40 @@
+#ifndef CKPT_POOL_H
+#define CKPT_POOL_H
+
+#include "types.h"
+#include <bitset>
+#include <vector>
+
+// Branch checkpoint slots. Rename takes the lowest free slot for every
+// branch/jump; the slot is freed when the branch resolves correctly, or
+// at recovery together with the slots of every squashed branch. The
+// MapTable, FreeList, ROBTagAlloc, PRF and ROB snapshots are indexed by
+// slot and sized to `slots` by Core::setCkptSlots, so a smaller pool
+// keeps fewer snapshots than the RTL's one per ROB tag.
+class CkptPool {
+private:
+    std::vector<uint8_t> busy;
+    std::vector<rob_tag_t> owner;   // tag of the branch holding the slot
+    int busy_count;
+    int slots = N_CKPT;             // configuration, kept across reset()
+
+public:
+    CkptPool();
+    void reset();
+    
+    // Slots in the pool, 1..N_CKPT (default N_CKPT); set between runs
+    void setSlots(int n);
+    int getSlots() const { return slots; }
+    
+    void tick(bool flush, bool recover, ckpt_t recover_ckpt,
+              const std::bitset<ROB_DEPTH>& live_tag,
+              bool resolve, ckpt_t resolve_ckpt,
+              bool take, ckpt_t take_ckpt, rob_tag_t take_tag);
+    
+    // Outputs (combinational on current state)
+    bool hasFree() const { return busy_count < slots; }
+    ckpt_t getSlot() const;
+    int getBusyCount() const { return busy_count; }
+};
+
+#endif // CKPT_POOL_H
@@ -0,0 +1,65 @@
+#ifndef COMMIT_CHECK_H
+#define COMMIT_CHECK_H
+
+#include "observer.h"
+#include "iss.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Observer running the ISS in lockstep with commit. Every retired
+// instruction steps the ISS once (a fused pair twice) and must match its
+// PC, destination register and value, and (for stores) address, size
+// and data. The first divergence is recorded and stops run(), so a wrong
+// result is reported at the instruction that produced it rather than at
+// the final a0/a1 check.
+class CommitChecker : public NoObserver {
+public:
+    struct Mismatch {
+        uint64_t cycle;
+        uint64_t commit;            // 1-based index of the retired instruction
+        xlen_t pc;                  // ISS PC (what should have retired)
+        uint32_t instr;
+        std::string what;           // field that differs
+        uint32_t expected;
+        uint32_t got;
+    };
+
+private:
+    ISS iss;
+    bool loaded;                // nothing is checked before a program is loaded
+    uint64_t checked;
+    bool failed;
+    Mismatch first;
+    
+    // Store issued from the ROB head, compared when it retires
+    bool store_valid;
+    rob_tag_t store_tag;
+    uint32_t store_addr;
+    uint32_t store_data;
+    LSSize store_size;
+    
+    void fail(uint64_t cycle, const ISS::StepInfo& s, const char* what,
+              uint32_t expected, uint32_t got);
+
+public:
+    CommitChecker();
+    
+    // Same program as the core's instruction memory; enables checking
+    bool loadProgram(const std::string& filename);
+    void loadProgramWords(const std::vector<uint32_t>& words);
+    void reset();
+    
+    void onStore(uint64_t cycle, rob_tag_t tag, uint32_t addr, uint32_t data, LSSize size);
+    void onCommit(uint64_t cycle, const CommitPkt& c);
+    bool stopRequested() const { return failed; }
+    
+    bool hasFailed() const { return failed; }
+    uint64_t getChecked() const { return checked; }
+    const Mismatch& getMismatch() const { return first; }
+    
+    // One line: commits checked, or the first divergence
+    void report(std::ostream& os) const;
+};
+
+#endif // COMMIT_CHECK_H
@@ -4,6 +4,7 @@
 #include "types.h"
 #include "icache.h"
 #include "fetch.h"
+#include "branch_pred.h"
 #include "decode.h"
 #include "rename.h"
 #include "dispatch.h"
@@ -13,62 +14,335 @@
 #include "map_table.h"
 #include "free_list.h"
 #include "rob_tag_alloc.h"
+#include "ckpt_pool.h"
 #include "alu_fu.h"
 #include "branch_fu.h"
 #include "lsu_fu.h"
+#include "mdu_fu.h"
 #include "dmem.h"
 #include "recovery_ctrl.h"
+#include "observer.h"
+#include "energy.h"
+#include "pipe_queue.h"
+#include <array>
+#include <bitset>
 #include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
 
-class Core {
+// Which thread gets the ICache port when several want it
+enum class FetchPolicy : uint8_t {
+    ROUND_ROBIN = 0,    // the next one after the thread fetched last
+    ICOUNT = 1          // fewest instructions between fetch and issue
+};
+
+struct ThreadStats {
+    uint64_t commits;       // up to the halt
+    uint64_t recoveries;
+    uint64_t fetches;       // cycles the thread had the ICache port
+    uint64_t halt_cycle;    // cycles up to the commit that halted it, 0 if running
+};
+
+// One hardware thread (BasicCore::setThreads): its PC, fetch, predictor
+// and instruction memory, the decode / rename / dispatch queues, RAT,
+// checkpoints, tag allocator, ROB (the tags come from the one ROB_DEPTH
+// tag space) and data memory. Rename uses the core's shared free list.
+struct CoreThread {
+    ICache icache;
+    Fetch fetch;
+    BranchPred bpred;
+    MapTable map_table;
+    ROBTagAlloc rob_tag_alloc;
+    CkptPool ckpt_pool;
+    Rename rename;
+    Dispatch dispatch;
+    ROB rob;
+    DMem dmem;
+    RecoveryCtrl recovery_ctrl;
+    
+    // Inter-stage queues (depth 1: the RTL's skid buffers; the
+    // dispatch FIFO lives in Dispatch)
+    PipeQueue<FetchPkt, MAX_STAGE_QUEUE_DEPTH> f2d;
+    PipeQueue<DecodePkt, MAX_STAGE_QUEUE_DEPTH> d2r;
+    PipeQueue<RenamePkt, MAX_STAGE_QUEUE_DEPTH> r2d;
+    
+    ThreadStats stats;
+    
+    // Halt detection: last committed PC and how often it repeated
+    xlen_t last_commit_pc;
+    uint32_t same_pc_commits;
+    
+    explicit CoreThread(FreeList* free_list) : rename(&map_table, free_list) {}
+    
+    // Checkpoint snapshots kept outside the struct (sized by slot count)
+    size_t getCkptBytes() const {
+        return map_table.getCkptBytes() + rob_tag_alloc.getCkptBytes() + rob.getCkptBytes();
+    }
+};
+
+// Everything a core's future depends on, by value: every module
+// (program images and data memories included), the stage queues, the
+// thread arbitration and the counters (BasicCore::saveState). Not
+// included: the observer, the configuration kept outside the modules
+// (hart id, fetch policy, ROB partitioning) and an attached SharedMem.
+// Rename points at its own thread's map table and the core's free list,
+// so a state only restores into the core that saved it.
+struct CoreState {
+    std::vector<CoreThread> threads;
+    Decode decode;
+    FreeList free_list;
+    RS rs_alu;
+    RS rs_bru;
+    RS rs_lsu;
+    RS rs_mdu;
+    PRF prf;
+    ALUFU alu_fu;
+    BranchFU branch_fu;
+    LSUFU lsu_fu;
+    MDUFU mdu_fu;
+    
+    std::array<uint8_t, ROB_DEPTH> tag_thread;
+    int fetch_last;
+    int rename_last;
+    int dispatch_last;
+    
+    uint64_t cycle_count;
+    uint64_t commit_count;
+    uint64_t recover_count;
+    uint64_t ckpt_stall_count;
+    uint64_t walk_cycles;
+    uint64_t walk_stall_count;
+    uint64_t elim_move_count;
+    uint64_t elim_zero_count;
+    std::array<uint64_t, N_FUSE_RULES> fuse_count;
+    ActivityCounts activity;
+    uint64_t quiet_cycles;
+    
+    size_t bytes() const {
+        size_t n = sizeof(CoreState) + free_list.getCkptBytes() + prf.getCkptBytes();
+        for (const CoreThread& th : threads) n += sizeof(CoreThread) + th.getCkptBytes();
+        return n;
+    }
+};
+
+// Observer receives pipeline events (see observer.h). It is a template
+// parameter rather than a virtual interface so that the default
+// NoObserver costs nothing; Core is the hook-free model.
+template <typename Observer = NoObserver>
+class BasicCore {
+public:
+    // Thread t starts with x1-x31 in P(32t + 1)..P(32t + 31)
+    static constexpr int MAX_THREADS = N_PHYS_REGS / N_ARCH_REGS - 1;
+    
 private:
-    // Components
-    std::unique_ptr<ICache> icache;
-    std::unique_ptr<Fetch> fetch;
+    // Components. Each hardware thread has its own front end, rename
+    // state, ROB and data memory (CoreThread); decode, the free list and
+    // PRF, the RSs and the FUs are shared. One thread is the RTL's core.
+    std::vector<std::unique_ptr<CoreThread>> threads;
     std::unique_ptr<Decode> decode;
-    std::unique_ptr<MapTable> map_table;
     std::unique_ptr<FreeList> free_list;
-    std::unique_ptr<ROBTagAlloc> rob_tag_alloc;
-    std::unique_ptr<Rename> rename;
-    std::unique_ptr<Dispatch> dispatch;
     std::unique_ptr<RS> rs_alu;
     std::unique_ptr<RS> rs_bru;
     std::unique_ptr<RS> rs_lsu;
-    std::unique_ptr<ROB> rob;
+    std::unique_ptr<RS> rs_mdu;
     std::unique_ptr<PRF> prf;
     std::unique_ptr<ALUFU> alu_fu;
     std::unique_ptr<BranchFU> branch_fu;
     std::unique_ptr<LSUFU> lsu_fu;
-    std::unique_ptr<DMem> dmem;
-    std::unique_ptr<RecoveryCtrl> recovery_ctrl;
-    
-    // Pipeline registers (skid buffers would go here)
-    FetchPkt f2d_pkt;
-    bool f2d_valid;
+    std::unique_ptr<MDUFU> mdu_fu;
     
-    DecodePkt d2r_pkt;
-    bool d2r_valid;
+    // Thread of each ROB tag, written when rename hands the tag out
+    std::array<uint8_t, ROB_DEPTH> tag_thread;
     
-    RenamePkt r2d_pkt;
-    bool r2d_valid;
+    // Arbitration between threads: policy, and the last thread to fetch,
+    // rename and dispatch
+    FetchPolicy fetch_policy;
+    bool partition_rob;
+    int fetch_last;
+    int rename_last;
+    int dispatch_last;
     
     // Stats
     uint64_t cycle_count;
     uint64_t commit_count;
+    uint64_t recover_count;
+    uint64_t ckpt_stall_count;      // cycles a branch/jump waited for a checkpoint slot
+    uint64_t walk_cycles;           // cycles spent in ROB-walk recovery
+    uint64_t walk_stall_count;      // of those, cycles a decoded instruction waited
+    uint64_t elim_move_count;       // committed moves done at rename
+    uint64_t elim_zero_count;       // committed zero idioms done at rename
+    std::array<uint64_t, N_FUSE_RULES> fuse_count;  // committed fused pairs per rule
+    ActivityCounts activity;        // structure accesses (energy model)
+    
+    // Set by tick() when nothing moved and every FU, memory and recovery
+    // pipeline is empty except for a division counting down: the next
+    // quiet_cycles ticks would only repeat this one (UINT64_MAX: every
+    // later tick), so run() skips them (Core only; observers see every
+    // cycle)
+    uint64_t quiet_cycles;
+    
+    // Hart id, placed in a0 at reset (RISC-V boot convention); thread t
+    // gets hart id + t
+    uint32_t hart_id;
+    
+    Observer observer;
+    
+    // Event code is left out entirely for NoObserver, so that even the
+    // dead argument computations cannot perturb inlining of tick()
+    static constexpr bool kObserved = !std::is_same_v<Observer, NoObserver>;
 
 public:
-    Core();
-    ~Core();
+    BasicCore();
+    explicit BasicCore(const Observer& obs);
+    ~BasicCore();
     
-    bool loadProgram(const std::string& filename);
+    bool loadProgram(const std::string& filename) { return loadProgram(0, filename); }
+    bool loadProgram(int thread, const std::string& filename);
+    void loadProgramWords(const std::vector<uint32_t>& words);
     void reset();
+    
+    // Reset, then start thread 0 at s.pc with s's registers and data
+    // memory (a checkpoint taken on the ISS, e.g. a SimPoint interval start)
+    void loadArchState(const ArchState& s);
+    
     void tick();
     void run(uint64_t max_cycles);
     
+    // n cycles as run() simulates them (quiet stretches skipped),
+    // without the progress lines
+    void advance(uint64_t n);
+    
+    // Snapshot of the whole core, and going back to one (time travel,
+    // see time_travel.h); the run from a restored state repeats the
+    // original one cycle for cycle
+    CoreState saveState() const;
+    void restoreState(const CoreState& s);
+    
+    // Simultaneous multithreading: 1..MAX_THREADS hardware threads (1,
+    // the default, is the RTL's core). Per cycle one thread fetches
+    // (FetchPolicy), one renames and one dispatches (round robin), one op
+    // issues, and each thread's ROB may retire its head. A mispredict
+    // recovers only its own thread; snapshot recovery then hands the
+    // squashed pregs back to the free list, since a free-list snapshot
+    // would undo the other threads' allocations. A halted thread stops
+    // fetching. New threads take thread 0's configuration and have no
+    // program until loadProgram(thread, ...); the core is reset. The
+    // accessors without a thread argument report thread 0.
+    void setThreads(int n);
+    int getThreads() const { return static_cast<int>(threads.size()); }
+    void setFetchPolicy(FetchPolicy p) { fetch_policy = p; }
+    FetchPolicy getFetchPolicy() const { return fetch_policy; }
+    
+    // Cap each thread at ROB_DEPTH / threads tags instead of sharing all
+    void setROBPartition(bool enable) { partition_rob = enable; }
+    bool getROBPartition() const { return partition_rob; }
+    const ThreadStats& getThreadStats(int thread) const { return threads[thread]->stats; }
+    
     // Get results
-    uint32_t getArchRegValue(reg_t arch_reg) const;
+    uint32_t getArchRegValue(reg_t arch_reg) const { return getArchRegValue(0, arch_reg); }
+    uint32_t getArchRegValue(int thread, reg_t arch_reg) const;
     uint64_t getCycleCount() const { return cycle_count; }
     uint64_t getCommitCount() const { return commit_count; }
+    uint64_t getRecoverCount() const { return recover_count; }
+    uint64_t getCkptStallCount() const { return ckpt_stall_count; }
+    uint64_t getWalkCycles() const { return walk_cycles; }
+    uint64_t getWalkStallCount() const { return walk_stall_count; }
+    uint64_t getElimMoveCount() const { return elim_move_count; }
+    uint64_t getElimZeroCount() const { return elim_zero_count; }
+    uint64_t getFuseCount(FuseRule rule) const { return fuse_count[static_cast<int>(rule)]; }
+    const ActivityCounts& getActivity() const { return activity; }
+    xlen_t getLastCommitPC() const { return threads[0]->last_commit_pc; }
+    
+    // Program is parked in its final self-loop (jalr/jal to itself): the
+    // thread's, or every thread's
+    bool isHalted(int thread) const { return threads[thread]->same_pc_commits >= 2; }
+    bool isHalted() const;
+    
+    // Multi-core: hart id (takes effect at the next reset) and shared data memory
+    void setHartId(uint32_t id) { hart_id = id; }
+    
+    // Recovery mode: 0 restores the branch snapshot in one cycle (default,
+    // as the RTL); W > 0 walks the ROB back from the tail W entries per
+    // cycle, undoing RAT mappings and freeing pregs, with no snapshots
+    void setRecoveryWalk(int width) { for (auto& th : threads) th->rob.setWalkWidth(width); }
+    int getRecoveryWalk() const { return threads[0]->rob.getWalkWidth(); }
+    
+    // Branch checkpoint slots rename may hold, 1..N_CKPT (default N_CKPT,
+    // never stalls); fewer stall a branch/jump at rename while all are
+    // held. Every snapshot array is sized to match. Set between runs.
+    void setCkptSlots(int n);
+    int getCkptSlots() const { return threads[0]->ckpt_pool.getSlots(); }
+    
+    // Fetch-time JAL/JALR prediction with a depth-entry return address
+    // stack; 0 (default) keeps the RTL's always-not-taken front end.
+    // Takes effect at the next reset.
+    void setRASDepth(int depth) { for (auto& th : threads) th->bpred.setRASDepth(depth); }
+    int getRASDepth() const { return threads[0]->bpred.getRASDepth(); }
+    const BranchPred::Stats& getPredStats() const { return threads[0]->bpred.getStats(); }
+    
+    // Decoupled fetch into a depth-entry instruction buffer, one ICache
+    // request per cycle; 0 (default) keeps the RTL's two-cycle fetch FSM.
+    // Takes effect at the next reset.
+    void setFetchBuffer(int depth) { for (auto& th : threads) th->fetch.setBufferDepth(depth); }
+    int getFetchBuffer() const { return threads[0]->fetch.getBufferDepth(); }
+    const Fetch::BufferStats& getFetchBufferStats() const { return threads[0]->fetch.getBufferStats(); }
+    
+    // Entries in one inter-stage queue, 1..MAX_STAGE_QUEUE_DEPTH; 1
+    // (default) is the RTL's single-entry latch or dispatch FIFO. Empties
+    // the queue, so set it between runs.
+    void setQueueDepth(StageQueue q, int depth);
+    int getQueueDepth(StageQueue q) const;
+    
+    // Cycles the queue held 0, 1, ... entries (sampled at the clock edge)
+    const StageQueueHistogram& getQueueOccupancy(StageQueue q) const;
+    
+    // Move / zero-idiom elimination at rename (off by default, as the RTL)
+    void setMoveElimination(bool enable) { for (auto& th : threads) th->rename.setElimination(enable); }
+    bool getMoveElimination() const { return threads[0]->rename.getElimination(); }
+    
+    // Macro-op fusion in decode, bit (1 << FuseRule) per enabled rule; 0
+    // (default) as the RTL. A fused pair is one ROB entry and counts as
+    // two commits.
+    void setFusion(uint32_t rules) { decode->setFusion(rules); }
+    uint32_t getFusion() const { return decode->getFusion(); }
+    
+    // RV32M multiplier latency in cycles (1..MDUFU::MAX_MUL_LATENCY)
+    void setMulLatency(int cycles) { mdu_fu->setMulLatency(cycles); }
+    int getMulLatency() const { return mdu_fu->getMulLatency(); }
+    uint32_t getHartId() const { return hart_id; }
+    void attachMemory(SharedMem* mem, int port) { threads[0]->dmem.attach(mem, port); }
+    
+    // State inspection (for tools, no timing effect)
+    preg_t getArchMapping(reg_t arch_reg) const { return threads[0]->map_table.lookupArch(arch_reg); }
+    uint32_t getPhysRegValue(preg_t preg) const { return prf->read(preg); }
+    bool getPhysRegValid(preg_t preg) const { return prf->isValid(preg); }
+    uint32_t readMemWord(uint32_t addr) const { return readMemWord(0, addr); }
+    uint32_t readMemWord(int thread, uint32_t addr) const { return threads[thread]->dmem.peek(addr); }
+    int getROBCount() const;
+    int getCkptBusy() const;
+    int getRSOccupancy(FUType fu) const;
+    
+    Observer& getObserver() { return observer; }
+    const Observer& getObserver() const { return observer; }
+    
+private:
+    // tick() itself; the one-thread instance has the thread loops and
+    // lookups folded away
+    template <bool kOneThread>
+    void step();
+    
+    // Advance a quiet core by n cycles without ticking
+    void skipQuiet(uint64_t n);
+    
+    // Instructions a thread fetched and has not issued yet (ICOUNT)
+    int inFlightFront(int thread, const std::bitset<ROB_DEPTH>& live) const;
 };
 
+using Core = BasicCore<NoObserver>;
+
+// Member definitions live in core_impl.h; the hook-free core is built once
+// in core.cpp. Include core_impl.h to instantiate a core with an observer.
+extern template class BasicCore<NoObserver>;
+
 #endif // CORE_H
@@ -0,0 +1,993 @@
+#ifndef CORE_IMPL_H
+#define CORE_IMPL_H
+
+#include "core.h"
+#include <algorithm>
+#include <iostream>
+
+template <typename Observer>
+BasicCore<Observer>::BasicCore() {
+    decode = std::make_unique<Decode>();
+    free_list = std::make_unique<FreeList>();
+    rs_alu = std::make_unique<RS>(false);
+    rs_bru = std::make_unique<RS>(true);   // in order: one recovery at a time
+    rs_lsu = std::make_unique<RS>(true);   // in order: memory ordering
+    rs_mdu = std::make_unique<RS>(false);
+    prf = std::make_unique<PRF>();
+    alu_fu = std::make_unique<ALUFU>();
+    branch_fu = std::make_unique<BranchFU>();
+    lsu_fu = std::make_unique<LSUFU>();
+    mdu_fu = std::make_unique<MDUFU>();
+    threads.push_back(std::make_unique<CoreThread>(free_list.get()));
+
+    fetch_policy = FetchPolicy::ROUND_ROBIN;
+    partition_rob = false;
+    hart_id = 0;
+    reset();
+}
+
+template <typename Observer>
+BasicCore<Observer>::BasicCore(const Observer& obs) : BasicCore() {
+    observer = obs;
+}
+
+template <typename Observer>
+BasicCore<Observer>::~BasicCore() = default;
+
+template <typename Observer>
+bool BasicCore<Observer>::loadProgram(int thread, const std::string& filename) {
+    return threads[thread]->icache.loadProgram(filename);
+}
+
+template <typename Observer>
+void BasicCore<Observer>::loadProgramWords(const std::vector<uint32_t>& words) {
+    threads[0]->icache.loadWords(words);
+}
+
+template <typename Observer>
+void BasicCore<Observer>::setThreads(int n) {
+    n = std::clamp(n, 1, MAX_THREADS);
+    const CoreThread& first = *threads[0];
+    while (static_cast<int>(threads.size()) < n) {
+        auto th = std::make_unique<CoreThread>(free_list.get());
+        th->rob.setWalkWidth(first.rob.getWalkWidth());
+        th->bpred.setRASDepth(first.bpred.getRASDepth());
+        th->fetch.setBufferDepth(first.fetch.getBufferDepth());
+        th->rename.setElimination(first.rename.getElimination());
+        th->f2d.setDepth(first.f2d.getDepth());
+        th->d2r.setDepth(first.d2r.getDepth());
+        th->r2d.setDepth(first.r2d.getDepth());
+        th->dispatch.setDepth(first.dispatch.getDepth());
+        threads.push_back(std::move(th));
+    }
+    threads.resize(n);
+    setCkptSlots(getCkptSlots());
+    reset();
+}
+
+template <typename Observer>
+void BasicCore<Observer>::setCkptSlots(int n) {
+    for (auto& th : threads) {
+        th->ckpt_pool.setSlots(n);
+        n = th->ckpt_pool.getSlots();
+        th->map_table.setCkptSlots(n);
+        th->rob_tag_alloc.setCkptSlots(n);
+        th->rob.setCkptSlots(n);
+    }
+    free_list->setCkptSlots(n);
+    prf->setCkptSlots(n);
+}
+
+template <typename Observer>
+void BasicCore<Observer>::reset() {
+    const int n = getThreads();
+    free_list->reset(n * N_ARCH_REGS);
+    rs_alu->reset();
+    rs_bru->reset();
+    rs_lsu->reset();
+    rs_mdu->reset();
+    prf->reset();
+    alu_fu->reset();
+    branch_fu->reset();
+    lsu_fu->reset();
+    mdu_fu->reset();
+
+    for (int t = 0; t < n; t++) {
+        CoreThread& th = *threads[t];
+        th.fetch.reset();
+        th.bpred.reset();
+        th.map_table.reset(static_cast<preg_t>(t * N_ARCH_REGS));
+        th.rob_tag_alloc.reset();
+        th.ckpt_pool.reset();
+        th.dispatch.reset();
+        th.rob.reset();
+        th.dmem.reset();
+        th.recovery_ctrl.reset();
+        th.f2d.reset();
+        th.d2r.reset();
+        th.r2d.reset();
+        th.stats = {};
+        th.last_commit_pc = 0;
+        th.same_pc_commits = 0;
+        
+        // x10 maps to P(32t + 10) out of reset
+        prf->poke(static_cast<preg_t>(t * N_ARCH_REGS + 10), hart_id + t);
+    }
+
+    tag_thread.fill(0);
+    fetch_last = n - 1;
+    rename_last = n - 1;
+    dispatch_last = n - 1;
+    cycle_count = 0;
+    commit_count = 0;
+    recover_count = 0;
+    ckpt_stall_count = 0;
+    walk_cycles = 0;
+    walk_stall_count = 0;
+    elim_move_count = 0;
+    elim_zero_count = 0;
+    fuse_count.fill(0);
+    activity = {};
+    quiet_cycles = 0;
+}
+
+template <typename Observer>
+void BasicCore<Observer>::loadArchState(const ArchState& s) {
+    reset();
+    CoreThread& th = *threads[0];
+    th.fetch.reset(s.pc);
+    
+    // x1-x31 still map to P1-P31 right after reset
+    for (int r = 1; r < N_ARCH_REGS; r++) {
+        prf->poke(r, s.regs[r]);
+    }
+    for (size_t w = 0; w < s.dmem.size(); w++) {
+        th.dmem.poke(w * 4, s.dmem[w]);
+    }
+}
+
+template <typename Observer>
+void BasicCore<Observer>::tick() {
+    if (threads.size() == 1) {
+        step<true>();
+    } else {
+        step<false>();
+    }
+}
+
+template <typename Observer>
+template <bool kOneThread>
+void BasicCore<Observer>::step() {
+    const int n = kOneThread ? 1 : getThreads();
+    auto thread_of = [&](rob_tag_t tag) { return kOneThread ? 0 : static_cast<int>(tag_thread[tag]); };
+    
+    // With one thread the free list keeps its branch snapshots and frees
+    // at commit as the RTL does. Threads share it, so with several a
+    // recovery gives the squashed pregs back one by one instead, and
+    // commits free theirs the same way.
+    const bool shared_free = !kOneThread;
+
+    // ------------------------------------------------------------------
+    // Phase A: evaluate combinational outputs from registered state
+    // ------------------------------------------------------------------
+
+    // Recovery, per thread. live_tag is every thread's ROB; rs_live drops
+    // the entries a recovering thread squashes this cycle.
+    bool walk_mode = threads[0]->rob.getWalkWidth() > 0;
+    std::array<bool, MAX_THREADS> flush{}, recover{}, walking{}, commit{};
+    std::array<std::bitset<ROB_DEPTH>, MAX_THREADS> thread_live;
+    std::bitset<ROB_DEPTH> live_tag, rs_live, reserved;
+    bool any_flush = false;
+    bool any_recover = false;
+    for (int t = 0; t < n; t++) {
+        const CoreThread& th = *threads[t];
+        const RecoveryCtrl& rc = th.recovery_ctrl;
+        flush[t] = rc.getFlush();
+        recover[t] = rc.getRecover();
+        walking[t] = th.rob.isWalking();
+        commit[t] = th.rob.getCommit();
+        thread_live[t] = th.rob.getLiveTag();
+        live_tag |= thread_live[t];
+        rs_live |= !recover[t] ? thread_live[t] :
+                   walk_mode ? th.rob.getLiveTagUpTo(rc.getRecoverTag()) :
+                   th.rob.getRecoverLiveTag(rc.getRecoverCkpt());
+        reserved |= th.rob_tag_alloc.getReserved();
+        any_flush = any_flush || flush[t];
+        any_recover = any_recover || recover[t];
+    }
+
+    // Writeback (one load in flight per DMem slot, so at most one thread's
+    // memory answers)
+    WBPkt wb_alu = alu_fu->getWB();
+    WBPkt wb_bru = branch_fu->getWB();
+    bool dmem_rvalid = false;
+    uint32_t dmem_rdata = 0;
+    for (int t = 0; t < n; t++) {
+        if (threads[t]->dmem.getRValid()) {
+            dmem_rvalid = true;
+            dmem_rdata = threads[t]->dmem.getRData();
+        }
+    }
+    WBPkt wb_lsu = lsu_fu->getWB(dmem_rvalid, dmem_rdata);
+    WBPkt wb_mdu = mdu_fu->getWB();
+
+    // Issue: single-issue select (priority ALU > BRU > LSU > MDU), nothing
+    // of a thread during its flush, and nothing to the LSU and MDU, whose
+    // flush drops a new op, during any. Stores only go to memory once they
+    // reach the head of their thread's ROB; a division waits for the
+    // divider.
+    auto issuable = [&](const RS& rs) {
+        return rs.getIssueValid() && !flush[thread_of(rs.getIssueEntry().rob_tag)];
+    };
+    bool alu_v = issuable(*rs_alu);
+    bool bru_v = issuable(*rs_bru);
+    bool lsu_v = !any_flush && rs_lsu->getIssueValid();
+    bool mdu_v = !any_flush && rs_mdu->getIssueValid() && mdu_fu->canIssue(rs_mdu->getIssueEntry());
+    RSEntry lsu_e = lsu_v ? rs_lsu->getIssueEntry() : RSEntry{};
+    if (lsu_v && lsu_e.is_store) {
+        const ROB& rob = threads[thread_of(lsu_e.rob_tag)]->rob;
+        lsu_v = rob.getHeadValid() && rob.getHeadTag() == lsu_e.rob_tag;
+    }
+    lsu_v = lsu_v && lsu_fu->canIssue();
+
+    bool iss_alu = false, iss_bru = false, iss_lsu = false, iss_mdu = false;
+    RSEntry iss_e = {};
+    if (alu_v) {
+        iss_alu = true;
+        iss_e = rs_alu->getIssueEntry();
+    } else if (bru_v) {
+        iss_bru = true;
+        iss_e = rs_bru->getIssueEntry();
+    } else if (lsu_v) {
+        iss_lsu = true;
+        iss_e = lsu_e;
+    } else if (mdu_v) {
+        iss_mdu = true;
+        iss_e = rs_mdu->getIssueEntry();
+    }
+    int iss_thread = thread_of(iss_e.rob_tag);
+
+    // Register read
+    xlen_t src1 = prf->read(iss_e.prs1);
+    xlen_t src2 = prf->read(iss_e.prs2);
+
+    // Dispatch: one thread, round robin from the one after the last. None
+    // in a recovery cycle: the RSs squash instead of inserting then.
+    bool rs_alu_ready = rs_alu->getReady();
+    bool rs_bru_ready = rs_bru->getReady();
+    bool rs_lsu_ready = rs_lsu->getReady();
+    bool rs_mdu_ready = rs_mdu->getReady();
+    int disp_t = -1;
+    for (int k = 1; k <= n && !any_flush; k++) {
+        int t = (dispatch_last + k) % n;
+        const CoreThread& th = *threads[t];
+        if (th.dispatch.getFire(false, rs_alu_ready, rs_bru_ready, rs_lsu_ready,
+                                rs_mdu_ready, th.rob.getReady())) {
+            disp_t = t;
+            break;
+        }
+    }
+    bool disp_fire = disp_t >= 0;
+    RenamePkt disp_pkt = disp_fire ? threads[disp_t]->dispatch.getOutPkt() : RenamePkt{};
+    RSEntry disp_entry = disp_fire ? threads[disp_t]->dispatch.buildRSEntry(disp_pkt) : RSEntry{};
+    std::array<bool, MAX_THREADS> disp_ready{};
+    for (int t = 0; t < n; t++) {
+        disp_ready[t] = threads[t]->dispatch.getReadyOut(t == disp_t);
+    }
+
+    // Rename: one thread, round robin. A tag is free if no thread's ROB or
+    // rename holds it; a partitioned ROB also caps each thread's share.
+    std::bitset<ROB_DEPTH> tag_used = live_tag | reserved;
+    size_t rob_share = static_cast<size_t>(ROB_DEPTH / n);
+    bool has_free = free_list->hasFree();
+    std::array<bool, MAX_THREADS> tag_ok{}, ckpt_ok{}, r2d_accept{};
+    int ren_t = -1;
+    for (int k = 1; k <= n; k++) {
+        int t = (rename_last + k) % n;
+        const CoreThread& th = *threads[t];
+        tag_ok[t] = th.rob_tag_alloc.getAllocOk(tag_used) &&
+                    (!partition_rob ||
+                     thread_live[t].count() + th.rob_tag_alloc.getReserved().count() < rob_share);
+        ckpt_ok[t] = walk_mode || th.ckpt_pool.hasFree();
+        r2d_accept[t] = th.r2d.getReady(disp_ready[t]);
+        if (ren_t >= 0 || flush[t] || walking[t] || th.d2r.empty()) continue;
+        const DecodePkt& p = th.d2r.front();
+        if (th.rename.getValidOut(p, true, has_free, tag_ok[t], ckpt_ok[t]) &&
+            th.rename.getReadyOut(p, has_free, tag_ok[t], ckpt_ok[t], r2d_accept[t])) {
+            ren_t = t;
+        }
+    }
+    bool rename_fire = ren_t >= 0;
+    RenamePkt rpkt = {};
+    reg_t ren_rd = 0;
+    bool alloc_req = false;
+    bool share_req = false;
+    bool ckpt_take = false;
+    rob_tag_t new_tag = 0;
+    ckpt_t new_ckpt = 0;
+    if (rename_fire) {
+        CoreThread& th = *threads[ren_t];
+        const DecodePkt& p = th.d2r.front();
+        new_tag = th.rob_tag_alloc.getTag(tag_used);
+        new_ckpt = th.ckpt_pool.getSlot();
+        rpkt = th.rename.rename(p, true, prf->getValidBits(), tag_ok[ren_t], new_tag,
+                                ckpt_ok[ren_t], new_ckpt, true);
+        ren_rd = p.rd;
+        alloc_req = th.rename.getAllocReq(p, true);
+        share_req = rpkt.eliminated;
+        ckpt_take = !walk_mode && th.rename.getCheckpointTake(p, true);
+    }
+
+    // Decode, every thread. With fusion on, a possible pair head waits in
+    // the queue until the next instruction is behind it in f2d or at the
+    // fetch output; a fused pair takes both.
+    std::array<FetchPred, MAX_THREADS> fpred{};
+    std::array<DecodePkt, MAX_THREADS> dpkt{};
+    std::array<bool, MAX_THREADS> decode_fire{}, f2d_accept{}, fetch_fire{};
+    std::array<bool, MAX_THREADS> fused_fetch{};    // second half is the fetch output
+    std::array<bool, MAX_THREADS> fused_queued{};   // second half is f2d's next entry
+    for (int t = 0; t < n; t++) {
+        const CoreThread& th = *threads[t];
+        fpred[t] = th.bpred.predict(th.fetch.getPCOut(), th.fetch.getInstrOut());
+        bool f2d_valid = !th.f2d.empty();
+        const FetchPkt& f2d_pkt = th.f2d.front();
+        dpkt[t] = decode->decode(f2d_valid, f2d_pkt.pc, f2d_pkt.instr);
+        dpkt[t].pred = f2d_pkt.pred;
+        bool fuse_wait = false;
+        if (decode->isFusionHead(dpkt[t])) {
+            if (th.f2d.size() > 1) {
+                const FetchPkt& next = th.f2d.at(1);
+                DecodePkt second = decode->decode(true, next.pc, next.instr);
+                second.pred = next.pred;
+                fused_queued[t] = decode->fuse(dpkt[t], second, dpkt[t]) != FuseRule::NONE;
+            } else if (th.fetch.getValidOut()) {
+                DecodePkt second = decode->decode(true, th.fetch.getPCOut(), th.fetch.getInstrOut());
+                second.pred = fpred[t];
+                fused_fetch[t] = decode->fuse(dpkt[t], second, dpkt[t]) != FuseRule::NONE;
+            } else {
+                fuse_wait = true;
+            }
+        }
+        decode_fire[t] = f2d_valid && th.d2r.getReady(t == ren_t) && !fuse_wait;
+        
+        // Fetch (the predictor only redirects JAL/JALR)
+        f2d_accept[t] = th.f2d.getReady(decode_fire[t]);
+        fetch_fire[t] = th.fetch.getValidOut() && f2d_accept[t];
+    }
+
+    // ICache port: one thread per cycle among those requesting. A single
+    // thread always has it (as the RTL); with several, flushing and halted
+    // threads do not ask. ICOUNT favours the thread with the fewest
+    // instructions waiting before issue, ties going round robin.
+    int fetch_t = -1;
+    int best_count = 0;
+    for (int k = 1; k <= n; k++) {
+        int t = (fetch_last + k) % n;
+        const CoreThread& th = *threads[t];
+        if (!th.fetch.getICacheEn() || (!kOneThread && (flush[t] || isHalted(t)))) continue;
+        if (fetch_policy == FetchPolicy::ROUND_ROBIN) {
+            fetch_t = t;
+            break;
+        }
+        int c = inFlightFront(t, thread_live[t]);
+        if (fetch_t < 0 || c < best_count) {
+            fetch_t = t;
+            best_count = c;
+        }
+    }
+
+    // Branch unit outputs belong to the thread of the branch in wb_bru
+    int bru_thread = thread_of(wb_bru.rob_tag);
+    int mp_thread = thread_of(branch_fu->getRecoverTag());
+    bool jump_mispredict = branch_fu->getMispredict();
+    bool jump_resolved = branch_fu->getJumpValid() && !flush[bru_thread];
+    ckpt_t bru_ckpt = branch_fu->getCkptID();       // slot of the branch in wb_bru
+    xlen_t jump_pc = branch_fu->getJumpPC();
+    uint32_t jump_instr = branch_fu->getJumpInstr();
+    xlen_t jump_target = branch_fu->getJumpTarget();
+    
+    // Quiet cycle: no stage moves an instruction, nothing is in flight in
+    // the FUs (but a division counting down), DMem or recovery, and fetch
+    // is parked on a full latch. Each module's tick is then the identity
+    // apart from the divider countdown, so the following cycles repeat
+    // this one until the division is ready, or for ever when none is in
+    // flight. ICache latency is one cycle and DMem two, so the rest of
+    // the machine is only this still when it waits on a division or is
+    // stuck.
+    if constexpr (!kObserved) {
+        bool quiet = !wb_alu.valid && !wb_bru.valid && !wb_lsu.valid && !wb_mdu.valid &&
+                     !jump_mispredict && lsu_fu->isIdle() &&
+                     !iss_alu && !iss_bru && !iss_lsu && !iss_mdu && !disp_fire && !rename_fire;
+        for (int t = 0; quiet && t < n; t++) {
+            const CoreThread& th = *threads[t];
+            quiet = !flush[t] && !recover[t] && !walking[t] && !commit[t] &&
+                    th.recovery_ctrl.isIdle() && th.dmem.isIdle() &&
+                    !(!th.r2d.empty() && disp_ready[t]) && !decode_fire[t] &&
+                    th.fetch.getValidOut() && !fetch_fire[t] && !th.fetch.getICacheEn() &&
+                    !th.icache.getRValid();
+        }
+        quiet_cycles = quiet ? mdu_fu->quietCycles() : 0;
+    }
+    
+    // ------------------------------------------------------------------
+    // Observer events (none for NoObserver)
+    // ------------------------------------------------------------------
+    
+    if constexpr (kObserved) {
+        for (int t = 0; t < n; t++) {
+            if (commit[t]) {
+                CommitPkt cpkt = threads[t]->rob.getCommitPkt();
+                cpkt.rd_value = cpkt.rd_used ? prf->read(cpkt.prd) : 0;
+                observer.onCommit(cycle_count, cpkt);
+            }
+        }
+        if (wb_alu.valid) observer.onWriteback(cycle_count, FUType::ALU, wb_alu);
+        if (wb_bru.valid) observer.onWriteback(cycle_count, FUType::BRU, wb_bru);
+        if (wb_lsu.valid) observer.onWriteback(cycle_count, FUType::LSU, wb_lsu);
+        if (wb_mdu.valid) observer.onWriteback(cycle_count, FUType::MDU, wb_mdu);
+        if (jump_mispredict) {
+            observer.onMispredict(cycle_count, branch_fu->getRecoverTag(), branch_fu->getTargetPC());
+        }
+        for (int t = 0; t < n; t++) {
+            if (!recover[t]) continue;
+            const CoreThread& th = *threads[t];
+            observer.onRecover(cycle_count, th.recovery_ctrl.getRecoverTag(),
+                               th.recovery_ctrl.getFlushPC());
+            std::bitset<ROB_DEPTH> squashed = thread_live[t] & ~rs_live;
+            for (int tag = 0; tag < ROB_DEPTH; tag++) {
+                if (squashed.test(tag)) observer.onSquash(cycle_count, static_cast<rob_tag_t>(tag));
+            }
+            const auto& disp_q = th.dispatch.getQueue();
+            for (int i = 0; i < disp_q.size(); i++) observer.onSquash(cycle_count, disp_q.at(i).rob_tag);
+            for (int i = 0; i < th.r2d.size(); i++) observer.onSquash(cycle_count, th.r2d.at(i).rob_tag);
+        }
+        if (iss_alu || iss_bru || iss_lsu || iss_mdu) observer.onIssue(cycle_count, iss_e);
+        if (iss_lsu && iss_e.is_store) {
+            observer.onStore(cycle_count, iss_e.rob_tag, lsu_fu->getDMemAddr(iss_e, src1, src2),
+                             lsu_fu->getDMemWData(src2), lsu_fu->getDMemSize(iss_e));
+        }
+        if (disp_fire) observer.onDispatch(cycle_count, disp_entry);
+        if (rename_fire) observer.onRename(cycle_count, rpkt);
+        for (int t = 0; t < n; t++) {
+            if (decode_fire[t]) observer.onDecode(cycle_count, dpkt[t]);
+        }
+        
+        if constexpr (ObservesCycles<Observer>::value) {
+            // Thread 0's front end and ROB
+            const CoreThread& th = *threads[0];
+            const RecoveryCtrl& rc = th.recovery_ctrl;
+            CycleRecord rec;
+            rec.cycle = cycle_count;
+            rec.commits = commit_count;
+            rec.fetch_pc = th.fetch.getPCOut();
+            rec.fetch_valid = th.fetch.getValidOut();
+            rec.dec_valid = !th.f2d.empty();
+            rec.dec_ready = th.d2r.getReady(ren_t == 0);
+            rec.ren_valid = !th.d2r.empty();
+            rec.ren_ready = r2d_accept[0];
+            rec.ren_fire = ren_t == 0;
+            rec.disp_valid = th.dispatch.getOutValid();
+            rec.disp_ready = disp_ready[0];
+            rec.disp_fire = disp_t == 0;
+            rec.iss_alu = iss_alu;
+            rec.iss_bru = iss_bru;
+            rec.iss_lsu = iss_lsu;
+            rec.iss_mdu = iss_mdu;
+            rec.iss_tag = iss_e.rob_tag;
+            rec.wb_alu = wb_alu;
+            rec.wb_bru = wb_bru;
+            rec.wb_lsu = wb_lsu;
+            rec.wb_mdu = wb_mdu;
+            rec.rob_head = th.rob.getHead();
+            rec.rob_tail = th.rob.getTail();
+            rec.rob_count = static_cast<uint8_t>(th.rob.getCount());
+            rec.commit = commit[0];
+            rec.live_tag = static_cast<uint32_t>(thread_live[0].to_ulong());
+            rec.flush = flush[0];
+            rec.recover = recover[0];
+            rec.walking = walking[0];
+            rec.mispredict = jump_mispredict;
+            rec.flush_pc = rc.getFlushPC();
+            rec.recover_tag = rc.getRecoverTag();
+            rec.mp_target = branch_fu->getTargetPC();
+            rec.mp_tag = branch_fu->getRecoverTag();
+            observer.onCycle(rec);
+        }
+    }
+    
+    // ------------------------------------------------------------------
+    // Phase B: clock edge
+    // ------------------------------------------------------------------
+
+    // Commit side effects, each thread's ROB head. Pregs given back one
+    // by one (shared_free) go to the free list after its allocation
+    // below: at most one per thread from commit and one per squashed
+    // instruction, each of which holds a tag.
+    std::array<preg_t, MAX_THREADS + ROB_DEPTH> release;
+    int n_release = 0;
+    bool free_req = false;
+    preg_t free_preg = 0;
+    for (int t = 0; t < n; t++) {
+        CoreThread& th = *threads[t];
+        if (recover[t]) {
+            recover_count++;
+            th.stats.recoveries++;
+        }
+        if (!commit[t]) continue;
+        const ROB& rob = th.rob;
+        if (rob.getCommitRdUsed()) {
+            th.map_table.commit(rob.getCommitRd(), rob.getCommitPrd());
+            activity.rat_write++;
+        }
+        if (rob.getFreeReq()) {
+            if (shared_free) release[n_release++] = rob.getFreePreg();
+            free_req = true;
+            free_preg = rob.getFreePreg();
+            activity.fl_free++;
+        }
+        if (rob.getCommitEliminated()) {
+            if (rob.getCommitPrd() == 0) elim_zero_count++;
+            else elim_move_count++;
+        }
+        FuseRule fuse = rob.getCommitFuse();
+        if (fuse != FuseRule::NONE) {
+            fuse_count[static_cast<int>(fuse)]++;
+        }
+        int commits = (fuse != FuseRule::NONE) ? 2 : 1;
+        bool halted = isHalted(t);
+        xlen_t pc = rob.getCommitPC();
+        th.same_pc_commits = (th.stats.commits > 0 && pc == th.last_commit_pc) ?
+                             th.same_pc_commits + 1 : 0;
+        th.last_commit_pc = pc;
+        commit_count += commits;
+        if (!halted) {
+            th.stats.commits += commits;
+            if (isHalted(t)) th.stats.halt_cycle = cycle_count + 1;
+        }
+    }
+
+    for (int t = 0; t < n; t++) {
+        const CoreThread& th = *threads[t];
+        if (!flush[t] && !th.d2r.empty() && (th.d2r.front().is_branch || th.d2r.front().is_jump) &&
+            !ckpt_ok[t]) {
+            ckpt_stall_count++;
+        }
+        if (walking[t]) {
+            walk_cycles++;
+            if (!th.d2r.empty()) walk_stall_count++;
+        }
+    }
+
+    // Structure accesses this cycle (energy model). RS wakeup compares
+    // every occupied entry's two source tags with each broadcast tag.
+    int wb_tags = (wb_alu.valid && wb_alu.rd_used && wb_alu.prd != 0) +
+                  (wb_bru.valid && wb_bru.rd_used && wb_bru.prd != 0) +
+                  (wb_lsu.valid && wb_lsu.rd_used && wb_lsu.prd != 0) +
+                  (wb_mdu.valid && wb_mdu.rd_used && wb_mdu.prd != 0);
+    activity.cdb_broadcast += wb_alu.valid + wb_bru.valid + wb_lsu.valid + wb_mdu.valid;
+    activity.prf_write += wb_tags;
+    if (wb_tags > 0) {
+        int occupied = rs_alu->getOccupancy() + rs_bru->getOccupancy() +
+                       rs_lsu->getOccupancy() + rs_mdu->getOccupancy();
+        activity.rs_wakeup_cmp += 2ull * occupied * wb_tags;
+    }
+    if (rename_fire) {
+        const DecodePkt& p = threads[ren_t]->d2r.front();
+        activity.rat_read += p.rs1_used + p.rs2_used + (p.rd_used && p.rd != 0);
+    }
+    activity.rat_write += alloc_req || share_req;
+    activity.rat_ckpt += ckpt_take;
+    activity.prf_ckpt += ckpt_take;
+    activity.fl_alloc += alloc_req;
+    if (iss_alu || iss_bru || iss_lsu || iss_mdu) {
+        activity.rs_select++;
+        activity.prf_read += iss_e.rs1_used + iss_e.rs2_used;
+    }
+    if (disp_fire) {
+        activity.rob_alloc++;
+        activity.rs_insert += disp_pkt.fu_type != FUType::NONE;
+    }
+    if (lsu_fu->getDMemEn(iss_lsu)) {
+        if (lsu_fu->getDMemWE(iss_e)) activity.dmem_write++;
+        else activity.dmem_read++;
+    }
+    activity.icache_read += fetch_t >= 0;
+
+    // From here on a module whose inputs are idle and whose state would
+    // not change is not ticked at all: its tick would be the identity.
+    // Each condition below is the complement of that module's idle case.
+    bool any_wb = wb_alu.valid || wb_bru.valid || wb_lsu.valid || wb_mdu.valid;
+    for (int t = 0; t < n; t++) {
+        activity.rob_commit += commit[t];
+        activity.rat_ckpt += recover[t] && !walk_mode;
+        RecoveryCtrl& rc = threads[t]->recovery_ctrl;
+        bool mispredict = jump_mispredict && mp_thread == t;
+        if (mispredict || !rc.isIdle()) {
+            rc.tick(mispredict, branch_fu->getTargetPC(), branch_fu->getRecoverTag(),
+                    branch_fu->getCkptID(), branch_fu->getRecoverPred());
+        }
+    }
+
+    // Execute. ALU and BRU take no flush: they hold nothing of a flushing
+    // thread that has not written back already. Their registers are all
+    // clear once a cycle without an issue has passed.
+    if (iss_alu || wb_alu.valid) {
+        alu_fu->tick(false, iss_alu, iss_e, src1, src2);
+    }
+    if (iss_bru || wb_bru.valid) {
+        branch_fu->tick(false, iss_bru, iss_e, src1, src2);
+    }
+    bool dmem_en = lsu_fu->getDMemEn(iss_lsu);
+    for (int t = 0; t < n; t++) {
+        threads[t]->dmem.tick(dmem_en && iss_thread == t, lsu_fu->getDMemWE(iss_e),
+                              lsu_fu->getDMemAddr(iss_e, src1, src2), lsu_fu->getDMemWData(src2),
+                              lsu_fu->getDMemSize(iss_e));
+    }
+    if (any_flush || iss_lsu || !lsu_fu->isIdle()) {
+        lsu_fu->tick(any_flush, rs_live, iss_lsu, iss_e, src1, src2);
+    }
+    if (iss_mdu || !mdu_fu->isIdle()) {
+        mdu_fu->tick(any_flush, rs_live, iss_mdu, iss_e, src1, src2);
+    }
+
+    // Rename state. Squashed renames give back their pregs. Walk recovery
+    // undoes the ones not yet in the ROB at once (they are the youngest:
+    // r2d, then the dispatch FIFO, each tail first), then the ROB entries
+    // as they are popped; the snapshots are not used. Snapshot recovery
+    // restores the RAT, and with a shared free list returns the squashed
+    // pregs to it.
+    RenamePkt undo[ROB_DEPTH];
+    for (int t = 0; t < n; t++) {
+        CoreThread& th = *threads[t];
+        auto give_back = [&](const RenamePkt& p, bool undo_map) {
+            if (!p.rd_used) return;
+            if (undo_map) {
+                th.map_table.undo(p.rd, p.old_prd);
+                activity.rat_write++;
+            }
+            release[n_release++] = p.prd;
+            activity.fl_free++;
+        };
+        const auto& disp_q = th.dispatch.getQueue();
+        if (recover[t] && (walk_mode || shared_free)) {
+            if (walk_mode) {
+                th.rob_tag_alloc.resumeAfter(th.recovery_ctrl.getRecoverTag());
+            } else {
+                int k = th.rob.getRecoverUndo(th.recovery_ctrl.getRecoverCkpt(), undo);
+                for (int i = 0; i < k; i++) give_back(undo[i], false);
+            }
+            for (int i = th.r2d.size() - 1; i >= 0; i--) give_back(th.r2d.at(i), walk_mode);
+            for (int i = disp_q.size() - 1; i >= 0; i--) give_back(disp_q.at(i), walk_mode);
+        }
+        int k = th.rob.getWalkUndo(undo);
+        for (int i = 0; i < k; i++) give_back(undo[i], true);
+    }
+    
+    // Backend state (PRF valid bits sampled before this edge for RS
+    // insert). The PRF does not restore on recovery, so it need not see
+    // one, and another thread's rename still clears its new preg's valid
+    // bit. Its snapshot is the RTL's, so only one thread takes it.
+    std::bitset<N_PHYS_REGS> prf_valid = prf->getValidBits();
+    bool prf_ckpt = !shared_free && ckpt_take;
+    if (wb_tags > 0 || alloc_req || prf_ckpt) {
+        prf->tick(false, false, 0, wb_alu, wb_lsu, wb_bru, wb_mdu, alloc_req, rpkt.prd,
+                  prf_ckpt, new_ckpt);
+    }
+    for (int t = 0; t < n; t++) {
+        CoreThread& th = *threads[t];
+        bool disp = t == disp_t;
+        if (!(disp || commit[t] || recover[t] || walking[t] || any_wb)) continue;
+        th.rob.tick(flush[t], recover[t], th.recovery_ctrl.getRecoverTag(),
+                    th.recovery_ctrl.getRecoverCkpt(), disp, disp_pkt,
+                    wb_alu, wb_lsu, wb_bru, wb_mdu,
+                    disp && (disp_pkt.is_branch || disp_pkt.is_jump), disp_pkt.ckpt_id);
+    }
+    // An RS changes only on an insert, its issue, a recovery squash or a
+    // wakeup tag
+    auto rs_tick = [&](RS& rs, FUType fu, bool issue) {
+        bool insert = disp_fire && disp_pkt.fu_type == fu;
+        if (insert || issue || any_recover || wb_tags > 0) {
+            rs.tick(false, any_recover, rs_live, insert, disp_entry, wb_alu, wb_lsu, wb_bru,
+                    wb_mdu, issue, prf_valid);
+        }
+    };
+    rs_tick(*rs_alu, FUType::ALU, iss_alu);
+    rs_tick(*rs_bru, FUType::BRU, iss_bru);
+    rs_tick(*rs_lsu, FUType::LSU, iss_lsu);
+    rs_tick(*rs_mdu, FUType::MDU, iss_mdu);
+
+    // Dispatch FIFO (after the walk has read the entries it squashes)
+    for (int t = 0; t < n; t++) {
+        CoreThread& th = *threads[t];
+        th.dispatch.tick(flush[t], !th.r2d.empty(), th.r2d.front(), rs_alu_ready, rs_bru_ready,
+                         rs_lsu_ready, rs_mdu_ready, t == disp_t);
+    }
+    
+    // The shared free list allocates first, so that it hands out the preg
+    // rename saw, then takes back the freed ones
+    if (shared_free) {
+        free_list->tick(false, false, 0, alloc_req, false, 0, share_req, rpkt.prd, false, 0);
+    } else {
+        const CoreThread& th = *threads[0];
+        free_list->tick(flush[0], recover[0] && !walk_mode, th.recovery_ctrl.getRecoverCkpt(),
+                        alloc_req, free_req, free_preg, share_req, rpkt.prd, ckpt_take, new_ckpt);
+    }
+    for (int i = 0; i < n_release; i++) {
+        free_list->release(release[i]);
+    }
+    for (int t = 0; t < n; t++) {
+        CoreThread& th = *threads[t];
+        bool ren = t == ren_t;
+        bool restore = recover[t] && !walk_mode;
+        ckpt_t recover_ckpt = th.recovery_ctrl.getRecoverCkpt();
+        bool map_we = ren && (alloc_req || share_req);
+        bool take = ren && ckpt_take;
+        bool resolve = wb_bru.valid && !jump_mispredict && bru_thread == t;
+        if (restore || map_we || take) {
+            th.map_table.tick(flush[t], restore, recover_ckpt, map_we, ren_rd, rpkt.prd,
+                              take, new_ckpt);
+        }
+        if (flush[t] || restore || ren || t == disp_t) {
+            th.rob_tag_alloc.tick(flush[t], restore, recover_ckpt, ren, tag_used,
+                                  t == disp_t, disp_pkt.rob_tag, take, new_ckpt);
+        }
+        if (recover[t] || resolve || take) {
+            th.ckpt_pool.tick(flush[t], recover[t], recover_ckpt, rs_live, resolve, bru_ckpt,
+                              take, new_ckpt, new_tag);
+        }
+    }
+    if (rename_fire) {
+        tag_thread[new_tag] = static_cast<uint8_t>(ren_t);
+    }
+
+    // Frontend (ICache answers a REQ in the same cycle)
+    for (int t = 0; t < n; t++) {
+        CoreThread& th = *threads[t];
+        const RecoveryCtrl& rc = th.recovery_ctrl;
+        if (t == fetch_t || th.icache.getRValid()) {
+            th.icache.tick(t == fetch_t, th.fetch.getICacheAddr());
+        }
+        FetchPkt fpkt = {true, th.fetch.getPCOut(), th.fetch.getInstrOut(), fpred[t]};
+        if constexpr (kObserved) {
+            if (fetch_fire[t]) observer.onFetch(cycle_count, fpkt);
+        }
+        xlen_t fetch_next = fpred[t].taken ? fpred[t].target : th.fetch.getPCOut() + 4;
+        th.fetch.tick(flush[t], rc.getFlushPC(), f2d_accept[t], fetch_next,
+                      th.icache.getRValid(), th.icache.getRData());
+        th.bpred.tick(flush[t], rc.getRecoverPred(), fetch_fire[t], fpred[t],
+                      jump_resolved && bru_thread == t, jump_pc, jump_instr, jump_target,
+                      jump_mispredict);
+        th.stats.fetches += t == fetch_t;
+
+        // Inter-stage queues: each head leaves before the new tail enters
+        th.f2d.sample();
+        th.d2r.sample();
+        th.r2d.sample();
+        if (flush[t]) {
+            th.f2d.flush();
+            th.d2r.flush();
+            th.r2d.flush();
+            continue;
+        }
+        if (!th.r2d.empty() && disp_ready[t]) {
+            th.r2d.pop();
+        }
+        if (t == ren_t) {
+            th.r2d.push(rpkt);
+            th.d2r.pop();
+        }
+        if (decode_fire[t]) {
+            th.d2r.push(dpkt[t]);
+            th.f2d.pop();
+            if (fused_queued[t]) th.f2d.pop();
+        }
+        if (fetch_fire[t] && !(decode_fire[t] && fused_fetch[t])) {
+            th.f2d.push(fpkt);
+        }
+    }
+
+    if (fetch_t >= 0) fetch_last = fetch_t;
+    if (ren_t >= 0) rename_last = ren_t;
+    if (disp_t >= 0) dispatch_last = disp_t;
+    cycle_count++;
+}
+
+template <typename Observer>
+void BasicCore<Observer>::run(uint64_t max_cycles) {
+    for (uint64_t i = 0; i < max_cycles; i++) {
+        tick();
+        if constexpr (kObserved) {
+            if (observer.stopRequested()) break;
+        }
+        if (cycle_count % 1000 == 0) {
+            std::cout << "Cycle " << cycle_count << ", Commits " << commit_count << std::endl;
+        }
+        if constexpr (!kObserved) {
+            if (quiet_cycles != 0 && i + 1 < max_cycles) {
+                uint64_t n = std::min(quiet_cycles, max_cycles - i - 1);
+                for (uint64_t c = (cycle_count / 1000 + 1) * 1000; c <= cycle_count + n; c += 1000) {
+                    std::cout << "Cycle " << c << ", Commits " << commit_count << std::endl;
+                }
+                skipQuiet(n);
+                i += n;
+            }
+        }
+    }
+}
+
+template <typename Observer>
+void BasicCore<Observer>::advance(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        tick();
+        if constexpr (kObserved) {
+            if (observer.stopRequested()) break;
+        } else {
+            if (quiet_cycles != 0 && i + 1 < n) {
+                uint64_t k = std::min(quiet_cycles, n - i - 1);
+                skipQuiet(k);
+                i += k;
+            }
+        }
+    }
+}
+
+template <typename Observer>
+CoreState BasicCore<Observer>::saveState() const {
+    CoreState s{{}, *decode, *free_list, *rs_alu, *rs_bru, *rs_lsu, *rs_mdu, *prf,
+                *alu_fu, *branch_fu, *lsu_fu, *mdu_fu,
+                tag_thread, fetch_last, rename_last, dispatch_last,
+                cycle_count, commit_count, recover_count, ckpt_stall_count,
+                walk_cycles, walk_stall_count, elim_move_count, elim_zero_count,
+                fuse_count, activity, quiet_cycles};
+    s.threads.reserve(threads.size());
+    for (const auto& th : threads) {
+        s.threads.push_back(*th);
+    }
+    return s;
+}
+
+template <typename Observer>
+void BasicCore<Observer>::restoreState(const CoreState& s) {
+    for (size_t t = 0; t < threads.size(); t++) {
+        *threads[t] = s.threads[t];
+    }
+    *decode = s.decode;
+    *free_list = s.free_list;
+    *rs_alu = s.rs_alu;
+    *rs_bru = s.rs_bru;
+    *rs_lsu = s.rs_lsu;
+    *rs_mdu = s.rs_mdu;
+    *prf = s.prf;
+    *alu_fu = s.alu_fu;
+    *branch_fu = s.branch_fu;
+    *lsu_fu = s.lsu_fu;
+    *mdu_fu = s.mdu_fu;
+    
+    tag_thread = s.tag_thread;
+    fetch_last = s.fetch_last;
+    rename_last = s.rename_last;
+    dispatch_last = s.dispatch_last;
+    
+    cycle_count = s.cycle_count;
+    commit_count = s.commit_count;
+    recover_count = s.recover_count;
+    ckpt_stall_count = s.ckpt_stall_count;
+    walk_cycles = s.walk_cycles;
+    walk_stall_count = s.walk_stall_count;
+    elim_move_count = s.elim_move_count;
+    elim_zero_count = s.elim_zero_count;
+    fuse_count = s.fuse_count;
+    activity = s.activity;
+    quiet_cycles = s.quiet_cycles;
+}
+
+template <typename Observer>
+void BasicCore<Observer>::skipQuiet(uint64_t n) {
+    // The per-cycle counters a quiet cycle still advances
+    bool walk_mode = threads[0]->rob.getWalkWidth() > 0;
+    for (auto& th : threads) {
+        if (!th->d2r.empty() && (th->d2r.front().is_branch || th->d2r.front().is_jump) &&
+            !(walk_mode || th->ckpt_pool.hasFree())) {
+            ckpt_stall_count += n;
+        }
+        th->f2d.sample(n);
+        th->d2r.sample(n);
+        th->r2d.sample(n);
+        th->dispatch.skipIdle(n);
+        th->dmem.skipIdle(n);
+        th->fetch.skipIdle(n);
+    }
+    mdu_fu->skipIdle(n);
+    quiet_cycles = 0;
+    cycle_count += n;
+}
+
+template <typename Observer>
+void BasicCore<Observer>::setQueueDepth(StageQueue q, int depth) {
+    for (auto& th : threads) {
+        switch (q) {
+            case StageQueue::F2D: th->f2d.setDepth(depth); break;
+            case StageQueue::D2R: th->d2r.setDepth(depth); break;
+            case StageQueue::R2D: th->r2d.setDepth(depth); break;
+            case StageQueue::DISPATCH: th->dispatch.setDepth(depth); break;
+        }
+    }
+}
+
+template <typename Observer>
+int BasicCore<Observer>::getQueueDepth(StageQueue q) const {
+    const CoreThread& th = *threads[0];
+    switch (q) {
+        case StageQueue::F2D: return th.f2d.getDepth();
+        case StageQueue::D2R: return th.d2r.getDepth();
+        case StageQueue::R2D: return th.r2d.getDepth();
+        default: return th.dispatch.getDepth();
+    }
+}
+
+template <typename Observer>
+const StageQueueHistogram& BasicCore<Observer>::getQueueOccupancy(StageQueue q) const {
+    const CoreThread& th = *threads[0];
+    switch (q) {
+        case StageQueue::F2D: return th.f2d.occupancy();
+        case StageQueue::D2R: return th.d2r.occupancy();
+        case StageQueue::R2D: return th.r2d.occupancy();
+        default: return th.dispatch.getQueue().occupancy();
+    }
+}
+
+template <typename Observer>
+uint32_t BasicCore<Observer>::getArchRegValue(int thread, reg_t arch_reg) const {
+    if (arch_reg == 0) {
+        return 0;
+    }
+    return prf->read(threads[thread]->map_table.lookupArch(arch_reg));
+}
+
+template <typename Observer>
+int BasicCore<Observer>::getROBCount() const {
+    int count = 0;
+    for (const auto& th : threads) {
+        count += th->rob.getCount();
+    }
+    return count;
+}
+
+template <typename Observer>
+int BasicCore<Observer>::getCkptBusy() const {
+    int busy = 0;
+    for (const auto& th : threads) {
+        busy += th->ckpt_pool.getBusyCount();
+    }
+    return busy;
+}
+
+template <typename Observer>
+int BasicCore<Observer>::getRSOccupancy(FUType fu) const {
+    switch (fu) {
+        case FUType::ALU: return rs_alu->getOccupancy();
+        case FUType::BRU: return rs_bru->getOccupancy();
+        case FUType::LSU: return rs_lsu->getOccupancy();
+        case FUType::MDU: return rs_mdu->getOccupancy();
+        default: return 0;
+    }
+}
+
+template <typename Observer>
+bool BasicCore<Observer>::isHalted() const {
+    for (int t = 0; t < getThreads(); t++) {
+        if (!isHalted(t)) return false;
+    }
+    return true;
+}
+
+template <typename Observer>
+int BasicCore<Observer>::inFlightFront(int thread, const std::bitset<ROB_DEPTH>& live) const {
+    const CoreThread& th = *threads[thread];
+    return th.fetch.getBufferCount() + th.f2d.size() + th.d2r.size() + th.r2d.size() +
+           th.dispatch.getQueue().size() +
+           rs_alu->getOccupancy(live) + rs_bru->getOccupancy(live) +
+           rs_lsu->getOccupancy(live) + rs_mdu->getOccupancy(live);
+}
+
+#endif // CORE_IMPL_H
@@ -4,11 +4,28 @@
 #include "types.h"
 
 class Decode {
+private:
+    // Enabled fusion rules, bit (1 << FuseRule); 0 (default) as the RTL
+    uint32_t fuse_rules;
+
 public:
     Decode();
     
+    void setFusion(uint32_t rules) { fuse_rules = rules & ~1u; }
+    uint32_t getFusion() const { return fuse_rules; }
+    
     // Combinational decode
     DecodePkt decode(bool valid_in, xlen_t pc_in, uint32_t instr_in);
+    
+    // a could start an enabled pair: decode holds it until the next
+    // instruction is visible at fetch
+    bool isFusionHead(const DecodePkt& a) const;
+    
+    // Fuse a with the instruction after it into out (a copy of a with the
+    // pair's operation); NONE if no enabled rule applies
+    FuseRule fuse(const DecodePkt& a, const DecodePkt& b, DecodePkt& out) const;
+    
+    static const char* fuseRuleName(FuseRule rule);
 };
 
 #endif // DECODE_H
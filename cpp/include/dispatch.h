@@ -2,37 +2,51 @@
 #define DISPATCH_H
 
 #include "types.h"
+#include "pipe_queue.h"
 
 class Dispatch {
+public:
+    using Queue = PipeQueue<RenamePkt, MAX_STAGE_QUEUE_DEPTH>;
+    
 private:
-    bool fifo_full;
-    RenamePkt fifo_storage;
+    Queue fifo;         // depth 1 (default) is the RTL's dispatch_fifo
 
 public:
     Dispatch();
     void reset();
     
+    // FIFO entries, 1..MAX_STAGE_QUEUE_DEPTH; set between runs
+    void setDepth(int depth) { fifo.setDepth(depth); }
+    int getDepth() const { return fifo.getDepth(); }
+    const Queue& getQueue() const { return fifo; }
+    void skipIdle(uint64_t n) { fifo.sample(n); }
+    
     void tick(bool flush, bool valid_in, const RenamePkt& pkt_in,
               bool rs_alu_ready, bool rs_bru_ready, bool rs_lsu_ready,
-              bool rob_ready);
+              bool rs_mdu_ready, bool rob_ready);
+    
+    // Combinational: buffered packet moves into RS + ROB this cycle
+    bool getFire(bool flush, bool rs_alu_ready, bool rs_bru_ready,
+                 bool rs_lsu_ready, bool rs_mdu_ready, bool rob_ready) const;
     
     // Outputs
-    bool getReadyOut() const;
-    bool getOutValid() const { return fifo_full; }
-    RenamePkt getOutPkt() const { return fifo_storage; }
+    bool getReadyOut(bool fire) const { return fifo.getReady(fire); }
+    bool getOutValid() const { return !fifo.empty(); }
+    RenamePkt getOutPkt() const { return fifo.empty() ? RenamePkt{} : fifo.front(); }
     
     // RS insert signals
-    bool getRSALUValid() const;
-    bool getRSBRUValid() const;
-    bool getRSLSUValid() const;
+    bool getRSALUValid(bool fire) const;
+    bool getRSBRUValid(bool fire) const;
+    bool getRSLSUValid(bool fire) const;
+    bool getRSMDUValid(bool fire) const;
     RSEntry buildRSEntry(const RenamePkt& pkt) const;
     
     // ROB alloc signals
-    bool getROBAllocValid() const;
+    bool getROBAllocValid(bool fire) const { return fire; }
     
 private:
     bool rsSpaceOk(const RenamePkt& pkt, bool rs_alu_ready,
-                   bool rs_bru_ready, bool rs_lsu_ready) const;
+                   bool rs_bru_ready, bool rs_lsu_ready, bool rs_mdu_ready) const;
 };
 
 #endif // DISPATCH_H
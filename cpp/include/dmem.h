@@ -4,6 +4,8 @@
 #include "types.h"
 #include <array>
 
+class SharedMem;
+
 class DMem {
 private:
     static constexpr int DEPTH_WORDS = 1024;
@@ -13,20 +15,38 @@ private:
     bool v2_q;
     uint32_t rdata1_q;
     uint32_t rdata2_q;
+    
+    // Optional shared backend (multi-core); mem is unused while attached
+    SharedMem* shared;
+    int port;
+    uint64_t cycle;
 
 public:
     DMem();
     void reset();
     
+    // Route accesses to a shared memory port instead of the private array
+    void attach(SharedMem* mem, int port_id);
+    
     void tick(bool en, bool we, uint32_t addr, uint32_t wdata, LSSize size);
     
     // Outputs (2-cycle latency)
     bool getRValid() const { return v2_q; }
     uint32_t getRData() const { return rdata2_q; }
+    bool isIdle() const { return !v1_q && !v2_q; }
     
-private:
-    uint32_t writeMerge(uint32_t old_word, uint32_t new_word,
-                        LSSize size, uint8_t off) const;
+    // Quiet-cycle fast-forward: n idle cycles
+    void skipIdle(uint64_t n) { cycle += n; }
+    
+    // Backdoor read, no timing (for tools)
+    uint32_t peek(uint32_t addr) const;
+    
+    // Backdoor write, no timing (private memory only)
+    void poke(uint32_t addr, uint32_t word) { mem[(addr >> 2) & (DEPTH_WORDS - 1)] = word; }
+    
+    // Byte/half/word store merged into the old word
+    static uint32_t writeMerge(uint32_t old_word, uint32_t new_word,
+                               LSSize size, uint8_t off);
 };
 
 #endif // DMEM_H
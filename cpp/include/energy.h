@@ -0,0 +1,68 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+
+// Accesses per microarchitectural structure over a run
+// (BasicCore::getActivity), counted at the clock edge from what each
+// structure actually did that cycle
+struct ActivityCounts {
+    uint64_t rat_read = 0;          // rename: sources and the old destination mapping
+    uint64_t rat_write = 0;         // rename, walk undo and retirement-map writes
+    uint64_t rat_ckpt = 0;          // snapshot taken or restored
+    uint64_t fl_alloc = 0;
+    uint64_t fl_free = 0;           // commit frees and walk releases
+    uint64_t prf_read = 0;          // source operands read at issue
+    uint64_t prf_write = 0;         // writebacks with a destination
+    uint64_t prf_ckpt = 0;          // snapshot taken (data and valid bits, as prf.sv)
+    uint64_t rs_insert = 0;
+    uint64_t rs_wakeup_cmp = 0;     // both source tags of each occupied entry, per broadcast tag
+    uint64_t rs_select = 0;
+    uint64_t rob_alloc = 0;
+    uint64_t rob_commit = 0;
+    uint64_t cdb_broadcast = 0;     // writeback packets (ROB done, RS wakeup)
+    uint64_t dmem_read = 0;
+    uint64_t dmem_write = 0;
+    uint64_t icache_read = 0;
+};
+
+// Energy per access of every ActivityCounts field, plus the clock that
+// turns cycles into time. The built-in values are placeholders of a
+// plausible order of magnitude, not a characterized process; supply a
+// table for real numbers.
+class EnergyTable {
+public:
+    struct Event {
+        const char* name;               // table key, e.g. "rat.read"
+        const char* structure;          // report group
+        uint64_t ActivityCounts::*count;
+        double default_pj;
+    };
+    static constexpr int N_EVENT = 17;
+    static const std::array<Event, N_EVENT>& events();
+
+private:
+    std::array<double, N_EVENT> pj;
+    double clock_ghz;
+
+public:
+    EnergyTable();
+
+    // "event,pJ" rows (and "clock_ghz,F"); '#' lines are comments.
+    // Events not listed keep their value. False on an unknown key or a
+    // malformed row, with err naming it.
+    bool read(std::istream& is, std::string& err);
+
+    double getPJ(int event) const { return pj[event]; }
+    double getClockGHz() const { return clock_ghz; }
+
+    // Per-structure energy and the run's average power
+    void report(std::ostream& os, const ActivityCounts& a, uint64_t cycles,
+                uint64_t commits) const;
+};
+
+#endif // ENERGY_H
@@ -2,8 +2,28 @@
 #define FETCH_H
 
 #include "types.h"
+#include "pipe_queue.h"
 
+// Fetch has two modes. With buffer depth 0 (default) it is the RTL's
+// IDLE -> REQ -> HAVE FSM: one ICache request per instruction, and
+// pc_q only advances once decode takes the instruction, so at most one
+// instruction every two cycles. With depth N > 0 it is decoupled: a
+// fetch target PC requests the next sequential word every cycle while
+// an N-entry instruction buffer has room, independent of decode
+// backpressure, and decode reads the buffer head.
 class Fetch {
+public:
+    static constexpr int MAX_BUFFER_DEPTH = 16;
+    
+    // Buffered mode only (cycles counts every cycle since reset)
+    struct BufferStats {
+        uint64_t cycles;
+        uint64_t occupancy_sum;     // entries in the buffer, summed over cycles
+        uint64_t empty;             // cycles with nothing for decode
+        uint64_t full;              // cycles the ICache was idle for lack of room
+        uint64_t squashed;          // buffered or arriving words dropped by a redirect
+    };
+    
 private:
     enum class State {
         IDLE,
@@ -14,22 +34,44 @@ private:
     State state;
     xlen_t pc_q;
     uint32_t instr_q;
-
+    
+    // Decoupled mode: next fetch target and the instruction buffer (ring)
+    struct BufEntry {
+        xlen_t pc;
+        uint32_t instr;
+    };
+    int buf_depth;
+    PipeQueue<BufEntry, MAX_BUFFER_DEPTH> buf;
+    xlen_t req_pc_q;
+    BufferStats stats;
+    
 public:
     Fetch();
-    void reset();
+    void reset(xlen_t reset_pc = 0);
+    
+    // Instruction buffer entries, 0 for the FSM; set between runs
+    void setBufferDepth(int depth);
+    int getBufferDepth() const { return buf_depth; }
     
-    void tick(bool flush, xlen_t flush_pc, bool ready_in,
+    // next_pc: where fetch continues once the instruction is taken (in
+    // buffered mode, anything but pc + 4 drops the younger entries)
+    void tick(bool flush, xlen_t flush_pc, bool ready_in, xlen_t next_pc,
               bool icache_rvalid, uint32_t icache_rdata);
     
     // Outputs
-    bool getValidOut() const;
-    xlen_t getPCOut() const { return pc_q; }
-    uint32_t getInstrOut() const { return instr_q; }
+    bool getValidOut() const { return buf_depth ? !buf.empty() : state == State::HAVE; }
+    xlen_t getPCOut() const { return buf_depth ? buf.front().pc : pc_q; }
+    uint32_t getInstrOut() const { return buf_depth ? buf.front().instr : instr_q; }
     
     // ICache control
-    bool getICacheEn() const;
-    xlen_t getICacheAddr() const { return pc_q; }
+    bool getICacheEn() const { return buf_depth ? !buf.full() : state == State::REQ; }
+    xlen_t getICacheAddr() const { return buf_depth ? req_pc_q : pc_q; }
+    
+    int getBufferCount() const { return buf.size(); }
+    const BufferStats& getBufferStats() const { return stats; }
+    
+    // Quiet cycles skipped by the core (buffer full, nothing moves)
+    void skipIdle(uint64_t n);
 };
 
 #endif // FETCH_H
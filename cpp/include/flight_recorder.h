@@ -0,0 +1,68 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include "observer.h"
+#include <csignal>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Observer keeping the CycleRecord of the last N cycles in a ring. It
+// writes nothing while the run is healthy; dump() renders the ring in the
+// style of the RTL testbench's core_cycle_dump.log when a run fails. Like
+// the testbench it also stops a run that goes stall_limit cycles without
+// a commit.
+class FlightRecorder : public NoObserver {
+private:
+    std::vector<CycleRecord> ring;
+    size_t next;                // slot the next cycle overwrites
+    uint64_t recorded;          // cycles seen since reset
+    uint64_t stall_limit;       // 0: no watchdog
+    uint64_t stall;             // cycles since the last commit
+    
+    // Set by the SIGINT/SIGTERM handler
+    static inline volatile std::sig_atomic_t stop_signal = 0;
+    static void onStopSignal(int sig);
+    static void onFatalSignal(int sig);
+    
+    // Hand-formatted into a static buffer and written with write(2) only,
+    // so the fatal-signal handler can call it
+    void dumpFd(int fd, const char* reason) const;
+    
+public:
+    // cycles == 0 records nothing
+    explicit FlightRecorder(size_t cycles = 0, uint64_t stall_limit = 0);
+    FlightRecorder(const FlightRecorder&) = default;
+    ~FlightRecorder();
+    void reset();
+    
+    void onCycle(const CycleRecord& r) {
+        stall = r.commit ? 0 : stall + 1;
+        if (ring.empty()) {
+            return;
+        }
+        ring[next] = r;
+        next = next + 1 == ring.size() ? 0 : next + 1;
+        recorded++;
+    }
+    
+    // A caught SIGINT/SIGTERM or the watchdog ends run() at the end of the cycle
+    bool stopRequested() const { return stop_signal != 0 || timedOut(); }
+    bool timedOut() const { return stall_limit != 0 && stall >= stall_limit; }
+    uint64_t getStallLimit() const { return stall_limit; }
+    
+    size_t getCapacity() const { return ring.size(); }
+    size_t getHeld() const { return recorded < ring.size() ? recorded : ring.size(); }
+    
+    // Oldest cycle first, preceded by a header naming the reason
+    void dump(std::ostream& os, const std::string& reason) const;
+    bool dump(const std::string& filename, const std::string& reason) const;
+    
+    // Catch SIGINT/SIGTERM (stop the run, the caller dumps) and
+    // SIGSEGV/SIGABRT/SIGFPE (dump this recorder to filename from the
+    // handler, then die as before). One recorder per process.
+    void installSignalHandlers(const std::string& filename);
+    static bool interrupted() { return stop_signal != 0; }
+};
+
+#endif // FLIGHT_RECORDER_H
@@ -4,27 +4,63 @@
 #include "types.h"
 #include <bitset>
 #include <array>
+#include <vector>
 
+// Move elimination lets several RAT entries share one preg. shares[p]
+// counts the mappings beyond the first; a free (commit, or walk undo)
+// drops one of them and only returns p to free_map at zero.
 class FreeList {
 private:
     std::bitset<N_PHYS_REGS> free_map;
-    std::array<FreelistSnapshot, ROB_DEPTH> ckpt_free_map;
+    std::array<uint8_t, N_PHYS_REGS> shares;
+    std::vector<FreelistSnapshot> ckpt_free_map;     // indexed by checkpoint slot
+    preg_t first_free;          // findFree() of free_map, kept current by every write
+    
+    // A freed preg becomes the cached pick only where findFree() looks:
+    // P0..P(N_ARCH_REGS - 1) go back to free_map but are never allocated
+    void noteFreed(preg_t preg) {
+        if (preg >= N_ARCH_REGS && (first_free == 0 || preg < first_free)) first_free = preg;
+    }
 
 public:
     FreeList();
-    void reset();
     
-    void tick(bool flush, bool recover, rob_tag_t recover_tag,
+    // P0 up to P(mapped - 1) hold the initial mappings, the rest is free
+    void reset(int mapped = N_ARCH_REGS);
+    
+    // One snapshot per checkpoint slot; set between runs
+    void setCkptSlots(int n) { ckpt_free_map.assign(n, {free_map, shares}); }
+    size_t getCkptBytes() const { return ckpt_free_map.size() * sizeof(FreelistSnapshot); }
+    
+    // share_req: an eliminated move mapped one more register to share_preg
+    void tick(bool flush, bool recover, ckpt_t recover_ckpt,
               bool alloc_req, bool free_req, preg_t free_preg,
-              bool checkpoint_take, rob_tag_t checkpoint_tag);
+              bool share_req, preg_t share_preg,
+              bool checkpoint_take, ckpt_t checkpoint_id);
     
     // Outputs
-    bool hasFree() const;
-    preg_t getAllocPreg() const;
+    bool hasFree() const { return first_free != 0; }
+    preg_t getAllocPreg() const { return first_free; }
     bool getAllocGnt() const;
     
-private:
+    // ROB-walk recovery: return a squashed instruction's destination
+    void release(preg_t preg) {
+        if (preg == 0) return;
+        if (shares[preg] != 0) {
+            shares[preg]--;
+            return;
+        }
+        free_map.set(preg);
+        noteFreed(preg);
+    }
+    
+    int getShares(preg_t preg) const { return shares[preg]; }
+    
+    // Lowest free preg from P(N_ARCH_REGS) up, 0 if none: what
+    // getAllocPreg() must equal after every tick and release
     preg_t findFree() const;
+    
+private:
     bool alloc_gnt_q;
     preg_t alloc_preg_q;
 };
@@ -0,0 +1,129 @@
+#ifndef FUZZ_H
+#define FUZZ_H
+
+#include "types.h"
+#include "mdu_fu.h"
+#include "workload_gen.h"
+#include "pipe_queue.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+// Differential fuzzing of Core against the ISS. Each case is a
+// WorkloadGen program (forward control flow only, so it terminates) plus
+// the core's opt-in knobs, drawn with a bias toward recovery hazards:
+// dense and mostly taken branches, stores near branches, long RV32M ops
+// that back up the ROB and RSs, checkpoint pools small enough to run
+// out. Every commit is checked in lockstep by
+// CommitChecker; a run also fails if the core does not reach the final
+// self-loop within its cycle budget or ends with a wrong a0/a1.
+//
+// Coverage is a bitmap of structure-occupancy and event features (ROB
+// and RS fill at recovery, checkpoint slots in use, store-to-recovery
+// distance, instructions squashed per recovery, issue/writeback port
+// combinations...). Cases that set a new bit join a shared corpus that
+// later cases mutate. Worker threads share the bitmap and corpus, so a
+// multi-threaded campaign is not reproducible; every failing case is.
+struct FuzzConfig {
+    int threads = 0;                // host threads, 0 = one per host CPU
+    uint64_t programs = 0;          // stop after this many cases (0: only the time limit)
+    double seconds = 10.0;          // time limit (0: only the program limit)
+    uint32_t seed = 1;
+    int max_failures = 1;           // stop once this many cases failed
+    bool minimize = true;
+    uint64_t minimize_runs = 2000;  // executions spent shrinking one failure
+};
+
+// One fuzz case: program parameters and core knobs
+struct FuzzCase {
+    GenConfig gen;
+    int walk = 0;
+    int ckpt_slots = N_CKPT;
+    int ras = 0;
+    int fetch_buffer = 0;
+    std::array<int, N_STAGE_QUEUES> queues = {1, 1, 1, 1};
+    bool move_elim = false;
+    uint32_t fuse = 0;
+    int mul_latency = MDUFU::DEFAULT_MUL_LATENCY;
+    
+    // ooop_sim options reproducing the knobs
+    std::string simArgs() const;
+};
+
+struct FuzzFailure {
+    FuzzCase fc;
+    std::vector<uint32_t> words;    // as generated
+    std::vector<uint32_t> minimized;
+    std::string what;               // first divergence, hang or a0/a1
+    uint64_t min_runs;              // executions spent minimizing
+};
+
+struct FuzzStats {
+    uint64_t programs;
+    uint64_t cycles;                // simulated, failures and minimization excluded
+    uint64_t commits;
+    uint64_t failures;
+    int coverage;                   // feature bits set
+    int corpus;
+    double host_sec;
+    
+    double execsPerSec() const { return host_sec > 0 ? programs / host_sec : 0; }
+};
+
+class Fuzzer {
+public:
+    static constexpr int N_FEATURES = 512;
+    static constexpr int N_WORDS = N_FEATURES / 64;
+    
+private:
+    FuzzConfig cfg;
+    
+    std::atomic<uint64_t> issued;
+    std::atomic<uint64_t> done;
+    std::atomic<uint64_t> cycles;
+    std::atomic<uint64_t> commits;
+    std::atomic<bool> stop;
+    std::array<std::atomic<uint64_t>, N_WORDS> coverage;
+    
+    mutable std::mutex mtx;         // corpus and failures
+    std::vector<FuzzCase> corpus;
+    std::vector<FuzzFailure> failures;
+    double host_sec;
+    
+public:
+    explicit Fuzzer(const FuzzConfig& config);
+    
+    // Run the campaign; progress(stats) is called from the calling thread
+    // about once a second
+    void run(const std::function<void(const FuzzStats&)>& progress = {});
+    
+    FuzzStats getStats() const;
+    const std::vector<FuzzFailure>& getFailures() const { return failures; }
+    int getNumThreads() const;
+    
+    // Execute one case on a fresh core (no coverage); empty if it passes,
+    // else what went wrong. For replaying or shrinking a failure.
+    static std::string check(const FuzzCase& fc, const std::vector<uint32_t>& words);
+    
+    // Replace instructions by NOPs while the case keeps failing, at most
+    // max_runs executions; runs counts them
+    static std::vector<uint32_t> minimize(const FuzzCase& fc, const std::vector<uint32_t>& words,
+                                          uint64_t max_runs, uint64_t& runs);
+    
+    // Hazard-biased random case and a small mutation of one
+    static FuzzCase randomCase(std::mt19937& rng);
+    static FuzzCase mutate(const FuzzCase& base, std::mt19937& rng);
+    
+private:
+    void worker(int id);
+    
+    // OR a case's features into the shared map; true if any was new
+    bool mergeCoverage(const std::array<uint64_t, N_WORDS>& local);
+};
+
+#endif // FUZZ_H
@@ -19,6 +19,13 @@ public:
     // Load program from text file (byte format)
     bool loadProgram(const std::string& filename);
     
+    // Load program from already-packed words (word 0 at address 0)
+    void loadWords(const std::vector<uint32_t>& words);
+    
+    // Backdoor read, no timing (for tools)
+    uint32_t peek(uint32_t addr) const;
+    int getDepthWords() const { return DEPTH_WORDS; }
+    
     // BRAM-style interface
     void tick(bool en, uint32_t addr);
     
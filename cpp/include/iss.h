@@ -0,0 +1,73 @@
+#ifndef ISS_H
+#define ISS_H
+
+#include "types.h"
+#include <array>
+#include <string>
+#include <vector>
+
+// Architectural (untimed) reference simulator for the instruction subset
+// Decode supports (including RV32M). Unsupported encodings follow Decode's fallbacks (other
+// OP/OP-IMM funct3 -> add, unknown opcodes -> nop), and memories mirror
+// ICache (512 words, NOP beyond) and DMem (1024 words, index wraps).
+class ISS {
+public:
+    static constexpr int IMEM_WORDS = 512;
+    static constexpr int DMEM_WORDS = 1024;
+    
+    // Architectural effects of one instruction
+    struct StepInfo {
+        xlen_t pc;
+        uint32_t instr;
+        xlen_t next_pc;
+        
+        bool rd_written;    // rd != 0 and the instruction writes rd
+        reg_t rd;
+        xlen_t rd_value;
+        
+        bool is_store;
+        uint32_t store_addr;
+        uint32_t store_data;
+        LSSize store_size;
+    };
+
+private:
+    std::array<uint32_t, IMEM_WORDS> imem;
+    std::array<uint32_t, DMEM_WORDS> dmem;
+    std::array<xlen_t, N_ARCH_REGS> regs;
+    xlen_t pc;
+    uint64_t inst_count;
+
+public:
+    ISS();
+    void reset();
+    
+    bool loadProgram(const std::string& filename);
+    void loadWords(const std::vector<uint32_t>& words);
+    
+    // Execute the instruction at pc
+    StepInfo step();
+    
+    // Execute a caller-supplied instruction as if it sat at pc
+    StepInfo execute(uint32_t instr);
+    
+    // Run until the program parks in a self-loop or max_insts retire;
+    // returns true if it halted
+    bool run(uint64_t max_insts);
+    
+    xlen_t getReg(reg_t r) const { return regs[r]; }
+    xlen_t getPC() const { return pc; }
+    uint64_t getInstCount() const { return inst_count; }
+    uint32_t readWord(uint32_t addr) const { return dmem[(addr >> 2) & (DMEM_WORDS - 1)]; }
+    uint32_t fetch(xlen_t addr) const;
+    
+    // Checkpoint for BasicCore::loadArchState
+    ArchState getState() const;
+    
+private:
+    uint32_t load(uint32_t addr, LSSize size, bool uns) const;
+    void store(uint32_t addr, uint32_t data, LSSize size);
+    static xlen_t mulDiv(uint32_t f3, xlen_t a, xlen_t b);
+};
+
+#endif // ISS_H
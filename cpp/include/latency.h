@@ -0,0 +1,109 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "observer.h"
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+// Fixed log2 buckets: 0 holds latency 0, bucket i >= 1 holds
+// [2^(i-1), 2^i), the last one everything larger
+struct LatencyHist {
+    static constexpr int BUCKETS = 16;
+    
+    std::array<uint64_t, BUCKETS> buckets{};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    
+    void add(uint64_t v);
+    void merge(const LatencyHist& o);
+    double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+    
+    // Upper bound of the bucket holding quantile q (0..1)
+    uint64_t quantileBound(double q) const;
+    
+    static int bucketOf(uint64_t v);
+};
+
+// Lifecycle intervals of a committed instruction
+enum class LatStage : uint8_t {
+    DISPATCH_READY = 0,     // dispatched until the last source operand is written back
+    READY_ISSUE = 1,        // operands ready until selected (arbiter, in-order RS, LSU block, ROB head, divider busy)
+    ISSUE_WB = 2,           // in the FU
+    WB_COMMIT = 3,          // done, waiting to reach the ROB head
+    COUNT = 4
+};
+
+enum class OpClass : uint8_t {
+    ALU_REG = 0,
+    ALU_IMM = 1,
+    LUI = 2,
+    LOAD = 3,
+    STORE = 4,
+    BRANCH = 5,
+    JUMP = 6,
+    MUL = 7,
+    DIV = 8,
+    COUNT = 9
+};
+
+const char* latStageName(LatStage s);
+const char* opClassName(OpClass c);
+const char* fuTypeName(FUType fu);
+OpClass classifyOp(const RSEntry& e);
+
+// Per-FUType and per-opcode-class histograms of every stage. All counters
+// are additive, so results of separate runs merge by summing (and taking
+// the max of max); the CSV form round-trips through read()/write().
+struct LatencyStats {
+    static constexpr int N_FU = 4;
+    static constexpr int N_STAGE = static_cast<int>(LatStage::COUNT);
+    static constexpr int N_CLASS = static_cast<int>(OpClass::COUNT);
+    
+    std::array<std::array<LatencyHist, N_STAGE>, N_FU> by_fu;
+    std::array<std::array<LatencyHist, N_STAGE>, N_CLASS> by_class;
+    
+    void merge(const LatencyStats& o);
+    
+    // "group,key,stage,count,sum,max,b0..b15" rows; read() adds to *this
+    void write(std::ostream& os) const;
+    bool read(std::istream& is);
+    
+    // Human-readable summary (mean, p50/p90 bucket bounds per stage)
+    void print(std::ostream& os) const;
+};
+
+// Observer filling LatencyStats. In-flight instructions live in a
+// per-ROB-tag table, so tracking allocates nothing per instruction.
+class LatencyObserver : public NoObserver {
+private:
+    static constexpr uint64_t NONE = ~0ull;
+    
+    struct Inflight {
+        bool valid;
+        FUType fu;
+        OpClass cls;
+        preg_t wait1, wait2;    // pending source pregs, 0 once written back
+        uint64_t dispatch, ready, issue, wb;
+    };
+    
+    std::array<Inflight, ROB_DEPTH> inflight;
+    std::bitset<N_PHYS_REGS> pending;      // renamed destination not yet written back
+    LatencyStats stats;
+    
+public:
+    LatencyObserver();
+    
+    void onRename(uint64_t cycle, const RenamePkt& pkt);
+    void onDispatch(uint64_t cycle, const RSEntry& entry);
+    void onIssue(uint64_t cycle, const RSEntry& entry);
+    void onWriteback(uint64_t cycle, FUType fu, const WBPkt& wb);
+    void onCommit(uint64_t cycle, const CommitPkt& c);
+    void onSquash(uint64_t cycle, rob_tag_t tag);
+    
+    const LatencyStats& getStats() const { return stats; }
+};
+
+#endif // LATENCY_H
@@ -3,6 +3,7 @@
 
 #include "types.h"
 #include <array>
+#include <bitset>
 
 class LSUFU {
 private:
@@ -25,25 +26,26 @@ public:
     LSUFU();
     void reset();
     
-    void tick(bool flush, bool issue_valid, const RSEntry& entry,
-              xlen_t src1, xlen_t src2, bool dmem_rvalid, uint32_t dmem_rdata);
+    void tick(bool flush, const std::bitset<ROB_DEPTH>& live_tag,
+              bool issue_valid, const RSEntry& entry,
+              xlen_t src1, xlen_t src2);
     
     // Outputs
     WBPkt getWB(bool dmem_rvalid, uint32_t dmem_rdata) const;
+    bool canIssue() const { return block_cnt == 0; }
+    bool isIdle() const { return !m0_q.v && !m1_q.v && block_cnt == 0; }
     
-    // DMEM control
-    bool getDMemEn() const;
-    bool getDMemWE() const;
-    uint32_t getDMemAddr() const;
-    uint32_t getDMemWData() const;
-    LSSize getDMemSize() const;
+    // DMEM control (combinational on the issued entry)
+    bool getDMemEn(bool issue_valid) const { return issue_valid && canIssue(); }
+    bool getDMemWE(const RSEntry& entry) const { return entry.is_store; }
+    // A fused add + load (FuseRule::ADD_LOAD) also adds src2
+    uint32_t getDMemAddr(const RSEntry& entry, xlen_t src1, xlen_t src2) const {
+        return src1 + entry.imm + (entry.fuse == FuseRule::ADD_LOAD ? src2 : 0);
+    }
+    uint32_t getDMemWData(xlen_t src2) const { return src2; }
+    LSSize getDMemSize(const RSEntry& entry) const { return entry.ls_size; }
     
 private:
-    bool allow_issue;
-    RSEntry entry_latched;
-    xlen_t src1_latched;
-    xlen_t src2_latched;
-    
     uint32_t extractLoad(uint32_t rdata, const Meta& m) const;
 };
 
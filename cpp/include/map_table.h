@@ -3,24 +3,41 @@
 
 #include "types.h"
 #include <array>
+#include <vector>
 
 class MapTable {
 private:
     std::array<preg_t, N_ARCH_REGS> rat;
-    std::array<RATSnapshot, ROB_DEPTH> ckpt_rat;
+    std::vector<RATSnapshot> ckpt_rat;     // indexed by checkpoint slot
+    std::array<preg_t, N_ARCH_REGS> arch_rat;   // committed mappings
 
 public:
     MapTable();
-    void reset();
     
-    void tick(bool flush, bool recover, rob_tag_t recover_tag,
+    // x1-x31 map to P(base + 1)..P(base + 31), x0 to P0 (an SMT thread
+    // other than the first starts on its own block of pregs)
+    void reset(preg_t base = 0);
+    
+    // One snapshot per checkpoint slot; set between runs
+    void setCkptSlots(int n) { ckpt_rat.assign(n, {rat}); }
+    size_t getCkptBytes() const { return ckpt_rat.size() * sizeof(RATSnapshot); }
+    
+    void tick(bool flush, bool recover, ckpt_t recover_ckpt,
               bool we, reg_t we_arch, preg_t we_new_phys,
-              bool checkpoint_take, rob_tag_t checkpoint_tag);
+              bool checkpoint_take, ckpt_t checkpoint_id);
     
     // Combinational reads
     preg_t lookupRS1(reg_t rs1) const { return rat[rs1]; }
     preg_t lookupRS2(reg_t rs2) const { return rat[rs2]; }
     preg_t lookupRDOld(reg_t rd) const { return rat[rd]; }
+    
+    // Retirement map, updated by ROB commit
+    void commit(reg_t rd, preg_t prd) { if (rd != 0) arch_rat[rd] = prd; }
+    preg_t lookupArch(reg_t r) const { return arch_rat[r]; }
+    
+    // ROB-walk recovery: put back the mapping a squashed rename replaced
+    // (applied youngest first)
+    void undo(reg_t rd, preg_t old_prd) { if (rd != 0) rat[rd] = old_prd; }
 };
 
 #endif // MAP_TABLE_H
@@ -0,0 +1,71 @@
+#ifndef MDU_FU_H
+#define MDU_FU_H
+
+#include "types.h"
+#include <array>
+#include <bitset>
+
+// RV32M unit: a pipelined multiplier (MUL/MULH/MULHSU/MULHU, one issue
+// per cycle, fixed latency) and a non-pipelined radix-2 divider
+// (DIV/DIVU/REM/REMU) with early-out. Both share one writeback port; the
+// multiplier has priority, so a finished division waits while the
+// multiplier pipeline is delivering.
+class MDUFU {
+public:
+    static constexpr int MAX_MUL_LATENCY = 8;
+    static constexpr int DEFAULT_MUL_LATENCY = 3;
+    
+private:
+    struct Op {
+        bool v;
+        bool rd_used;
+        rob_tag_t rob_tag;
+        preg_t prd;
+        xlen_t data;
+    };
+    
+    // mul_q[0] is filled at issue, mul_q[mul_latency - 1] writes back
+    std::array<Op, MAX_MUL_LATENCY> mul_q;
+    int mul_latency;
+    
+    Op div_q;
+    uint8_t div_cnt;        // cycles until the quotient/remainder is ready
+    
+public:
+    MDUFU();
+    void reset();
+    
+    // Cycles from issue to writeback (1..MAX_MUL_LATENCY); set between runs
+    void setMulLatency(int cycles);
+    int getMulLatency() const { return mul_latency; }
+    
+    // On flush, in-flight ops whose tag is not in live_tag are dropped
+    void tick(bool flush, const std::bitset<ROB_DEPTH>& live_tag,
+              bool issue_valid, const RSEntry& entry,
+              xlen_t src1, xlen_t src2);
+    
+    // Outputs
+    WBPkt getWB() const;
+    bool canIssue(const RSEntry& entry) const { return !isDiv(entry) || !div_q.v; }
+    bool isIdle() const;
+    
+    // Cycles after this one with no writeback and nothing the unit can
+    // change but the divider countdown: UINT64_MAX when empty, the rest
+    // of the division when only the divider is busy, else 0
+    uint64_t quietCycles() const;
+    // Fast-forward n of those cycles
+    void skipIdle(uint64_t n) { if (div_q.v) div_cnt = static_cast<uint8_t>(div_cnt - n); }
+    
+    static bool isDiv(const RSEntry& entry) { return entry.alu_op >= ALUOp::DIV; }
+    
+    // Divider cycles for a / b: one per quotient bit (the dividend's
+    // leading one down to the divisor's) plus one for the sign fix-up.
+    // Division by zero, overflow and |a| < |b| take one.
+    static int divLatency(const RSEntry& entry, xlen_t a, xlen_t b);
+    
+private:
+    bool mulWB() const { return mul_q[mul_latency - 1].v; }
+    static xlen_t execute(ALUOp op, xlen_t a, xlen_t b);
+};
+
+#endif // MDU_FU_H
@@ -0,0 +1,64 @@
+#ifndef MULTICORE_H
+#define MULTICORE_H
+
+#include "core.h"
+#include "shared_mem.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+struct MultiCoreConfig {
+    int cores = 2;
+    int threads = 0;        // host threads; 0 = min(cores, hardware), 1 = serial
+    uint64_t quantum = 1;   // cycles between barriers (stores become visible to other harts)
+};
+
+struct MultiCoreStats {
+    uint64_t cycles;
+    uint64_t commits;       // sum over cores
+    uint64_t recoveries;    // sum over cores
+    int halted;             // cores parked in their final self-loop
+    double host_sec;        // wall time spent in run()
+};
+
+// N cores running the same program (SPMD: each sees its hart id in a0)
+// over one SharedMem. Cores advance in quanta: every core runs `quantum`
+// cycles, then all pending stores are published in (cycle, hart) order.
+// Cores are spread over host threads within a quantum; the result is the
+// same for any thread count, so threads = 1 is the debugging mode.
+class MultiCore {
+private:
+    MultiCoreConfig cfg;
+    SharedMem mem;
+    std::vector<std::unique_ptr<Core>> cores;
+    
+    uint64_t cycle_count;
+    double host_sec;
+    
+    // Cycles in the next quantum, 0 when the run is over
+    uint64_t nextQuantum(uint64_t end_cycle, bool stop_when_halted) const;
+    void runCores(int first, int last, uint64_t cycles);
+
+public:
+    explicit MultiCore(const MultiCoreConfig& config);
+    
+    bool loadProgram(const std::string& filename);
+    void loadProgramWords(const std::vector<uint32_t>& words);
+    void reset();
+    
+    // Run up to max_cycles (optionally stopping once every core halted);
+    // returns cycles simulated
+    uint64_t run(uint64_t max_cycles, bool stop_when_halted = true);
+    
+    int getNumCores() const { return static_cast<int>(cores.size()); }
+    int getNumThreads() const;
+    Core& getCore(int hart) { return *cores[hart]; }
+    const Core& getCore(int hart) const { return *cores[hart]; }
+    
+    uint64_t getCycleCount() const { return cycle_count; }
+    bool allHalted() const;
+    MultiCoreStats getStats() const;
+    uint32_t readMemWord(uint32_t addr) const { return mem.peek(addr); }
+};
+
+#endif // MULTICORE_H
@@ -0,0 +1,104 @@
+#ifndef OBSERVER_H
+#define OBSERVER_H
+
+#include "types.h"
+#include <tuple>
+#include <type_traits>
+
+// Pipeline event hooks for BasicCore<Observer>.
+//
+// An observer is any class with these member functions; derive from
+// NoObserver and override (hide) only the ones you need. Calls are
+// resolved at compile time, so the empty defaults inline away and
+// BasicCore<NoObserver> generates the same code as a core without hooks.
+// `cycle` is the cycle in which the event happens (0-based). With several
+// hardware threads (BasicCore::setThreads) every thread's events arrive;
+// ROB tags are unique across threads.
+struct NoObserver {
+    // Instruction latched out of fetch / decode / rename
+    void onFetch(uint64_t cycle, const FetchPkt& pkt) { (void)cycle; (void)pkt; }
+    void onDecode(uint64_t cycle, const DecodePkt& pkt) { (void)cycle; (void)pkt; }
+    void onRename(uint64_t cycle, const RenamePkt& pkt) { (void)cycle; (void)pkt; }
+    
+    // Written into an RS and the ROB
+    void onDispatch(uint64_t cycle, const RSEntry& entry) { (void)cycle; (void)entry; }
+    
+    // Selected by the issue arbiter (entry.fu_type says which FU)
+    void onIssue(uint64_t cycle, const RSEntry& entry) { (void)cycle; (void)entry; }
+    
+    // FU result broadcast to PRF, ROB and RSs
+    void onWriteback(uint64_t cycle, FUType fu, const WBPkt& wb) { (void)cycle; (void)fu; (void)wb; }
+    
+    // Store sent to DMem (stores issue only once they reach the ROB head,
+    // so they always commit; data is the full rs2 value)
+    void onStore(uint64_t cycle, rob_tag_t tag, uint32_t addr, uint32_t data, LSSize size) {
+        (void)cycle; (void)tag; (void)addr; (void)data; (void)size;
+    }
+    
+    // Retired from the ROB head
+    void onCommit(uint64_t cycle, const CommitPkt& c) { (void)cycle; (void)c; }
+    
+    // BRU resolved a taken branch/jump (predicted not-taken)
+    void onMispredict(uint64_t cycle, rob_tag_t tag, xlen_t target) { (void)cycle; (void)tag; (void)target; }
+    
+    // Recovery applied to rename state, ROB and RSs; fetch restarts at flush_pc
+    void onRecover(uint64_t cycle, rob_tag_t tag, xlen_t flush_pc) { (void)cycle; (void)tag; (void)flush_pc; }
+    
+    // Renamed instruction discarded by that recovery
+    void onSquash(uint64_t cycle, rob_tag_t tag) { (void)cycle; (void)tag; }
+    
+    // Once per cycle, after the events above
+    void onCycle(const CycleRecord& r) { (void)r; }
+    
+    // Polled by run() after every cycle; true ends the run early
+    bool stopRequested() const { return false; }
+};
+
+// Fans every event out to several observers, in order
+template <typename... Obs>
+class Observers {
+private:
+    std::tuple<Obs...> obs;
+    
+    template <typename F>
+    void each(F&& f) {
+        std::apply([&](auto&... o) { (f(o), ...); }, obs);
+    }
+
+public:
+    Observers() = default;
+    explicit Observers(const Obs&... o) : obs(o...) {}
+    
+    template <typename T> T& get() { return std::get<T>(obs); }
+    template <std::size_t I> auto& get() { return std::get<I>(obs); }
+    
+    void onFetch(uint64_t cycle, const FetchPkt& pkt) { each([&](auto& o) { o.onFetch(cycle, pkt); }); }
+    void onDecode(uint64_t cycle, const DecodePkt& pkt) { each([&](auto& o) { o.onDecode(cycle, pkt); }); }
+    void onRename(uint64_t cycle, const RenamePkt& pkt) { each([&](auto& o) { o.onRename(cycle, pkt); }); }
+    void onDispatch(uint64_t cycle, const RSEntry& e) { each([&](auto& o) { o.onDispatch(cycle, e); }); }
+    void onIssue(uint64_t cycle, const RSEntry& e) { each([&](auto& o) { o.onIssue(cycle, e); }); }
+    void onWriteback(uint64_t cycle, FUType fu, const WBPkt& wb) { each([&](auto& o) { o.onWriteback(cycle, fu, wb); }); }
+    void onStore(uint64_t cycle, rob_tag_t tag, uint32_t addr, uint32_t data, LSSize size) {
+        each([&](auto& o) { o.onStore(cycle, tag, addr, data, size); });
+    }
+    void onCommit(uint64_t cycle, const CommitPkt& c) { each([&](auto& o) { o.onCommit(cycle, c); }); }
+    void onMispredict(uint64_t cycle, rob_tag_t tag, xlen_t target) { each([&](auto& o) { o.onMispredict(cycle, tag, target); }); }
+    void onRecover(uint64_t cycle, rob_tag_t tag, xlen_t pc) { each([&](auto& o) { o.onRecover(cycle, tag, pc); }); }
+    void onSquash(uint64_t cycle, rob_tag_t tag) { each([&](auto& o) { o.onSquash(cycle, tag); }); }
+    void onCycle(const CycleRecord& r) { each([&](auto& o) { o.onCycle(r); }); }
+    
+    bool stopRequested() const {
+        return std::apply([](const auto&... o) { return (o.stopRequested() || ...); }, obs);
+    }
+};
+
+// True if O hides NoObserver::onCycle. BasicCore fills a CycleRecord
+// every cycle only for such observers.
+template <typename O>
+struct ObservesCycles
+    : std::bool_constant<!std::is_same_v<decltype(&O::onCycle), decltype(&NoObserver::onCycle)>> {};
+
+template <typename... Obs>
+struct ObservesCycles<Observers<Obs...>> : std::bool_constant<(ObservesCycles<Obs>::value || ...)> {};
+
+#endif // OBSERVER_H
@@ -0,0 +1,108 @@
+#ifndef OOOP_C_H
+#define OOOP_C_H
+
+/*
+ * C ABI for the OOOP C++ model (libooop.so).
+ *
+ * Plain C types only, so it can be bound from ctypes or any FFI. A core
+ * handle owns one simulated core; handles are independent and may be used
+ * from different threads, but a single handle is not thread safe.
+ * Functions returning int return 0 on success and -1 on error.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define OOOP_API __attribute__((visibility("default")))
+#else
+#define OOOP_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on any incompatible change to this header */
+#define OOOP_API_VERSION 1
+
+typedef struct ooop_core ooop_core;
+
+/* Conditions for ooop_run_until */
+enum {
+    OOOP_UNTIL_HALT = 0,      /* program parked in its final self-loop */
+    OOOP_UNTIL_COMMITS = 1,   /* commit count >= arg */
+    OOOP_UNTIL_PC = 2,        /* an instruction at PC arg committed */
+    OOOP_UNTIL_CYCLE = 3      /* cycle count >= arg */
+};
+
+/* Reservation station selectors for ooop_rs_count */
+enum {
+    OOOP_RS_ALU = 0,
+    OOOP_RS_BRU = 1,
+    OOOP_RS_LSU = 2,
+    OOOP_RS_MDU = 3
+};
+
+typedef struct {
+    uint64_t cycles;
+    uint64_t commits;
+    uint64_t recoveries;      /* mispredicts that flushed the pipeline */
+    uint32_t last_commit_pc;
+    uint32_t halted;
+} ooop_stats;
+
+/* Per-cycle predicate for ooop_run_while: return nonzero to keep going */
+typedef int (*ooop_predicate)(ooop_core* core, void* user);
+
+OOOP_API int ooop_api_version(void);
+
+/* Lifetime */
+OOOP_API ooop_core* ooop_create(void);
+OOOP_API void ooop_destroy(ooop_core* core);
+OOOP_API void ooop_reset(ooop_core* core);
+
+/* Program (call ooop_reset afterwards to restart from PC 0) */
+OOOP_API int ooop_load_program(ooop_core* core, const char* path);
+OOOP_API int ooop_load_words(ooop_core* core, const uint32_t* words, size_t count);
+
+/* Execution; both return the number of cycles simulated */
+OOOP_API uint64_t ooop_step(ooop_core* core, uint64_t cycles);
+OOOP_API uint64_t ooop_run_until(ooop_core* core, int cond, uint64_t arg, uint64_t max_cycles);
+OOOP_API uint64_t ooop_run_while(ooop_core* core, ooop_predicate pred, void* user,
+                                 uint64_t max_cycles);
+
+/*
+ * Time travel: snapshot the whole core every interval cycles, keeping at
+ * most max_snapshots (thinned exponentially with age). Enabling starts
+ * from the current state, interval 0 disables; ooop_reset starts again.
+ * While enabled, ooop_step and ooop_run_* take the snapshots.
+ * ooop_goto_cycle restores the nearest earlier snapshot and simulates
+ * forward (deterministic, so the state is the one the first run had);
+ * it fails if time travel is off or the cycle is older than every
+ * snapshot.
+ */
+OOOP_API int ooop_time_travel(ooop_core* core, uint64_t interval, int max_snapshots);
+OOOP_API int ooop_goto_cycle(ooop_core* core, uint64_t cycle);
+OOOP_API int ooop_step_back(ooop_core* core, uint64_t cycles);
+
+/* Fingerprint of counts, registers and data memory; equal for equal runs */
+OOOP_API uint64_t ooop_state_hash(const ooop_core* core);
+
+/* Architectural and physical state */
+OOOP_API uint32_t ooop_arch_reg(const ooop_core* core, unsigned reg);
+OOOP_API unsigned ooop_arch_mapping(const ooop_core* core, unsigned reg);
+OOOP_API uint32_t ooop_phys_reg(const ooop_core* core, unsigned preg);
+OOOP_API int ooop_phys_valid(const ooop_core* core, unsigned preg);
+OOOP_API uint32_t ooop_read_mem(const ooop_core* core, uint32_t addr);
+
+/* Occupancy and stats */
+OOOP_API int ooop_rob_count(const ooop_core* core);
+OOOP_API int ooop_rs_count(const ooop_core* core, int rs);
+OOOP_API void ooop_get_stats(const ooop_core* core, ooop_stats* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OOOP_C_H */
@@ -0,0 +1,88 @@
+#ifndef PIPE_QUEUE_H
+#define PIPE_QUEUE_H
+
+#include <array>
+#include <cstdint>
+
+// Pipeline queue between two stages: a ring of up to MaxDepth entries,
+// of which depth are usable. Depth 1 is a plain pipeline register; the
+// consumer pops and the producer pushes at the same clock edge, so a
+// full queue still accepts when its head leaves (getReady(pop)).
+// occupancy() is a histogram of entries held, one sample per cycle.
+template <typename T, int MaxDepth>
+class PipeQueue {
+public:
+    static constexpr int MAX_DEPTH = MaxDepth;
+    using Histogram = std::array<uint64_t, MaxDepth + 1>;
+    
+private:
+    std::array<T, MaxDepth> slots;
+    int depth;
+    int head;
+    int count;
+    Histogram hist;
+    
+public:
+    PipeQueue() : slots{}, depth(1), head(0), count(0), hist{} {}
+    
+    // Empties the queue and clears the histogram
+    void reset() {
+        slots.fill(T{});
+        head = 0;
+        count = 0;
+        hist.fill(0);
+    }
+    
+    // 1..MaxDepth, clamped; empties the queue
+    void setDepth(int d) {
+        depth = d < 1 ? 1 : d > MaxDepth ? MaxDepth : d;
+        reset();
+    }
+    int getDepth() const { return depth; }
+    
+    bool empty() const { return count == 0; }
+    bool full() const { return count == depth; }
+    int size() const { return count; }
+    
+    // Room for a push at this edge, given whether the head pops at it
+    bool getReady(bool pop) const { return count < depth || pop; }
+    
+    // i = 0 is the head (oldest)
+    const T& front() const { return slots[head]; }
+    const T& at(int i) const { return slots[(head + i) % depth]; }
+    
+    void push(const T& v) {
+        slots[(head + count) % depth] = v;
+        count++;
+    }
+    void pop() {
+        if (++head == depth) head = 0;
+        count--;
+    }
+    void flush() {
+        head = 0;
+        count = 0;
+    }
+    
+    // Record the current occupancy for n cycles
+    void sample(uint64_t n = 1) { hist[count] += n; }
+    const Histogram& occupancy() const { return hist; }
+};
+
+// The core's stage boundaries (BasicCore::setQueueDepth)
+enum class StageQueue : uint8_t {
+    F2D = 0,        // fetch -> decode
+    D2R = 1,        // decode -> rename
+    R2D = 2,        // rename -> dispatch
+    DISPATCH = 3    // dispatch FIFO -> RS/ROB
+};
+constexpr int N_STAGE_QUEUES = 4;
+constexpr int MAX_STAGE_QUEUE_DEPTH = 8;
+using StageQueueHistogram = std::array<uint64_t, MAX_STAGE_QUEUE_DEPTH + 1>;
+
+inline const char* stageQueueName(StageQueue q) {
+    static constexpr const char* names[N_STAGE_QUEUES] = {"f2d", "d2r", "r2d", "disp"};
+    return names[static_cast<int>(q)];
+}
+
+#endif // PIPE_QUEUE_H
@@ -0,0 +1,82 @@
+#ifndef PIPEVIEW_H
+#define PIPEVIEW_H
+
+#include "observer.h"
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <ostream>
+
+// Which instructions to write: fetched in [cycle_begin, cycle_end) and
+// with sequence number in [seq_begin, seq_end)
+struct PipeViewConfig {
+    uint64_t cycle_begin = 0;
+    uint64_t cycle_end = std::numeric_limits<uint64_t>::max();
+    uint64_t seq_begin = 0;
+    uint64_t seq_end = std::numeric_limits<uint64_t>::max();
+    uint64_t ticks_per_cycle = 1000;    // gem5 util/o3-pipeview.py default cycle time
+};
+
+// Observer writing the gem5 O3PipeView trace (also read by Konata).
+//
+// Every fetched instruction gets a sequence number and the cycles of its
+// fetch, decode, rename, dispatch, issue, writeback ("complete") and
+// commit ("retire"); both halves of a fused pair show the pair's
+// cycles from decode on. Stages never reached print as 0; a squashed
+// instruction has retire 0. Records are written in sequence order as soon
+// as the oldest one retires or is squashed, so memory stays bounded by
+// the instructions in flight. Only BasicCore<PipeView> pays for this;
+// Core is unaffected.
+class PipeView : public NoObserver {
+private:
+    static constexpr int64_t NONE = -1;
+
+    struct Record {
+        uint64_t seq;
+        xlen_t pc;
+        uint32_t instr;
+        bool is_store;
+        bool fused;                     // first half: the next record shares its stages
+        int64_t fetch, decode, rename, dispatch, issue, complete, retire;
+        bool done;
+    };
+
+    std::ostream* out;
+    PipeViewConfig cfg;
+
+    std::deque<Record> inflight;        // oldest first, seq consecutive
+    uint64_t next_seq;
+    uint64_t next_decode;               // oldest fetched, not yet decoded
+    uint64_t next_rename;               // oldest decoded, not yet renamed
+    std::array<uint64_t, ROB_DEPTH> tag_seq;
+    int64_t flush_cycle;
+    int64_t fused_decode;               // pair decoded as its second half is fetched
+    uint64_t written;
+
+    Record* find(uint64_t seq);
+    void stamp(uint64_t seq, int64_t Record::*stage, int64_t cycle);
+    void finish(uint64_t seq, int64_t retire);
+    void drain();
+    void write(const Record& r);
+
+public:
+    PipeView();
+    PipeView(std::ostream* os, const PipeViewConfig& config);
+
+    void onFetch(uint64_t cycle, const FetchPkt& pkt);
+    void onDecode(uint64_t cycle, const DecodePkt& pkt);
+    void onRename(uint64_t cycle, const RenamePkt& pkt);
+    void onDispatch(uint64_t cycle, const RSEntry& entry);
+    void onIssue(uint64_t cycle, const RSEntry& entry);
+    void onWriteback(uint64_t cycle, FUType fu, const WBPkt& wb);
+    void onCommit(uint64_t cycle, const CommitPkt& c);
+    void onRecover(uint64_t cycle, rob_tag_t tag, xlen_t flush_pc);
+    void onSquash(uint64_t cycle, rob_tag_t tag);
+
+    // Write what is still in flight (unretired, so retire 0) and flush
+    void close();
+
+    uint64_t getWritten() const { return written; }
+};
+
+#endif // PIPEVIEW_H
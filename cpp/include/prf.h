@@ -4,29 +4,42 @@
 #include "types.h"
 #include <array>
 #include <bitset>
+#include <vector>
 
 class PRF {
 private:
     std::array<xlen_t, N_PHYS_REGS> regs;
     std::bitset<N_PHYS_REGS> valid_bits;
     
-    std::array<PRFValidSnapshot, ROB_DEPTH> ckpt_valid;
-    std::array<std::array<xlen_t, N_PHYS_REGS>, ROB_DEPTH> ckpt_regs;
+    // Indexed by checkpoint slot. Taken at every branch as prf.sv does;
+    // recovery never reads them back (see tick)
+    std::vector<PRFValidSnapshot> ckpt_valid;
+    std::vector<std::array<xlen_t, N_PHYS_REGS>> ckpt_regs;
 
 public:
     PRF();
     void reset();
     
-    void tick(bool flush, bool recover, rob_tag_t recover_tag,
+    // One snapshot per checkpoint slot; set between runs
+    void setCkptSlots(int n);
+    size_t getCkptBytes() const {
+        return ckpt_valid.size() * (sizeof(PRFValidSnapshot) + sizeof(ckpt_regs[0]));
+    }
+    
+    void tick(bool flush, bool recover, ckpt_t recover_ckpt,
               const WBPkt& wb_alu, const WBPkt& wb_lsu, const WBPkt& wb_bru,
+              const WBPkt& wb_mdu,
               bool alloc_inval, preg_t alloc_preg,
-              bool checkpoint_take, rob_tag_t checkpoint_tag);
+              bool checkpoint_take, ckpt_t checkpoint_id);
     
     // Combinational reads
     xlen_t read(preg_t addr) const { return regs[addr]; }
     bool isValid(preg_t addr) const { return valid_bits[addr]; }
     
     const std::bitset<N_PHYS_REGS>& getValidBits() const { return valid_bits; }
+    
+    // Backdoor write, no timing (initial register values at reset)
+    void poke(preg_t addr, xlen_t value) { regs[addr] = value; }
 };
 
 #endif // PRF_H
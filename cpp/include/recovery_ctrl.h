@@ -10,18 +10,24 @@ private:
     bool recover_q;
     xlen_t flush_pc_q;
     rob_tag_t recover_tag_q;
+    ckpt_t recover_ckpt_q;
+    FetchPred recover_pred_q;
 
 public:
     RecoveryCtrl();
     void reset();
     
-    void tick(bool mispredict, xlen_t target_pc, rob_tag_t recover_tag);
+    void tick(bool mispredict, xlen_t target_pc, rob_tag_t recover_tag, ckpt_t recover_ckpt,
+              const FetchPred& recover_pred);
     
     // Outputs
     bool getFlush() const { return flush_q; }
     xlen_t getFlushPC() const { return flush_pc_q; }
     bool getRecover() const { return recover_q; }
     rob_tag_t getRecoverTag() const { return recover_tag_q; }
+    ckpt_t getRecoverCkpt() const { return recover_ckpt_q; }
+    const FetchPred& getRecoverPred() const { return recover_pred_q; }
+    bool isIdle() const { return !mp_q && !flush_q && !recover_q; }
 };
 
 #endif // RECOVERY_CTRL_H
@@ -9,23 +9,40 @@ class Rename {
 private:
     MapTable* map_table;
     FreeList* free_list;
+    bool elim_enable;
 
 public:
     Rename(MapTable* mt, FreeList* fl);
     
+    // Move / zero-idiom elimination: ALU ops whose result is a source
+    // register (addi rd, rs, 0; add rd, x0, rs; ...) or zero (sub rd, rs, rs;
+    // andi rd, rs, 0; ...) map rd to that register's preg, or to P0, and
+    // go to the ROB already done. Off by default (RTL behaviour).
+    void setElimination(bool enable) { elim_enable = enable; }
+    bool getElimination() const { return elim_enable; }
+    
     // Combinational rename logic
     RenamePkt rename(const DecodePkt& pkt_in, bool valid_in,
                      const std::bitset<N_PHYS_REGS>& prf_valid,
                      bool tag_ok, rob_tag_t rob_tag,
+                     bool ckpt_ok, ckpt_t ckpt_id,
                      bool ready_in);
     
-    // Check if can proceed
-    bool getReadyOut(const DecodePkt& pkt_in, bool has_free, bool tag_ok, bool ready_in) const;
-    bool getValidOut(const DecodePkt& pkt_in, bool valid_in, bool has_free, bool tag_ok) const;
+    // Check if can proceed (ckpt_ok: a checkpoint slot is free, needed
+    // by branches and jumps only)
+    bool getReadyOut(const DecodePkt& pkt_in, bool has_free, bool tag_ok, bool ckpt_ok,
+                     bool ready_in) const;
+    bool getValidOut(const DecodePkt& pkt_in, bool valid_in, bool has_free, bool tag_ok,
+                     bool ckpt_ok) const;
     
     // Allocation signals
     bool getAllocReq(const DecodePkt& pkt_in, bool fire) const;
     bool getCheckpointTake(const DecodePkt& pkt_in, bool fire) const;
+    
+private:
+    // Architectural register holding the result (x0: it is zero)
+    bool elimSource(const DecodePkt& pkt_in, reg_t& src) const;
+    bool needAlloc(const DecodePkt& pkt_in) const;
 };
 
 #endif // RENAME_H
@@ -4,6 +4,7 @@
 #include "types.h"
 #include <array>
 #include <bitset>
+#include <vector>
 
 class ROB {
 private:
@@ -11,8 +12,13 @@ private:
         bool valid;
         bool done;
         rob_tag_t tag;
+        xlen_t pc;
+        reg_t rd;
         bool rd_used;
+        preg_t prd;
         preg_t old_prd;
+        bool eliminated;
+        FuseRule fuse;
     };
     
     static constexpr int DEPTH = ROB_DEPTH;
@@ -22,24 +28,74 @@ private:
     rob_tag_t tail;
     uint8_t count;
     
-    std::array<ROBPtrsSnapshot, DEPTH> ckpt_ptrs;
-    std::bitset<DEPTH> ckpt_pending;
+    // Tail right after each branch/jump was allocated, indexed by its
+    // checkpoint slot
+    std::vector<ROBPtrsSnapshot> ckpt_ptrs;
+    
+    // ROB-walk recovery: instead of jumping back to ckpt_ptrs, the tail
+    // retreats walk_width entries per cycle until it reaches walk_stop
+    // (just after the branch); each popped entry is undone in the RAT and
+    // free list. 0 selects snapshot recovery.
+    int walk_width;
+    bool walking;
+    rob_tag_t walk_stop;
 
 public:
     ROB();
     void reset();
+    void setWalkWidth(int width) { walk_width = width; }
+    int getWalkWidth() const { return walk_width; }
+    
+    // One snapshot per checkpoint slot; set between runs
+    void setCkptSlots(int n) { ckpt_ptrs.assign(n, {}); }
+    size_t getCkptBytes() const { return ckpt_ptrs.size() * sizeof(ROBPtrsSnapshot); }
     
-    void tick(bool flush, bool recover, rob_tag_t recover_tag,
+    void tick(bool flush, bool recover, rob_tag_t recover_tag, ckpt_t recover_ckpt,
               bool alloc_valid, const RenamePkt& alloc_pkt,
               const WBPkt& wb_alu, const WBPkt& wb_lsu, const WBPkt& wb_bru,
-              bool checkpoint_take, rob_tag_t checkpoint_tag);
+              const WBPkt& wb_mdu,
+              bool checkpoint_take, ckpt_t checkpoint_id);
     
     // Outputs
     bool getReady() const { return count < DEPTH; }
+    bool getCommit() const;
     bool getFreeReq() const;
     preg_t getFreePreg() const;
+    reg_t getCommitRd() const { return entries[head].rd; }
+    preg_t getCommitPrd() const { return entries[head].prd; }
+    bool getCommitRdUsed() const { return entries[head].rd_used; }
+    bool getCommitEliminated() const { return entries[head].eliminated; }
+    FuseRule getCommitFuse() const { return entries[head].fuse; }
+    xlen_t getCommitPC() const { return entries[head].pc; }
+    rob_tag_t getHeadTag() const { return entries[head].tag; }
+    CommitPkt getCommitPkt() const {
+        const Entry& e = entries[head];
+        return {e.tag, e.pc, e.rd, e.rd_used, e.prd, e.old_prd, 0, e.fuse};
+    }
+    bool getHeadValid() const { return count > 0; }
+    
+    // Walk recovery in progress (rename must wait: the RAT is not restored)
+    bool isWalking() const { return walking; }
+    
+    // Entries the walk pops this cycle, youngest first; fills out[] and
+    // returns how many (at most walk_width)
+    int getWalkUndo(RenamePkt* out) const;
+    
+    // Entries a snapshot recovery to recover_ckpt squashes at once (the
+    // same fields as getWalkUndo, oldest first; out[] holds ROB_DEPTH)
+    int getRecoverUndo(ckpt_t recover_ckpt, RenamePkt* out) const;
+    int getCount() const { return count; }
+    rob_tag_t getHead() const { return head; }
+    rob_tag_t getTail() const { return tail; }
     std::bitset<DEPTH> getLiveTag() const;
     
+    // Tags that survive a recovery to the branch holding recover_ckpt
+    // (head up to the branch)
+    std::bitset<DEPTH> getRecoverLiveTag(ckpt_t recover_ckpt) const;
+    
+    // Same set without a snapshot: head up to the entry holding tag
+    std::bitset<DEPTH> getLiveTagUpTo(rob_tag_t tag) const;
+    
 private:
     bool wbHits(const WBPkt& wb, rob_tag_t tag) const;
 };
@@ -3,31 +3,40 @@
 
 #include "types.h"
 #include <bitset>
-#include <array>
+#include <vector>
 
 class ROBTagAlloc {
 private:
     rob_tag_t next_tag;
     std::bitset<ROB_DEPTH> reserved;
-    std::array<rob_tag_t, ROB_DEPTH> ckpt_next_tag;
+    std::vector<rob_tag_t> ckpt_next_tag;     // indexed by checkpoint slot
 
 public:
     ROBTagAlloc();
     void reset();
     
-    void tick(bool flush, bool recover, rob_tag_t recover_tag,
+    // One snapshot per checkpoint slot; set between runs
+    void setCkptSlots(int n) { ckpt_next_tag.assign(n, 0); }
+    size_t getCkptBytes() const { return ckpt_next_tag.size() * sizeof(rob_tag_t); }
+    
+    void tick(bool flush, bool recover, ckpt_t recover_ckpt,
               bool alloc_req, const std::bitset<ROB_DEPTH>& live_tag,
               bool rob_alloc_fire, rob_tag_t rob_alloc_tag,
-              bool checkpoint_take, rob_tag_t checkpoint_tag);
+              bool checkpoint_take, ckpt_t checkpoint_id);
+    
+    // Outputs (combinational on current state + ROB live tags)
+    bool getAllocOk(const std::bitset<ROB_DEPTH>& live_tag) const;
+    rob_tag_t getTag(const std::bitset<ROB_DEPTH>& live_tag) const;
+    
+    // ROB-walk recovery: continue right after the branch's tag, which is
+    // what the snapshot would have restored
+    void resumeAfter(rob_tag_t tag) { next_tag = (tag + 1) & (ROB_DEPTH - 1); }
     
-    // Outputs
-    bool getAllocOk() const;
-    rob_tag_t getTag() const;
+    // Tags handed to rename and not yet in the ROB
+    const std::bitset<ROB_DEPTH>& getReserved() const { return reserved; }
     
 private:
     rob_tag_t findFreeTag(const std::bitset<ROB_DEPTH>& used) const;
-    bool alloc_ok_q;
-    rob_tag_t tag_q;
 };
 
 #endif // ROB_TAG_ALLOC_H
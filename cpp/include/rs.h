@@ -10,27 +10,39 @@ private:
     static constexpr int DEPTH = RS_DEPTH;
     std::array<RSEntry, DEPTH> entries;
     std::array<bool, DEPTH> occupied;
+    std::array<uint32_t, DEPTH> age;   // insertion order, smaller = older
+    uint32_t age_ctr;
     
-    bool hold_valid_q;
-    int hold_idx_q;
+    // In-order RSs only ever offer their oldest entry (BRU, LSU)
+    bool in_order;
+    
+    // Outputs, recomputed by refresh() only when a tick changed the
+    // entries (the core reads them several times per cycle)
+    int count;
+    int free_idx;
+    int ready_idx;
 
 public:
-    RS();
+    explicit RS(bool in_order = false);
     void reset();
     
     void tick(bool flush, bool recover, const std::bitset<ROB_DEPTH>& live_tag,
               bool insert_valid, const RSEntry& insert_entry,
               const WBPkt& wb_alu, const WBPkt& wb_lsu, const WBPkt& wb_bru,
-              bool issue_ready);
+              const WBPkt& wb_mdu,
+              bool issue_ready, const std::bitset<N_PHYS_REGS>& prf_valid);
     
     // Outputs
-    bool getReady() const;
-    bool getIssueValid() const;
-    RSEntry getIssueEntry() const;
+    bool getReady() const { return free_idx >= 0; }
+    bool getIssueValid() const { return ready_idx >= 0; }
+    RSEntry getIssueEntry() const { return ready_idx >= 0 ? entries[ready_idx] : RSEntry{}; }
+    int getOccupancy() const { return count; }
+    
+    // Entries whose ROB tag is in tags (one SMT thread's)
+    int getOccupancy(const std::bitset<ROB_DEPTH>& tags) const;
     
 private:
-    int findFree() const;
-    int findReady() const;
+    void refresh();
     bool matchWB(const WBPkt& wb, preg_t preg) const;
 };
 
@@ -0,0 +1,93 @@
+#ifndef RV32I_H
+#define RV32I_H
+
+#include "types.h"
+#include <string>
+
+// RV32I(M) instruction encoders for the subset Decode supports, plus a
+// disassembler in the trace listing style ("lw x30 0 x8").
+namespace rv32 {
+
+constexpr uint32_t NOP = 0x00000013;  // addi x0, x0, 0
+
+// Opcodes
+constexpr uint32_t OP_LUI    = 0x37;
+constexpr uint32_t OP_JAL    = 0x6F;
+constexpr uint32_t OP_JALR   = 0x67;
+constexpr uint32_t OP_BRANCH = 0x63;
+constexpr uint32_t OP_LOAD   = 0x03;
+constexpr uint32_t OP_STORE  = 0x23;
+constexpr uint32_t OP_IMM    = 0x13;
+constexpr uint32_t OP_REG    = 0x33;
+
+// Branch funct3
+constexpr uint32_t F3_BEQ  = 0x0;
+constexpr uint32_t F3_BNE  = 0x1;
+constexpr uint32_t F3_BLT  = 0x4;
+constexpr uint32_t F3_BGE  = 0x5;
+constexpr uint32_t F3_BLTU = 0x6;
+constexpr uint32_t F3_BGEU = 0x7;
+
+// Formats
+inline uint32_t encR(uint32_t f7, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t rd) {
+    return (f7 << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | OP_REG;
+}
+
+inline uint32_t encI(uint32_t op, uint32_t rd, uint32_t f3, uint32_t rs1, int32_t imm) {
+    return ((static_cast<uint32_t>(imm) & 0xFFF) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | op;
+}
+
+inline uint32_t encS(uint32_t f3, uint32_t rs2, uint32_t rs1, int32_t imm) {
+    uint32_t u = static_cast<uint32_t>(imm);
+    return (((u >> 5) & 0x7F) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) |
+           ((u & 0x1F) << 7) | OP_STORE;
+}
+
+inline uint32_t encB(uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t off) {
+    uint32_t u = static_cast<uint32_t>(off);
+    return (((u >> 12) & 0x1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) |
+           (rs1 << 15) | (f3 << 12) | (((u >> 1) & 0xF) << 8) |
+           (((u >> 11) & 0x1) << 7) | OP_BRANCH;
+}
+
+inline uint32_t encJ(uint32_t rd, int32_t off) {
+    uint32_t u = static_cast<uint32_t>(off);
+    return (((u >> 20) & 0x1) << 31) | (((u >> 1) & 0x3FF) << 21) |
+           (((u >> 11) & 0x1) << 20) | (((u >> 12) & 0xFF) << 12) | (rd << 7) | OP_JAL;
+}
+
+// Instructions
+inline uint32_t lui(reg_t rd, uint32_t imm20) { return ((imm20 & 0xFFFFF) << 12) | (rd << 7) | OP_LUI; }
+inline uint32_t addi(reg_t rd, reg_t rs1, int32_t imm) { return encI(OP_IMM, rd, 0x0, rs1, imm); }
+inline uint32_t sltiu(reg_t rd, reg_t rs1, int32_t imm) { return encI(OP_IMM, rd, 0x3, rs1, imm); }
+inline uint32_t ori(reg_t rd, reg_t rs1, int32_t imm) { return encI(OP_IMM, rd, 0x6, rs1, imm); }
+inline uint32_t andi(reg_t rd, reg_t rs1, int32_t imm) { return encI(OP_IMM, rd, 0x7, rs1, imm); }
+inline uint32_t srli(reg_t rd, reg_t rs1, uint32_t sh) { return encI(OP_IMM, rd, 0x5, rs1, sh & 0x1F); }
+inline uint32_t srai(reg_t rd, reg_t rs1, uint32_t sh) { return encI(OP_IMM, rd, 0x5, rs1, 0x400 | (sh & 0x1F)); }
+inline uint32_t add(reg_t rd, reg_t rs1, reg_t rs2) { return encR(0x00, rs2, rs1, 0x0, rd); }
+inline uint32_t sub(reg_t rd, reg_t rs1, reg_t rs2) { return encR(0x20, rs2, rs1, 0x0, rd); }
+inline uint32_t and_(reg_t rd, reg_t rs1, reg_t rs2) { return encR(0x00, rs2, rs1, 0x7, rd); }
+inline uint32_t or_(reg_t rd, reg_t rs1, reg_t rs2) { return encR(0x00, rs2, rs1, 0x6, rd); }
+inline uint32_t sra(reg_t rd, reg_t rs1, reg_t rs2) { return encR(0x20, rs2, rs1, 0x5, rd); }
+inline uint32_t mul(reg_t rd, reg_t rs1, reg_t rs2) { return encR(0x01, rs2, rs1, 0x0, rd); }
+inline uint32_t mulh(reg_t rd, reg_t rs1, reg_t rs2) { return encR(0x01, rs2, rs1, 0x1, rd); }
+inline uint32_t mulhsu(reg_t rd, reg_t rs1, reg_t rs2) { return encR(0x01, rs2, rs1, 0x2, rd); }
+inline uint32_t mulhu(reg_t rd, reg_t rs1, reg_t rs2) { return encR(0x01, rs2, rs1, 0x3, rd); }
+inline uint32_t div(reg_t rd, reg_t rs1, reg_t rs2) { return encR(0x01, rs2, rs1, 0x4, rd); }
+inline uint32_t divu(reg_t rd, reg_t rs1, reg_t rs2) { return encR(0x01, rs2, rs1, 0x5, rd); }
+inline uint32_t rem(reg_t rd, reg_t rs1, reg_t rs2) { return encR(0x01, rs2, rs1, 0x6, rd); }
+inline uint32_t remu(reg_t rd, reg_t rs1, reg_t rs2) { return encR(0x01, rs2, rs1, 0x7, rd); }
+inline uint32_t lw(reg_t rd, reg_t rs1, int32_t imm) { return encI(OP_LOAD, rd, 0x2, rs1, imm); }
+inline uint32_t lbu(reg_t rd, reg_t rs1, int32_t imm) { return encI(OP_LOAD, rd, 0x4, rs1, imm); }
+inline uint32_t sw(reg_t rs2, reg_t rs1, int32_t imm) { return encS(0x2, rs2, rs1, imm); }
+inline uint32_t sh(reg_t rs2, reg_t rs1, int32_t imm) { return encS(0x1, rs2, rs1, imm); }
+inline uint32_t branch(uint32_t f3, reg_t rs1, reg_t rs2, int32_t off) { return encB(f3, rs1, rs2, off); }
+inline uint32_t jal(reg_t rd, int32_t off) { return encJ(rd, off); }
+inline uint32_t jalr(reg_t rd, reg_t rs1, int32_t imm) { return encI(OP_JALR, rd, 0x0, rs1, imm); }
+
+// Disassemble one word ("unknown 0x..." for anything Decode treats as NOP)
+std::string disasm(uint32_t instr);
+
+} // namespace rv32
+
+#endif // RV32I_H
@@ -0,0 +1,55 @@
+#ifndef SHARED_MEM_H
+#define SHARED_MEM_H
+
+#include "types.h"
+#include <unordered_map>
+#include <vector>
+
+// Data memory shared by several cores, one port per core.
+//
+// Stores are not visible to other ports right away: each port keeps them
+// in a pending log (and reads its own pending stores back through an
+// overlay) until publish() applies every log in (cycle, port) order.
+// Cores can therefore run in parallel between publish() calls, and the
+// final memory image does not depend on which host thread ran first.
+class SharedMem {
+public:
+    static constexpr int DEPTH_WORDS = 1024;   // same size/wrap as DMem
+
+private:
+    struct Store {
+        uint64_t cycle;
+        uint32_t idx;
+        uint32_t wdata;
+        LSSize size;
+        uint8_t off;
+    };
+    
+    struct Port {
+        std::vector<Store> pending;
+        std::unordered_map<uint32_t, uint32_t> overlay;   // word index -> merged word
+    };
+    
+    std::vector<uint32_t> mem;
+    std::vector<Port> ports;
+    std::vector<Store> merge_buf;
+
+public:
+    explicit SharedMem(int n_ports);
+    void reset();
+    
+    // Port access (word index already wrapped to DEPTH_WORDS)
+    uint32_t load(int port, uint32_t idx) const;
+    void store(int port, uint64_t cycle, uint32_t idx, uint32_t wdata,
+               LSSize size, uint8_t off);
+    
+    // Apply all pending stores; same-cycle stores land in port order
+    void publish();
+    
+    // Backdoor read of published memory, no timing (for tools)
+    uint32_t peek(uint32_t addr) const { return mem[(addr >> 2) & (DEPTH_WORDS - 1)]; }
+    
+    int getNumPorts() const { return static_cast<int>(ports.size()); }
+};
+
+#endif // SHARED_MEM_H
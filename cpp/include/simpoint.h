@@ -0,0 +1,104 @@
+#ifndef SIMPOINT_H
+#define SIMPOINT_H
+
+#include "types.h"
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// SimPoint-style sampling. A functional pass on the ISS cuts execution
+// into fixed-size instruction intervals and records a basic-block vector
+// (BBV) per interval; blocks end at the instructions Decode marks
+// is_branch/is_jump and are identified by their entry PC. The BBVs are
+// randomly projected to a few dimensions and clustered with k-means,
+// picking k by BIC. The interval nearest each centroid represents its
+// cluster, weighted by the cluster's share of instructions, and only
+// those intervals run on the detailed Core.
+struct SimPointConfig {
+    uint64_t interval = 1000;       // instructions per interval
+    uint64_t max_insts = 10000000;  // functional pass limit (stops earlier at the self-loop)
+    int max_k = 10;                 // clusters tried: 1..max_k
+    int dims = 15;                  // random projection dimensions
+    int kmeans_seeds = 5;           // k-means restarts per k (best SSE kept)
+    int kmeans_iters = 100;
+    double bic_threshold = 0.9;     // smallest k reaching this fraction of the BIC range
+    uint64_t warmup = 500;          // detailed instructions run before each interval
+    uint32_t seed = 1;
+};
+
+struct BBVInterval {
+    uint64_t start;                 // dynamic instruction index of the first instruction
+    uint64_t insts;                 // == interval except for the last one
+    std::vector<std::pair<uint32_t, uint32_t>> blocks;  // (block id, instructions)
+};
+
+struct SimPointPick {
+    size_t interval;                // representative interval
+    int cluster;
+    double weight;                  // cluster instructions / total instructions
+    uint64_t cycles;                // detailed run, filled by simulate()
+    double ipc;
+};
+
+class SimPoint {
+private:
+    SimPointConfig cfg;
+    std::vector<uint32_t> words;
+    
+    // Functional profile
+    std::vector<xlen_t> block_pcs;  // block id -> entry PC
+    std::vector<BBVInterval> intervals;
+    uint64_t total_insts;
+    bool halted;
+    
+    // Clustering
+    std::vector<std::vector<double>> points;    // projected, normalized BBVs
+    std::vector<double> bic;                    // per k, index k-1
+    std::vector<int> assignment;
+    std::vector<SimPointPick> picks;
+    
+    void project();
+    double kmeans(int k, std::mt19937& rng, std::vector<int>& assign,
+                  std::vector<std::vector<double>>& centers) const;
+    double scoreBIC(int k, const std::vector<int>& assign, double sse) const;
+    
+public:
+    explicit SimPoint(const SimPointConfig& config);
+    
+    bool loadProgram(const std::string& filename);
+    void loadProgramWords(const std::vector<uint32_t>& program);
+    
+    // Pass 1: ISS run to the self-loop (or max_insts), one BBV per interval
+    void profile();
+    
+    // Project, cluster and choose the representative intervals; returns k
+    int cluster();
+    
+    // Pass 2: checkpoint each pick on the ISS (warmup instructions early)
+    // and time the interval on Core
+    void simulate();
+    
+    // Whole-program IPC from the picks: total instructions over the
+    // weighted sum of per-cluster CPI
+    double estimateIPC() const;
+    
+    // Detailed IPC of the whole program (reference for the estimate)
+    double fullIPC(uint64_t* cycles = nullptr) const;
+    
+    // SimPoint file formats: .bb ("T:id:count ..." per interval, ids from 1),
+    // .simpoints ("interval cluster") and .weights ("weight cluster")
+    bool writeBBV(const std::string& filename) const;
+    bool writeSimPoints(const std::string& prefix) const;
+    
+    uint64_t getTotalInsts() const { return total_insts; }
+    bool isHalted() const { return halted; }
+    size_t getNumBlocks() const { return block_pcs.size(); }
+    const std::vector<BBVInterval>& getIntervals() const { return intervals; }
+    const std::vector<double>& getBIC() const { return bic; }
+    const std::vector<int>& getAssignment() const { return assignment; }
+    const std::vector<SimPointPick>& getPicks() const { return picks; }
+    uint64_t getDetailedInsts() const;
+};
+
+#endif // SIMPOINT_H
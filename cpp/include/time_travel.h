@@ -0,0 +1,69 @@
+#ifndef TIME_TRAVEL_H
+#define TIME_TRAVEL_H
+
+#include "core.h"
+#include <cstdint>
+#include <vector>
+
+// Time-travel debugging for a Core. run() and tick() snapshot the whole
+// core (BasicCore::saveState) every interval cycles. Once more than
+// max_snapshots are held, the one whose removal leaves the smallest gap
+// for its age goes. The survivors are dense near the newest snapshot and
+// spaced geometrically further back, so memory stays bounded over any
+// run length.
+//
+// gotoCycle() restores the newest snapshot at or before the target (or
+// just runs on, if that is nearer) and simulates forward from it. The
+// core is deterministic, so it arrives in the state the first run had.
+// Later snapshots stay valid and are reused when going forward again.
+// Observers, configuration changes and an attached SharedMem are outside
+// the snapshots: reconfigure only between restart()s.
+class TimeTravel {
+public:
+    static constexpr uint64_t DEFAULT_INTERVAL = 1000;
+    static constexpr int DEFAULT_MAX_SNAPSHOTS = 32;
+    static constexpr int MIN_SNAPSHOTS = 3;     // oldest, newest and one to thin
+    
+private:
+    Core& core;
+    uint64_t interval;
+    size_t max_snapshots;
+    std::vector<CoreState> snaps;               // ascending cycle
+    
+public:
+    // max_snapshots is raised to MIN_SNAPSHOTS; snapshots start at the
+    // core's current state
+    TimeTravel(Core& core, uint64_t interval = DEFAULT_INTERVAL,
+               int max_snapshots = DEFAULT_MAX_SNAPSHOTS);
+    
+    // Drop every snapshot and start again from the core's current state
+    // (after a reset, program load or reconfiguration)
+    void restart();
+    
+    // Simulate, snapshotting at each multiple of the interval
+    void tick();
+    void run(uint64_t cycles);
+    
+    // False, with the core untouched, if cycle is older than the oldest
+    // snapshot
+    bool gotoCycle(uint64_t cycle);
+    bool stepBack(uint64_t cycles);
+    
+    uint64_t getInterval() const { return interval; }
+    size_t getMaxSnapshots() const { return max_snapshots; }
+    size_t getSnapshotCount() const { return snaps.size(); }
+    uint64_t getSnapshotCycle(size_t i) const { return snaps[i].cycle_count; }
+    size_t getSnapshotBytes() const {
+        return snaps.empty() ? 0 : snaps.size() * snaps.front().bytes();
+    }
+    
+    // FNV-1a over the cycle and commit counts, architectural and physical
+    // registers and data memory: equal for equal runs
+    static uint64_t hashState(const Core& core);
+    
+private:
+    void take();
+    void thin();
+};
+
+#endif // TIME_TRAVEL_H
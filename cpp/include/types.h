@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <array>
 #include <bitset>
+#include <vector>
 
 // Global constants matching ooop_defs.vh
 constexpr int XLEN = 32;
@@ -12,6 +13,12 @@ constexpr int N_PHYS_REGS = 128;
 constexpr int ROB_DEPTH = 16;
 constexpr int RS_DEPTH = 8;
 
+// Branch checkpoint slots, at most (Core::setCkptSlots sizes the snapshot
+// storage at run time). Rename stalls a branch/jump while all are held.
+// The default pool equals ROB_DEPTH, which never stalls (same timing as
+// the RTL's per-tag checkpoints); fewer slots keep fewer snapshots.
+constexpr int N_CKPT = 16;
+
 // Derived widths
 constexpr int REG_W = 5;   // log2(32)
 constexpr int PREG_W = 7;  // log2(128)
@@ -23,13 +30,15 @@ using xlen_t = uint32_t;
 using reg_t = uint8_t;
 using preg_t = uint8_t;
 using rob_tag_t = uint8_t;
+using ckpt_t = uint8_t;
 
 // Enums matching ooop_types.sv
 enum class FUType : uint8_t {
     ALU = 0,
     BRU = 1,
     LSU = 2,
-    NONE = 3
+    MDU = 3,        // RV32M multiply/divide (no RTL counterpart yet)
+    NONE = 4
 };
 
 enum class ALUOp : uint8_t {
@@ -44,8 +53,29 @@ enum class ALUOp : uint8_t {
     SRL = 8,
     SRA = 9,
     SLTIU = 10,
-    LUI = 11
+    LUI = 11,
+    
+    // RV32M (FUType::MDU), in funct3 order
+    MUL = 12,
+    MULH = 13,
+    MULHSU = 14,
+    MULHU = 15,
+    DIV = 16,
+    DIVU = 17,
+    REM = 18,
+    REMU = 19
+};
+
+// Macro-op fusion rules (Decode::fuse): adjacent pairs that decode into a
+// single packet, one ROB entry and one issue slot
+enum class FuseRule : uint8_t {
+    NONE = 0,
+    LUI_ADDI = 1,       // lui rd, hi; addi rd, rd, lo: 32-bit constant
+    CONST_JALR = 2,     // lui/li t, C; jalr t|x0, off(t): absolute far jump
+    ALU_BRANCH = 3,     // ALU op into t; branch comparing t with x0
+    ADD_LOAD = 4        // add t, a, b; lw/lbu t, off(t): indexed load
 };
+constexpr int N_FUSE_RULES = 5;
 
 enum class LSSize : uint8_t {
     B = 0,  // Byte
@@ -54,10 +84,23 @@ enum class LSSize : uint8_t {
 };
 
 // Packet structures
+
+// Fetch-time prediction (BranchPred), carried with the instruction to the
+// BRU. The RAS state is the one after this instruction's own push/pop;
+// recovering from its misprediction restores it.
+struct FetchPred {
+    bool taken;             // fetch continued at target instead of pc + 4
+    xlen_t target;
+    uint8_t ras_tos;
+    uint8_t ras_count;
+    xlen_t ras_top;
+};
+
 struct FetchPkt {
     bool valid;
     xlen_t pc;
     uint32_t instr;
+    FetchPred pred;
 };
 
 struct DecodePkt {
@@ -87,6 +130,11 @@ struct DecodePkt {
     
     bool is_branch;
     bool is_jump;
+    FetchPred pred;
+    
+    FuseRule fuse;          // fused pair: pc/instr are the first half
+    uint32_t instr2;        // second instruction of the pair
+    xlen_t imm2;            // its immediate (branch/jalr offset)
 };
 
 struct RenamePkt {
@@ -113,6 +161,13 @@ struct RenamePkt {
     
     bool is_branch;
     bool is_jump;
+    FetchPred pred;
+    FuseRule fuse;
+    uint32_t instr2;
+    xlen_t imm2;
+    
+    bool rs1_used;
+    bool rs2_used;
     
     preg_t prs1;
     preg_t prs2;
@@ -123,6 +178,8 @@ struct RenamePkt {
     
     preg_t old_prd;
     rob_tag_t rob_tag;
+    ckpt_t ckpt_id;         // checkpoint slot (branches/jumps only)
+    bool eliminated;        // move/zero idiom done at rename: prd is shared, never issues
 };
 
 struct RSEntry {
@@ -146,6 +203,13 @@ struct RSEntry {
     
     bool is_branch;
     bool is_jump;
+    FetchPred pred;
+    FuseRule fuse;
+    uint32_t instr2;
+    xlen_t imm2;
+    
+    bool rs1_used;
+    bool rs2_used;
     
     preg_t prs1;
     preg_t prs2;
@@ -155,6 +219,7 @@ struct RSEntry {
     bool prs2_ready;
     
     rob_tag_t rob_tag;
+    ckpt_t ckpt_id;         // checkpoint slot (branches/jumps only)
 };
 
 struct WBPkt {
@@ -165,6 +230,49 @@ struct WBPkt {
     bool rd_used;
 };
 
+// Retiring instruction, as seen at the ROB head
+struct CommitPkt {
+    rob_tag_t rob_tag;
+    xlen_t pc;
+    reg_t rd;
+    bool rd_used;
+    preg_t prd;
+    preg_t old_prd;
+    xlen_t rd_value;
+    FuseRule fuse;          // a fused pair retires two instructions
+};
+
+// Control summary of one cycle (flight recorder), sampled before the
+// clock edge. valid is the stage's input latch, ready its downstream
+// accept, fire that it moved an instruction on. With several hardware
+// threads the per-thread fields are thread 0's.
+struct CycleRecord {
+    uint64_t cycle;
+    uint64_t commits;           // committed before this cycle
+    
+    xlen_t fetch_pc;
+    bool fetch_valid;
+    bool dec_valid, dec_ready;
+    bool ren_valid, ren_ready, ren_fire;
+    bool disp_valid, disp_ready, disp_fire;
+    
+    bool iss_alu, iss_bru, iss_lsu, iss_mdu;
+    rob_tag_t iss_tag;
+    
+    WBPkt wb_alu, wb_bru, wb_lsu, wb_mdu;
+    
+    rob_tag_t rob_head, rob_tail;
+    uint8_t rob_count;
+    bool commit;
+    uint32_t live_tag;          // bit t = ROB tag t in flight
+    
+    bool flush, recover, walking, mispredict;
+    xlen_t flush_pc;
+    rob_tag_t recover_tag;
+    xlen_t mp_target;
+    rob_tag_t mp_tag;
+};
+
 // Checkpoint structures
 struct RATSnapshot {
     std::array<preg_t, N_ARCH_REGS> rat;
@@ -172,6 +280,7 @@ struct RATSnapshot {
 
 struct FreelistSnapshot {
     std::bitset<N_PHYS_REGS> free_map;
+    std::array<uint8_t, N_PHYS_REGS> shares;
 };
 
 struct PRFValidSnapshot {
@@ -183,4 +292,12 @@ struct ROBPtrsSnapshot {
     uint8_t count;
 };
 
+// Architectural state at an instruction boundary: the ISS produces it,
+// BasicCore::loadArchState starts a detailed run from it
+struct ArchState {
+    xlen_t pc;
+    std::array<xlen_t, N_ARCH_REGS> regs;
+    std::vector<uint32_t> dmem;     // data memory, word 0 at address 0
+};
+
 #endif // OOOP_TYPES_H
@@ -0,0 +1,87 @@
+#ifndef WORKLOAD_GEN_H
+#define WORKLOAD_GEN_H
+
+#include "types.h"
+#include "iss.h"
+#include <random>
+#include <string>
+#include <vector>
+
+// Synthetic RV32I(M) program generator. Programs use only what Decode
+// supports, run straight through (all control flow is forward, so they
+// always terminate), and end in a self-loop like the trace programs.
+// The epilogue folds registers into a0 and stored memory into a1 so the
+// reference result checks both.
+struct GenConfig {
+    uint32_t seed = 1;
+    int length = 256;           // static instructions, epilogue included (<= 512)
+    int chain_len = 4;          // ALU/load ops per dependency chain before it restarts
+    int ilp = 2;                // independent chains interleaved
+    double branch_freq = 0.10;  // fraction of body slots that are branches/jumps
+    double taken_rate = 0.30;   // fraction of those that are taken
+    double mem_ratio = 0.25;    // fraction of body slots that are loads/stores
+    double store_ratio = 0.40;  // stores among memory ops
+    double alias_rate = 0.50;   // loads that reuse a recent store address
+    double muldiv_ratio = 0.0;  // RV32M among chained ALU ops (0: pure RV32I)
+    double move_ratio = 0.0;    // moves / zero idioms among chained ALU ops
+    double fuse_ratio = 0.0;    // fusible pairs (Decode::fuse) among ALU ops and control
+    int regs = 16;              // architectural registers used as destinations
+};
+
+struct GenProgram {
+    std::vector<uint32_t> words;
+    xlen_t a0;
+    xlen_t a1;
+    uint64_t dyn_insts;         // retired instructions up to the self-loop
+};
+
+class WorkloadGen {
+private:
+    GenConfig cfg;
+    std::mt19937 rng;
+    ISS iss;
+    
+    std::vector<uint32_t> words;
+    std::vector<bool> executed;
+    std::vector<reg_t> pool;
+    std::vector<uint64_t> last_write;   // per arch reg, body slot of last write
+    
+    struct Chain {
+        reg_t head;
+        int len;
+    };
+    std::vector<Chain> chains;
+    int next_chain;
+    
+    std::vector<uint32_t> store_addrs;  // most recent last
+
+public:
+    explicit WorkloadGen(const GenConfig& config);
+    
+    GenProgram generate();
+    
+    // Write the instMem byte file and an expected-results listing
+    static bool writeInstMem(const std::string& filename, const std::vector<uint32_t>& words);
+    static bool writeExpected(const std::string& filename, const GenProgram& prog,
+                              const std::string& title);
+    
+private:
+    // Append one instruction; executed ones also step the reference ISS
+    void emit(uint32_t instr, bool exec = true);
+    
+    void genAlu(bool exec);
+    void genMem(bool exec);
+    void genControl();
+    void genEpilogue();
+    
+    reg_t pickDest();
+    reg_t pickSrc();
+    uint32_t pickAddr(LSSize size);
+    void addrOperands(uint32_t addr, reg_t& base, int32_t& imm);
+    
+    bool chance(double p);
+    int uniform(int lo, int hi);
+    int epilogueSize() const;
+};
+
+#endif // WORKLOAD_GEN_H
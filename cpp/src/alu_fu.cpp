@@ -0,0 +1,62 @@
+#include "alu_fu.h"
+
+ALUFU::ALUFU() {
+    reset();
+}
+
+void ALUFU::reset() {
+    v_q = false;
+    e_q = {};
+    a_q = 0;
+    b_q = 0;
+}
+
+void ALUFU::tick(bool flush, bool issue_valid, const RSEntry& entry,
+                 xlen_t src1, xlen_t src2) {
+    if (flush) {
+        v_q = false;
+        return;
+    }
+    
+    v_q = issue_valid && entry.valid;
+    if (v_q) {
+        e_q = entry;
+        a_q = src1;
+        b_q = src2;
+    }
+}
+
+WBPkt ALUFU::getWB() const {
+    WBPkt wb = {};
+    if (!v_q) {
+        return wb;
+    }
+    
+    wb.valid = true;
+    wb.rob_tag = e_q.rob_tag;
+    wb.rd_used = e_q.rd_used;
+    wb.prd = e_q.rd_used ? e_q.prd : 0;
+    wb.data = execute(e_q, a_q, b_q);
+    return wb;
+}
+
+xlen_t ALUFU::execute(const RSEntry& entry, xlen_t a, xlen_t b) {
+    xlen_t op_b = entry.imm_used ? entry.imm : b;
+    uint32_t shamt = op_b & 0x1F;
+    
+    switch (entry.alu_op) {
+        case ALUOp::ADD:   return a + op_b;
+        case ALUOp::SUB:   return a - op_b;
+        case ALUOp::AND:   return a & op_b;
+        case ALUOp::OR:    return a | op_b;
+        case ALUOp::XOR:   return a ^ op_b;
+        case ALUOp::SLT:   return (static_cast<int32_t>(a) < static_cast<int32_t>(op_b)) ? 1 : 0;
+        case ALUOp::SLTU:  return (a < op_b) ? 1 : 0;
+        case ALUOp::SLL:   return a << shamt;
+        case ALUOp::SRL:   return a >> shamt;
+        case ALUOp::SRA:   return static_cast<xlen_t>(static_cast<int32_t>(a) >> shamt);
+        case ALUOp::SLTIU: return (a < op_b) ? 1 : 0;
+        case ALUOp::LUI:   return op_b;
+        default:           return 0;
+    }
+}
@@ -0,0 +1,892 @@
+#include "batch_core.h"
+
+namespace {
+
+constexpr uint32_t NOP = 0x00000013;
+constexpr uint8_t FETCH_IDLE = 0, FETCH_REQ = 1, FETCH_HAVE = 2;
+constexpr int RS_ALU = 0, RS_BRU = 1, RS_LSU = 2;
+
+// Per-lane select written as masks (m all ones or zero): GCC vectorizes
+// this where a ?: chain with several outputs stays a branch
+inline uint32_t blend(uint32_t m, uint32_t a, uint32_t b) {
+    return (a & m) | (b & ~m);
+}
+
+// Decode::decode for every lane, one array per field. The pipeline latches
+// only carry pc/instr and each stage re-derives what it needs from them.
+// Written as flag arithmetic (opcodes and funct3 values are exclusive) so
+// the loop vectorizes; flags are 0/1.
+template <int N>
+struct UopLanes {
+    std::array<xlen_t, N> imm;
+    std::array<reg_t, N> rd, rs1, rs2;
+    std::array<uint8_t, N> fu;              // RS_ALU / RS_BRU / RS_LSU
+    std::array<uint8_t, N> alu_op;          // ALUOp
+    std::array<uint8_t, N> size;            // LSSize
+    std::array<uint8_t, N> rd_used;         // already && rd != 0, like RenamePkt
+    std::array<uint8_t, N> rs1_used, rs2_used, imm_used;
+    std::array<uint8_t, N> is_load, is_store, uns, is_branch, is_jump;
+
+    void decode(const std::array<uint32_t, N>& instr) {
+        for (int l = 0; l < N; l++) {  // vectorized
+            uint32_t in = instr[l];
+            uint32_t opcode = in & 0x7F;
+            uint32_t funct3 = (in >> 12) & 0x7;
+            uint32_t f7_alt = ((in >> 25) & 0x7F) == 0x20;
+
+            uint32_t lui = opcode == 0x37, jal = opcode == 0x6F, opi = opcode == 0x13;
+            uint32_t opr = opcode == 0x33, ld = opcode == 0x03, st = opcode == 0x23;
+            uint32_t br = opcode == 0x63, jalr = opcode == 0x67;
+
+            uint32_t imm_i = static_cast<uint32_t>(static_cast<int32_t>(in) >> 20);
+            uint32_t imm_s = (imm_i & ~0x1Fu) | ((in >> 7) & 0x1F);
+            uint32_t imm_b = static_cast<uint32_t>(static_cast<int32_t>(in & 0x80000000) >> 19) |
+                             ((in << 4) & 0x800) | ((in >> 20) & 0x7E0) | ((in >> 7) & 0x1E);
+            uint32_t imm_u = in & 0xFFFFF000;
+            uint32_t imm_j = static_cast<uint32_t>(static_cast<int32_t>(in & 0x80000000) >> 11) |
+                             (in & 0xFF000) | ((in >> 9) & 0x800) | ((in >> 20) & 0x7FE);
+
+            uint32_t r = (in >> 7) & 0x1F;
+            rd[l] = r;
+            rs1[l] = (in >> 15) & 0x1F;
+            rs2[l] = (in >> 20) & 0x1F;
+            rd_used[l] = (lui | jal | opi | opr | ld | jalr) & (r != 0);
+            rs1_used[l] = opi | opr | ld | st | br | jalr;
+            rs2_used[l] = opr | st | br;
+            imm_used[l] = lui | jal | opi | ld | st | br | jalr;
+            imm[l] = (imm_u & -lui) | (imm_j & -jal) | (imm_s & -st) | (imm_b & -br) |
+                     (imm_i & -(opi | ld | jalr));
+            fu[l] = (jal | br | jalr) * RS_BRU + (ld | st) * RS_LSU;
+
+            // -(cond) is all ones when cond holds
+            auto op = [](uint32_t cond, ALUOp o) { return -cond & static_cast<uint32_t>(o); };
+            uint32_t sr = op(f7_alt, ALUOp::SRA) | op(!f7_alt, ALUOp::SRL);
+            uint32_t opi_op = op(funct3 == 0x6, ALUOp::OR) | op(funct3 == 0x7, ALUOp::AND) |
+                              op(funct3 == 0x3, ALUOp::SLTIU) | (-(funct3 == 0x5) & sr);
+            uint32_t opr_op = op(funct3 == 0x0 && f7_alt, ALUOp::SUB) |
+                              op(funct3 == 0x7, ALUOp::AND) | op(funct3 == 0x6, ALUOp::OR) |
+                              op(funct3 == 0x5, ALUOp::SRA);
+            alu_op[l] = op(lui, ALUOp::LUI) | (-opi & opi_op) | (-opr & opr_op);
+
+            uint32_t unsigned_byte = ld & (funct3 == 0x4);
+            uint32_t half = st & (funct3 == 0x1);
+            is_load[l] = ld;
+            is_store[l] = st;
+            uns[l] = unsigned_byte;
+            size[l] = static_cast<uint32_t>(LSSize::W) - 2 * unsigned_byte - half;
+            is_branch[l] = br;
+            is_jump[l] = jal | jalr;
+        }
+    }
+};
+
+// ALUFU::execute
+inline xlen_t aluExecute(ALUOp op, xlen_t a, xlen_t op_b) {
+    uint32_t shamt = op_b & 0x1F;
+    xlen_t r = a + op_b;
+    r = op == ALUOp::SUB ? a - op_b : r;
+    r = op == ALUOp::AND ? (a & op_b) : r;
+    r = op == ALUOp::OR ? (a | op_b) : r;
+    r = op == ALUOp::XOR ? (a ^ op_b) : r;
+    r = op == ALUOp::SLT ? xlen_t(static_cast<int32_t>(a) < static_cast<int32_t>(op_b)) : r;
+    r = (op == ALUOp::SLTU || op == ALUOp::SLTIU) ? xlen_t(a < op_b) : r;
+    r = op == ALUOp::SLL ? (a << shamt) : r;
+    r = op == ALUOp::SRL ? (a >> shamt) : r;
+    r = op == ALUOp::SRA ? static_cast<xlen_t>(static_cast<int32_t>(a) >> shamt) : r;
+    r = op == ALUOp::LUI ? op_b : r;
+    return r;
+}
+
+// BranchFU::computeTaken
+inline bool branchTaken(bool is_branch, bool is_jump, uint32_t instr, xlen_t a, xlen_t b) {
+    uint32_t funct3 = (instr >> 12) & 0x7;
+    bool lt = static_cast<int32_t>(a) < static_cast<int32_t>(b);
+    bool ltu = a < b;
+    bool cond = funct3 == 0x0 ? a == b : funct3 == 0x1 ? a != b :
+                funct3 == 0x4 ? lt : funct3 == 0x5 ? !lt :
+                funct3 == 0x6 ? ltu : funct3 == 0x7 ? !ltu : false;
+    return is_jump || (is_branch && cond);
+}
+
+// LSUFU::extractLoad
+inline uint32_t extractLoad(uint32_t rdata, LSSize size, bool uns, uint8_t off) {
+    uint32_t b = (rdata >> (off * 8)) & 0xFF;
+    uint32_t h = (rdata >> ((off & 0x2) * 8)) & 0xFFFF;
+    uint32_t sb = static_cast<uint32_t>(static_cast<int32_t>(b << 24) >> 24);
+    uint32_t sh = static_cast<uint32_t>(static_cast<int32_t>(h << 16) >> 16);
+    return size == LSSize::B ? (uns ? b : sb) : size == LSSize::H ? (uns ? h : sh) : rdata;
+}
+
+inline uint32_t writeMerge(uint32_t old_word, uint32_t new_word, LSSize size, uint8_t off) {
+    uint32_t bshift = off * 8;
+    uint32_t hshift = (off & 0x2) * 8;
+    uint32_t bword = (old_word & ~(0xFFu << bshift)) | ((new_word & 0xFF) << bshift);
+    uint32_t hword = (old_word & ~(0xFFFFu << hshift)) | ((new_word & 0xFFFF) << hshift);
+    return size == LSSize::B ? bword : size == LSSize::H ? hword : new_word;
+}
+
+// Lowest free preg >= 32 in a two-word map (FreeList::findFree), 0 if none
+inline preg_t findFreePreg(uint64_t lo, uint64_t hi) {
+    uint64_t lo_free = lo & ~0xFFFFFFFFull;
+    if (lo_free) return static_cast<preg_t>(__builtin_ctzll(lo_free));
+    if (hi) return static_cast<preg_t>(64 + __builtin_ctzll(hi));
+    return 0;
+}
+
+// Busy mask of a full checkpoint pool
+constexpr uint32_t CKPT_MASK = N_CKPT == 32 ? ~0u : (1u << N_CKPT) - 1;
+
+// ROBTagAlloc::findFreeTag: first tag at or after next_tag not in used
+inline rob_tag_t findFreeTag(rob_tag_t next, uint16_t used) {
+    uint32_t free = static_cast<uint16_t>(~used);
+    if (!free) return next;
+    uint32_t rot = ((free >> next) | (free << (ROB_DEPTH - next))) & 0xFFFF;
+    return static_cast<rob_tag_t>((next + __builtin_ctz(rot)) & (ROB_DEPTH - 1));
+}
+
+} // namespace
+
+template <int LANES>
+BatchCore<LANES>::BatchCore() {
+    for (auto& row : imem) row.fill(NOP);
+    rs[RS_ALU].in_order = false;
+    rs[RS_BRU].in_order = true;
+    rs[RS_LSU].in_order = true;
+    reset();
+}
+
+template <int LANES>
+void BatchCore<LANES>::loadProgramWords(int lane, const std::vector<uint32_t>& words) {
+    for (int i = 0; i < IMEM_WORDS; i++) {
+        imem[i][lane] = i < static_cast<int>(words.size()) ? words[i] : NOP;
+    }
+}
+
+template <int LANES>
+void BatchCore<LANES>::reset() {
+    for (auto& row : dmem) row.fill(0);
+    dm_v1.fill(false);
+    dm_v2.fill(false);
+    dm_rdata1.fill(0);
+    dm_rdata2.fill(0);
+
+    fetch_state.fill(FETCH_IDLE);
+    fetch_pc.fill(0);
+    fetch_instr.fill(NOP);
+    f2d_valid.fill(false);
+    d2r_valid.fill(false);
+    f2d_pc.fill(0);
+    d2r_pc.fill(0);
+    f2d_instr.fill(0);
+    d2r_instr.fill(0);
+    r2d = {};
+    disp = {};
+
+    for (int r = 0; r < N_ARCH_REGS; r++) {
+        rat[r].fill(r);
+        arch_rat[r].fill(r);
+        for (auto& ck : ckpt_rat) ck[r].fill(r);
+    }
+    free_map[0].fill(~0xFFFFFFFFull);
+    free_map[1].fill(~0ull);
+    for (auto& ck : ckpt_free_map) ck = free_map;
+    next_tag.fill(0);
+    tag_reserved.fill(0);
+    for (auto& row : ckpt_next_tag) row.fill(0);
+    ckpt_busy.fill(0);
+    for (auto& row : ckpt_owner) row.fill(0);
+
+    for (auto& row : prf) row.fill(0);
+    prf_valid[0].fill(~0ull);
+    prf_valid[1].fill(~0ull);
+
+    for (int i = 0; i < ROB_DEPTH; i++) {
+        rob_valid[i].fill(false);
+        rob_done[i].fill(false);
+        rob_rd_used[i].fill(false);
+        rob_tag[i].fill(0);
+        rob_pc[i].fill(0);
+        rob_rd[i].fill(0);
+        rob_prd[i].fill(0);
+        rob_old_prd[i].fill(0);
+    }
+    for (auto& row : rob_ckpt_tail) row.fill(0);
+    rob_head.fill(0);
+    rob_tail.fill(0);
+    rob_count.fill(0);
+
+    for (auto& q : rs) {
+        bool in_order = q.in_order;
+        q = {};
+        q.in_order = in_order;
+    }
+
+    alu_wb = {};
+    bru_wb = {};
+    bru_mp.fill(false);
+    bru_tgt.fill(0);
+    bru_rtag.fill(0);
+    bru_ckpt.fill(0);
+
+    lsu_m0 = {};
+    lsu_m1 = {};
+    lsu_block.fill(0);
+
+    rc_mp.fill(false);
+    rc_flush.fill(false);
+    rc_recover.fill(false);
+    rc_flush_pc.fill(0);
+    rc_recover_tag.fill(0);
+    rc_recover_ckpt.fill(0);
+
+    cycle_count = 0;
+    commit_count.fill(0);
+    recover_count.fill(0);
+    last_commit_pc.fill(0);
+    same_pc_commits.fill(0);
+}
+
+template <int LANES>
+void BatchCore<LANES>::tick() {
+    // Same two phases as Core::tick. Each step is a loop over lanes; the
+    // wires between them are per-lane arrays.
+
+    // ------------------------------------------------------------------
+    // Phase A: evaluate combinational outputs from registered state
+    // ------------------------------------------------------------------
+
+    // Recovery
+    const Lanes<bool> flush = rc_flush;
+    const Lanes<xlen_t> flush_pc = rc_flush_pc;
+    const Lanes<bool> recover = rc_recover;
+    const Lanes<rob_tag_t> recover_tag = rc_recover_tag;
+    const Lanes<ckpt_t> recover_ckpt = rc_recover_ckpt;
+
+    // LSU writeback (ALU and BRU writebacks are registered as-is)
+    WBSoA lsu_wb;
+    for (int l = 0; l < LANES; l++) {
+        bool v = lsu_m1.v[l] && dm_v2[l];
+        bool rd_used = lsu_m1.is_load[l] && lsu_m1.rd_used[l];
+        lsu_wb.valid[l] = v;
+        lsu_wb.rob_tag[l] = v ? lsu_m1.rob_tag[l] : 0;
+        lsu_wb.rd_used[l] = v && rd_used;
+        lsu_wb.prd[l] = v && rd_used ? lsu_m1.prd[l] : 0;
+        lsu_wb.data[l] = v && lsu_m1.is_load[l] ?
+            extractLoad(dm_rdata2[l], static_cast<LSSize>(lsu_m1.size[l]),
+                        lsu_m1.uns[l], lsu_m1.off[l]) : 0;
+    }
+
+    // Match keys of the three writebacks: ROB tag of a valid writeback and
+    // preg of one that writes a register, NO_MATCH otherwise
+    constexpr uint8_t NO_MATCH = 0xFF;
+    std::array<Lanes<uint8_t>, 3> wb_tag_key, wb_preg_key;
+    for (int l = 0; l < LANES; l++) {
+        const WBSoA* wbs[3] = {&alu_wb, &lsu_wb, &bru_wb};
+        for (int w = 0; w < 3; w++) {
+            const WBSoA& wb = *wbs[w];
+            bool writes = wb.valid[l] && wb.rd_used[l] && wb.prd[l] != 0;
+            wb_tag_key[w][l] = wb.valid[l] ? wb.rob_tag[l] : NO_MATCH;
+            wb_preg_key[w][l] = writes ? wb.prd[l] : NO_MATCH;
+        }
+    }
+
+    // Commit and live tags
+    Lanes<bool> commit;
+    Lanes<uint16_t> live_tag = {}, rs_live;
+    for (int i = 0; i < ROB_DEPTH; i++) {
+        for (int l = 0; l < LANES; l++) {
+            live_tag[l] |= rob_valid[i][l] ? uint16_t(1u << rob_tag[i][l]) : 0;
+        }
+    }
+    for (int l = 0; l < LANES; l++) {
+        int h = rob_head[l];
+        uint16_t live = live_tag[l];
+        commit[l] = rob_count[l] > 0 && rob_valid[h][l] && rob_done[h][l];
+
+        // ROB::getRecoverLiveTag: head up to the branch's checkpoint tail
+        uint16_t rlive = 0;
+        if (recover[l]) {
+            int ckpt_tail = rob_ckpt_tail[recover_ckpt[l]][l];
+            int idx = h;
+            for (int k = 0; k < rob_count[l]; k++) {
+                if (rob_valid[idx][l]) rlive |= uint16_t(1u << rob_tag[idx][l]);
+                idx = (idx + 1) & (ROB_DEPTH - 1);
+                if (idx == ckpt_tail) break;
+            }
+        }
+        rs_live[l] = recover[l] ? rlive : live;
+    }
+
+    // RS select: free slot, oldest ready, oldest overall
+    std::array<Lanes<int8_t>, 3> rs_free, rs_pick;
+    for (int q = 0; q < 3; q++) {
+        const RSSoA& s = rs[q];
+        // Ages start at UINT32_MAX so "none yet" needs no separate test
+        Lanes<uint32_t> free_idx, best, oldest;
+        Lanes<uint32_t> best_age, oldest_age;
+        free_idx.fill(~0u);
+        best.fill(~0u);
+        oldest.fill(~0u);
+        best_age.fill(UINT32_MAX);
+        oldest_age.fill(UINT32_MAX);
+        for (int i = RS_DEPTH - 1; i >= 0; i--) {
+            for (int l = 0; l < LANES; l++) {  // vectorized
+                uint32_t occ = s.occupied[i][l];
+                uint32_t rdy = occ & s.prs1_ready[i][l] & s.prs2_ready[i][l];
+                uint32_t a = s.age[i][l];
+                uint32_t m_free = occ - 1;
+                uint32_t m_older = -(occ & (a <= oldest_age[l]));
+                uint32_t m_better = -(rdy & (a <= best_age[l]));
+                free_idx[l] = blend(m_free, i, free_idx[l]);
+                oldest[l] = blend(m_older, i, oldest[l]);
+                oldest_age[l] = blend(m_older, a, oldest_age[l]);
+                best[l] = blend(m_better, i, best[l]);
+                best_age[l] = blend(m_better, a, best_age[l]);
+            }
+        }
+        for (int l = 0; l < LANES; l++) {
+            int8_t o = static_cast<int8_t>(oldest[l]), b = static_cast<int8_t>(best[l]);
+            rs_free[q][l] = static_cast<int8_t>(free_idx[l]);
+            rs_pick[q][l] = s.in_order ? ((o >= 0 && o == b) ? o : -1) : b;
+        }
+    }
+
+    // Issue: ALU > BRU > LSU; stores wait for the ROB head
+    Lanes<int8_t> iss_q, iss_i;
+    Lanes<xlen_t> iss_pc, src1, src2;
+    Lanes<uint32_t> iss_instr;
+    Lanes<preg_t> iss_prd;
+    Lanes<rob_tag_t> iss_tag;
+    Lanes<ckpt_t> iss_ckpt;
+    for (int l = 0; l < LANES; l++) {
+        int lsu_idx = rs_pick[RS_LSU][l];
+        bool lsu_v = lsu_idx >= 0;
+        if (lsu_v && (rs[RS_LSU].instr[lsu_idx][l] & 0x7F) == 0x23) {
+            lsu_v = rob_count[l] > 0 &&
+                    rob_tag[rob_head[l]][l] == rs[RS_LSU].rob_tag[lsu_idx][l];
+        }
+        lsu_v = lsu_v && lsu_block[l] == 0;
+
+        int q = rs_pick[RS_ALU][l] >= 0 ? RS_ALU :
+                rs_pick[RS_BRU][l] >= 0 ? RS_BRU : lsu_v ? RS_LSU : -1;
+        q = flush[l] ? -1 : q;
+        iss_q[l] = q;
+        iss_i[l] = q >= 0 ? rs_pick[q][l] : -1;
+
+        const RSSoA& s = rs[q >= 0 ? q : 0];
+        int i = q >= 0 ? iss_i[l] : 0;
+        iss_pc[l] = s.pc[i][l];
+        iss_instr[l] = s.instr[i][l];
+        iss_prd[l] = s.prd[i][l];
+        iss_tag[l] = s.rob_tag[i][l];
+        iss_ckpt[l] = s.ckpt[i][l];
+        src1[l] = prf[q >= 0 ? s.prs1[i][l] : 0][l];
+        src2[l] = prf[q >= 0 ? s.prs2[i][l] : 0][l];
+    }
+    UopLanes<LANES> iss_u;
+    iss_u.decode(iss_instr);
+
+    // Dispatch
+    UopLanes<LANES> disp_u;
+    disp_u.decode(disp.instr);
+    Lanes<bool> disp_fire, disp_ready;
+    for (int l = 0; l < LANES; l++) {
+        bool rs_ok = rs_free[disp_u.fu[l]][l] >= 0;
+        bool fire = disp.valid[l] && rob_count[l] < ROB_DEPTH && !flush[l] && rs_ok;
+        disp_fire[l] = fire;
+        disp_ready[l] = !disp.valid[l] || fire;
+    }
+
+    // Rename
+    Lanes<bool> rename_fire, alloc_req, ckpt_take;
+    Lanes<rob_tag_t> new_tag;
+    Lanes<ckpt_t> new_ckpt;
+    Lanes<preg_t> new_prd;
+    UopLanes<LANES> d2r_u;
+    d2r_u.decode(d2r_instr);
+    for (int l = 0; l < LANES; l++) {
+        bool r2d_accept = !r2d.valid[l] || disp_ready[l];
+        preg_t prd = findFreePreg(free_map[0][l], free_map[1][l]);
+        bool has_free = prd != 0;
+        uint16_t used = live_tag[l] | tag_reserved[l];
+        bool tag_ok = used != 0xFFFF;
+        new_tag[l] = findFreeTag(next_tag[l], used);
+        new_prd[l] = prd;
+        uint32_t ckpt_free = ~ckpt_busy[l] & CKPT_MASK;
+        bool ckpt_ok = ckpt_free != 0;
+        new_ckpt[l] = ckpt_ok ? static_cast<ckpt_t>(__builtin_ctz(ckpt_free)) : 0;
+
+        bool need_ckpt = d2r_u.is_branch[l] || d2r_u.is_jump[l];
+        bool fire = !flush[l] && d2r_valid[l] && (!d2r_u.rd_used[l] || has_free) &&
+                    tag_ok && (!need_ckpt || ckpt_ok) && r2d_accept;
+        rename_fire[l] = fire;
+        alloc_req[l] = fire && d2r_u.rd_used[l];
+        ckpt_take[l] = fire && need_ckpt;
+    }
+
+    // Decode / fetch handshakes
+    Lanes<bool> decode_fire, f2d_accept;
+    for (int l = 0; l < LANES; l++) {
+        bool d2r_accept = !d2r_valid[l] || rename_fire[l];
+        decode_fire[l] = f2d_valid[l] && d2r_accept;
+        f2d_accept[l] = !f2d_valid[l] || decode_fire[l];
+    }
+
+    // ------------------------------------------------------------------
+    // Phase B: clock edge
+    // ------------------------------------------------------------------
+
+    // Commit side effects
+    Lanes<bool> free_req;
+    Lanes<preg_t> free_preg;
+    for (int l = 0; l < LANES; l++) {
+        int h = rob_head[l];
+        free_req[l] = commit[l] && rob_rd_used[h][l];
+        free_preg[l] = rob_old_prd[h][l];
+        if (commit[l]) {
+            if (rob_rd_used[h][l] && rob_rd[h][l] != 0) {
+                arch_rat[rob_rd[h][l]][l] = rob_prd[h][l];
+            }
+            xlen_t pc = rob_pc[h][l];
+            same_pc_commits[l] = (commit_count[l] > 0 && pc == last_commit_pc[l]) ?
+                                 same_pc_commits[l] + 1 : 0;
+            last_commit_pc[l] = pc;
+            commit_count[l]++;
+        }
+        recover_count[l] += recover[l];
+    }
+
+    // Writebacks seen by this edge (copies: the FU registers update below)
+    const WBSoA wb_alu = alu_wb;
+    const WBSoA wb_bru = bru_wb;
+
+    // Recovery controller: rising edge of the BRU mispredict. A branch
+    // written back without a mispredict frees its checkpoint slot.
+    Lanes<bool> resolve;
+    Lanes<ckpt_t> resolve_ckpt;
+    for (int l = 0; l < LANES; l++) {
+        resolve[l] = bru_wb.valid[l] && !bru_mp[l];
+        resolve_ckpt[l] = bru_ckpt[l];
+        bool fire = bru_mp[l] && !rc_mp[l];
+        rc_mp[l] = bru_mp[l];
+        rc_flush[l] = fire;
+        rc_recover[l] = fire;
+        rc_flush_pc[l] = fire ? bru_tgt[l] : rc_flush_pc[l];
+        rc_recover_tag[l] = fire ? bru_rtag[l] : rc_recover_tag[l];
+        rc_recover_ckpt[l] = fire ? bru_ckpt[l] : rc_recover_ckpt[l];
+    }
+
+    // Execute: ALU result is computed at issue (execute is a pure function)
+    for (int l = 0; l < LANES; l++) {
+        int q = iss_q[l];
+        preg_t prd = iss_u.rd_used[l] ? iss_prd[l] : 0;
+        xlen_t op_b = iss_u.imm_used[l] ? iss_u.imm[l] : src2[l];
+
+        bool alu = q == RS_ALU;
+        alu_wb.valid[l] = alu;
+        alu_wb.rob_tag[l] = iss_tag[l];
+        alu_wb.rd_used[l] = iss_u.rd_used[l];
+        alu_wb.prd[l] = prd;
+        alu_wb.data[l] = aluExecute(static_cast<ALUOp>(iss_u.alu_op[l]), src1[l], op_b);
+
+        bool bru = q == RS_BRU;
+        bool taken = bru && branchTaken(iss_u.is_branch[l], iss_u.is_jump[l],
+                                        iss_instr[l], src1[l], src2[l]);
+        xlen_t tgt = (iss_instr[l] & 0x7F) == 0x67 ? (src1[l] + iss_u.imm[l]) & 0xFFFFFFFE
+                                                   : iss_pc[l] + iss_u.imm[l];
+        bru_wb.valid[l] = bru;
+        bru_wb.rob_tag[l] = bru ? iss_tag[l] : 0;
+        bru_wb.rd_used[l] = bru && iss_u.rd_used[l];
+        bru_wb.prd[l] = bru ? prd : 0;
+        bru_wb.data[l] = (bru && iss_u.is_jump[l] && iss_u.rd_used[l]) ? iss_pc[l] + 4 : 0;
+        bru_mp[l] = taken;
+        bru_tgt[l] = taken ? tgt : 0;
+        bru_rtag[l] = taken ? iss_tag[l] : 0;
+        bru_ckpt[l] = bru ? iss_ckpt[l] : 0;
+    }
+
+    // DMem and LSU
+    for (int l = 0; l < LANES; l++) {
+        bool en = iss_q[l] == RS_LSU;
+        uint32_t addr = src1[l] + iss_u.imm[l];
+
+        dm_v2[l] = dm_v1[l];
+        dm_rdata2[l] = dm_rdata1[l];
+        dm_v1[l] = en;
+        if (en) {
+            uint32_t idx = (addr >> 2) & (DMEM_WORDS - 1);
+            dm_rdata1[l] = dmem[idx][l];
+            if (iss_u.is_store[l]) {
+                dmem[idx][l] = writeMerge(dmem[idx][l], src2[l], static_cast<LSSize>(iss_u.size[l]), addr & 0x3);
+            }
+        }
+
+        if (flush[l]) {
+            lsu_block[l] = 2;
+            bool keep = lsu_m0.v[l] && ((rs_live[l] >> lsu_m0.rob_tag[l]) & 1);
+            lsu_m1.v[l] = keep;
+            lsu_m1.is_load[l] = keep && lsu_m0.is_load[l];
+            lsu_m1.rd_used[l] = keep && lsu_m0.rd_used[l];
+            lsu_m1.uns[l] = keep && lsu_m0.uns[l];
+            lsu_m1.rob_tag[l] = keep ? lsu_m0.rob_tag[l] : 0;
+            lsu_m1.prd[l] = keep ? lsu_m0.prd[l] : 0;
+            lsu_m1.size[l] = keep ? lsu_m0.size[l] : 0;
+            lsu_m1.off[l] = keep ? lsu_m0.off[l] : 0;
+            en = false;
+        } else {
+            lsu_block[l] -= lsu_block[l] != 0;
+            lsu_m1.v[l] = lsu_m0.v[l];
+            lsu_m1.is_load[l] = lsu_m0.is_load[l];
+            lsu_m1.rd_used[l] = lsu_m0.rd_used[l];
+            lsu_m1.uns[l] = lsu_m0.uns[l];
+            lsu_m1.rob_tag[l] = lsu_m0.rob_tag[l];
+            lsu_m1.prd[l] = lsu_m0.prd[l];
+            lsu_m1.size[l] = lsu_m0.size[l];
+            lsu_m1.off[l] = lsu_m0.off[l];
+        }
+        lsu_m0.v[l] = en;
+        lsu_m0.is_load[l] = en && iss_u.is_load[l];
+        lsu_m0.rd_used[l] = en && iss_u.rd_used[l];
+        lsu_m0.uns[l] = en && iss_u.uns[l];
+        lsu_m0.rob_tag[l] = en ? iss_tag[l] : 0;
+        lsu_m0.prd[l] = en ? iss_prd[l] : 0;
+        lsu_m0.size[l] = en ? iss_u.size[l] : 0;
+        lsu_m0.off[l] = en ? (addr & 0x3) : 0;
+    }
+
+    // PRF (valid bits sampled before this edge for RS insert)
+    const Table<uint64_t, 2> prf_valid_q = prf_valid;
+    for (int l = 0; l < LANES; l++) {
+        const WBSoA* wbs[3] = {&wb_alu, &lsu_wb, &wb_bru};
+        uint64_t set[2] = {1, 0};
+        for (const WBSoA* wb : wbs) {
+            preg_t p = wb->prd[l];
+            if (wb->valid[l] && wb->rd_used[l] && p != 0) {
+                prf[p][l] = wb->data[l];
+                set[p >> 6] |= 1ull << (p & 63);
+            }
+        }
+        uint64_t clr[2] = {0, 0};
+        if (!flush[l] && !recover[l] && alloc_req[l] && new_prd[l] != 0) {
+            clr[new_prd[l] >> 6] = 1ull << (new_prd[l] & 63);
+        }
+        prf_valid[0][l] = (prf_valid[0][l] & ~clr[0]) | set[0];
+        prf_valid[1][l] = (prf_valid[1][l] & ~clr[1]) | set[1];
+        prf[0][l] = 0;
+    }
+
+    // ROB: writeback marks done (the committing head is already done)
+    for (int i = 0; i < ROB_DEPTH; i++) {
+        for (int l = 0; l < LANES; l++) {  // vectorized
+            rob_tag_t t = rob_tag[i][l];
+            uint8_t hit = uint8_t(t == wb_tag_key[0][l]) | uint8_t(t == wb_tag_key[1][l]) |
+                          uint8_t(t == wb_tag_key[2][l]);
+            rob_done[i][l] |= rob_valid[i][l] & hit;
+        }
+    }
+    for (int l = 0; l < LANES; l++) {
+        int head = rob_head[l];
+        int head_next = head;
+        if (commit[l]) {
+            rob_valid[head][l] = false;
+            head_next = (head + 1) & (ROB_DEPTH - 1);
+        }
+
+        if (recover[l]) {
+            int ckpt_tail = rob_ckpt_tail[recover_ckpt[l]][l];
+            int br_idx = (ckpt_tail - 1) & (ROB_DEPTH - 1);
+            bool br_live = rob_valid[br_idx][l] && rob_tag[br_idx][l] == recover_tag[l];
+            for (int idx = ckpt_tail; idx != rob_tail[l]; idx = (idx + 1) & (ROB_DEPTH - 1)) {
+                rob_valid[idx][l] = false;
+            }
+            int n = (ckpt_tail - head_next) & (ROB_DEPTH - 1);
+            if (n == 0 && br_live) n = ROB_DEPTH;
+            rob_head[l] = head_next;
+            rob_tail[l] = ckpt_tail;
+            rob_count[l] = n;
+            continue;
+        }
+
+        rob_head[l] = head_next;
+        rob_count[l] -= commit[l];
+        if (flush[l]) continue;
+
+        if (disp_fire[l] && rob_count[l] < ROB_DEPTH) {
+            int t = rob_tail[l];
+            rob_valid[t][l] = true;
+            rob_done[t][l] = false;
+            rob_tag[t][l] = disp.rob_tag[l];
+            rob_pc[t][l] = disp.pc[l];
+            rob_rd[t][l] = disp_u.rd[l];
+            rob_rd_used[t][l] = disp_u.rd_used[l];
+            rob_prd[t][l] = disp.prd[l];
+            rob_old_prd[t][l] = disp.old_prd[l];
+            rob_tail[l] = (t + 1) & (ROB_DEPTH - 1);
+            rob_count[l]++;
+        }
+        if (disp_fire[l] && (disp_u.is_branch[l] || disp_u.is_jump[l])) {
+            rob_ckpt_tail[disp.ckpt[l]][l] = rob_tail[l];
+        }
+    }
+
+    // Reservation stations
+    for (int q = 0; q < 3; q++) {
+        RSSoA& s = rs[q];
+
+        // Issue
+        for (int l = 0; l < LANES; l++) {
+            if (iss_q[l] == q) s.occupied[iss_i[l]][l] = false;
+        }
+
+        // Wakeup
+        for (int i = 0; i < RS_DEPTH; i++) {
+            for (int l = 0; l < LANES; l++) {  // vectorized
+                preg_t p1 = s.prs1[i][l], p2 = s.prs2[i][l];
+                uint8_t w1 = uint8_t(p1 == wb_preg_key[0][l]) | uint8_t(p1 == wb_preg_key[1][l]) |
+                             uint8_t(p1 == wb_preg_key[2][l]);
+                uint8_t w2 = uint8_t(p2 == wb_preg_key[0][l]) | uint8_t(p2 == wb_preg_key[1][l]) |
+                             uint8_t(p2 == wb_preg_key[2][l]);
+                s.prs1_ready[i][l] |= s.occupied[i][l] & w1;
+                s.prs2_ready[i][l] |= s.occupied[i][l] & w2;
+            }
+        }
+
+        // Squash / flush / insert
+        for (int l = 0; l < LANES; l++) {
+            if (recover[l]) {
+                for (int i = 0; i < RS_DEPTH; i++) {
+                    bool live = (rs_live[l] >> s.rob_tag[i][l]) & 1;
+                    s.occupied[i][l] = s.occupied[i][l] && live;
+                }
+                continue;
+            }
+            if (flush[l]) {
+                for (int i = 0; i < RS_DEPTH; i++) s.occupied[i][l] = false;
+                continue;
+            }
+            if (!(disp_fire[l] && disp_u.fu[l] == q)) continue;
+            int slot = -1;
+            for (int i = RS_DEPTH - 1; i >= 0; i--) {
+                slot = s.occupied[i][l] ? slot : i;
+            }
+            if (slot < 0) continue;
+
+            // Readiness recomputed as in RS::tick
+            auto now_ready = [&](bool used, preg_t p) {
+                bool v = (prf_valid_q[p >> 6][l] >> (p & 63)) & 1;
+                return !used || p == 0 || v || p == wb_preg_key[0][l] ||
+                       p == wb_preg_key[1][l] || p == wb_preg_key[2][l];
+            };
+            s.occupied[slot][l] = true;
+            s.pc[slot][l] = disp.pc[l];
+            s.instr[slot][l] = disp.instr[l];
+            s.prs1[slot][l] = disp.prs1[l];
+            s.prs2[slot][l] = disp.prs2[l];
+            s.prd[slot][l] = disp.prd[l];
+            s.prs1_ready[slot][l] = disp.prs1_ready[l] || now_ready(disp_u.rs1_used[l], disp.prs1[l]);
+            s.prs2_ready[slot][l] = disp.prs2_ready[l] || now_ready(disp_u.rs2_used[l], disp.prs2[l]);
+            s.rob_tag[slot][l] = disp.rob_tag[l];
+            s.ckpt[slot][l] = disp.ckpt[l];
+            s.age[slot][l] = s.age_ctr[l]++;
+        }
+    }
+
+    // Dispatch FIFO (push, push+pop, or pop)
+    for (int l = 0; l < LANES; l++) {
+        if (flush[l]) {
+            disp.valid[l] = false;
+            continue;
+        }
+        bool push = r2d.valid[l] && disp_ready[l];
+        if (push) {
+            disp.valid[l] = true;
+            disp.pc[l] = r2d.pc[l];
+            disp.instr[l] = r2d.instr[l];
+            disp.prs1[l] = r2d.prs1[l];
+            disp.prs2[l] = r2d.prs2[l];
+            disp.prd[l] = r2d.prd[l];
+            disp.old_prd[l] = r2d.old_prd[l];
+            disp.prs1_ready[l] = r2d.prs1_ready[l];
+            disp.prs2_ready[l] = r2d.prs2_ready[l];
+            disp.rob_tag[l] = r2d.rob_tag[l];
+            disp.ckpt[l] = r2d.ckpt[l];
+        } else if (disp_fire[l]) {
+            disp.valid[l] = false;
+        }
+    }
+
+    // Rename source lookup for the r2d latch (before the RAT update)
+    RenamedSoA rpkt;
+    for (int l = 0; l < LANES; l++) {
+        preg_t p1 = rat[d2r_u.rs1[l]][l], p2 = rat[d2r_u.rs2[l]][l];
+        bool v1 = (prf_valid_q[p1 >> 6][l] >> (p1 & 63)) & 1;
+        bool v2 = (prf_valid_q[p2 >> 6][l] >> (p2 & 63)) & 1;
+        rpkt.pc[l] = d2r_pc[l];
+        rpkt.instr[l] = d2r_instr[l];
+        rpkt.prs1[l] = p1;
+        rpkt.prs2[l] = p2;
+        rpkt.prs1_ready[l] = !d2r_u.rs1_used[l] || p1 == 0 || v1;
+        rpkt.prs2_ready[l] = !d2r_u.rs2_used[l] || p2 == 0 || v2;
+        rpkt.prd[l] = d2r_u.rd_used[l] ? new_prd[l] : 0;
+        rpkt.old_prd[l] = d2r_u.rd_used[l] ? rat[d2r_u.rd[l]][l] : 0;
+        rpkt.rob_tag[l] = new_tag[l];
+        rpkt.ckpt[l] = (d2r_u.is_branch[l] || d2r_u.is_jump[l]) ? new_ckpt[l] : 0;
+    }
+
+    // A committed free also goes into every checkpoint
+    Table<uint64_t, 2> freed;
+    for (int l = 0; l < LANES; l++) {
+        bool f = free_req[l] && free_preg[l] != 0;
+        uint64_t bit = 1ull << (free_preg[l] & 63);
+        freed[0][l] = f && free_preg[l] < 64 ? bit : 0;
+        freed[1][l] = f && free_preg[l] >= 64 ? bit : 0;
+    }
+    for (auto& ck : ckpt_free_map) {
+        for (int w = 0; w < 2; w++) {
+            for (int l = 0; l < LANES; l++) ck[w][l] |= freed[w][l];  // vectorized
+        }
+    }
+
+    // Map table, free list, tag allocator, checkpoint pool
+    for (int l = 0; l < LANES; l++) {
+        ckpt_t ctag = recover_ckpt[l];
+        ckpt_t ntag = new_ckpt[l];
+
+        if (recover[l]) {
+            for (int r = 0; r < N_ARCH_REGS; r++) rat[r][l] = ckpt_rat[ctag][r][l];
+        } else if (!flush[l]) {
+            if (alloc_req[l]) {
+                reg_t rd = d2r_u.rd[l];
+                if (rd != 0) rat[rd][l] = new_prd[l];
+            }
+            if (ckpt_take[l]) {
+                for (int r = 0; r < N_ARCH_REGS; r++) ckpt_rat[ntag][r][l] = rat[r][l];
+            }
+        }
+
+        // Free list: the pick was made before this cycle's free
+        preg_t found = new_prd[l];
+        free_map[0][l] |= freed[0][l];
+        free_map[1][l] |= freed[1][l];
+        if (recover[l]) {
+            free_map[0][l] = ckpt_free_map[ctag][0][l];
+            free_map[1][l] = ckpt_free_map[ctag][1][l];
+        } else if (!flush[l]) {
+            if (alloc_req[l] && found != 0) {
+                free_map[found >> 6][l] &= ~(1ull << (found & 63));
+            }
+            if (ckpt_take[l]) {
+                ckpt_free_map[ntag][0][l] = free_map[0][l];
+                ckpt_free_map[ntag][1][l] = free_map[1][l];
+            }
+        }
+
+        // Tag allocator
+        if (recover[l]) {
+            next_tag[l] = ckpt_next_tag[ctag][l];
+            tag_reserved[l] = 0;
+        } else if (flush[l]) {
+            tag_reserved[l] = 0;
+        } else {
+            if (disp_fire[l]) tag_reserved[l] &= ~uint16_t(1u << disp.rob_tag[l]);
+            uint16_t used = live_tag[l] | tag_reserved[l];
+            rob_tag_t free_tag = findFreeTag(next_tag[l], used);
+            bool found_tag = !((used >> free_tag) & 1);
+            if (rename_fire[l] && found_tag) {
+                tag_reserved[l] |= uint16_t(1u << free_tag);
+                next_tag[l] = (free_tag + 1) & (ROB_DEPTH - 1);
+            }
+            if (ckpt_take[l]) ckpt_next_tag[ntag][l] = next_tag[l];
+        }
+
+        // Checkpoint pool: squashed branches' slots go back at recovery
+        if (resolve[l]) ckpt_busy[l] &= ~(1u << resolve_ckpt[l]);
+        if (recover[l]) {
+            ckpt_busy[l] &= ~(1u << ctag);
+            for (int i = 0; i < N_CKPT; i++) {
+                bool live = (rs_live[l] >> ckpt_owner[i][l]) & 1;
+                if (!live) ckpt_busy[l] &= ~(1u << i);
+            }
+        } else if (!flush[l] && ckpt_take[l]) {
+            ckpt_busy[l] |= 1u << ntag;
+            ckpt_owner[ntag][l] = new_tag[l];
+        }
+    }
+
+    // Frontend (ICache answers a REQ in the same cycle) and latches
+    for (int l = 0; l < LANES; l++) {
+        bool fetch_fire = fetch_state[l] == FETCH_HAVE && f2d_accept[l];
+        xlen_t fpc = fetch_pc[l];
+        uint32_t finstr = fetch_instr[l];
+
+        if (flush[l]) {
+            fetch_state[l] = FETCH_IDLE;
+            fetch_pc[l] = flush_pc[l];
+            f2d_valid[l] = false;
+            d2r_valid[l] = false;
+            r2d.valid[l] = false;
+            continue;
+        }
+
+        if (fetch_state[l] == FETCH_IDLE) {
+            fetch_state[l] = FETCH_REQ;
+        } else if (fetch_state[l] == FETCH_REQ) {
+            uint32_t idx = fpc >> 2;
+            fetch_instr[l] = idx < static_cast<uint32_t>(IMEM_WORDS) ? imem[idx][l] : NOP;
+            fetch_state[l] = FETCH_HAVE;
+        } else if (f2d_accept[l]) {
+            fetch_pc[l] = fpc + 4;
+            fetch_state[l] = FETCH_REQ;
+        }
+
+        if (disp_ready[l]) r2d.valid[l] = false;
+        if (rename_fire[l]) {
+            r2d.valid[l] = true;
+            r2d.pc[l] = rpkt.pc[l];
+            r2d.instr[l] = rpkt.instr[l];
+            r2d.prs1[l] = rpkt.prs1[l];
+            r2d.prs2[l] = rpkt.prs2[l];
+            r2d.prd[l] = rpkt.prd[l];
+            r2d.old_prd[l] = rpkt.old_prd[l];
+            r2d.prs1_ready[l] = rpkt.prs1_ready[l];
+            r2d.prs2_ready[l] = rpkt.prs2_ready[l];
+            r2d.rob_tag[l] = rpkt.rob_tag[l];
+            r2d.ckpt[l] = rpkt.ckpt[l];
+            d2r_valid[l] = false;
+        }
+        if (decode_fire[l]) {
+            d2r_valid[l] = true;
+            d2r_pc[l] = f2d_pc[l];
+            d2r_instr[l] = f2d_instr[l];
+            f2d_valid[l] = false;
+        }
+        if (fetch_fire) {
+            f2d_valid[l] = true;
+            f2d_pc[l] = fpc;
+            f2d_instr[l] = finstr;
+        }
+    }
+
+    cycle_count++;
+}
+
+template <int LANES>
+void BatchCore<LANES>::run(uint64_t cycles) {
+    for (uint64_t i = 0; i < cycles; i++) {
+        tick();
+    }
+}
+
+template <int LANES>
+uint32_t BatchCore<LANES>::getArchRegValue(int lane, reg_t arch_reg) const {
+    if (arch_reg == 0) {
+        return 0;
+    }
+    return prf[arch_rat[arch_reg][lane]][lane];
+}
+
+template class BatchCore<4>;
+template class BatchCore<8>;
+template class BatchCore<16>;
+template class BatchCore<32>;
+template class BatchCore<64>;
@@ -0,0 +1,126 @@
+#include "branch_fu.h"
+#include "alu_fu.h"
+
+BranchFU::BranchFU() {
+    reset();
+}
+
+void BranchFU::reset() {
+    wb_q = {};
+    mp_q = false;
+    tgt_q = 0;
+    rtag_q = 0;
+    ckpt_q = 0;
+    pred_q = {};
+    jump_q = false;
+    jump_pc_q = 0;
+    jump_instr_q = 0;
+    jump_target_q = 0;
+}
+
+void BranchFU::tick(bool flush, bool issue_valid, const RSEntry& entry,
+                    xlen_t src1, xlen_t src2) {
+    if (flush) {
+        reset();
+        return;
+    }
+    
+    WBPkt wb_n = {};
+    bool mp_n = false;
+    xlen_t tgt_n = 0;
+    rob_tag_t rtag_n = 0;
+    ckpt_t ckpt_n = 0;
+    FetchPred pred_n = {};
+    bool jump_n = false;
+    xlen_t jump_target_n = 0;
+    
+    if (issue_valid && entry.valid) {
+        // Mark done in ROB, link register for JAL/JALR. A fused pair
+        // (Decode::fuse) ends at pc + 4.
+        bool fused = entry.fuse != FuseRule::NONE;
+        xlen_t next_pc = entry.pc + (fused ? 8 : 4);
+        wb_n.valid = true;
+        wb_n.rob_tag = entry.rob_tag;
+        wb_n.rd_used = entry.rd_used;
+        wb_n.prd = entry.rd_used ? entry.prd : 0;
+        wb_n.data = (entry.is_jump && entry.rd_used) ? next_pc : 0;
+        ckpt_n = entry.ckpt_id;
+        
+        xlen_t op1 = src1;
+        xlen_t op2 = src2;
+        if (entry.fuse == FuseRule::ALU_BRANCH) {
+            // rd gets the ALU result, which the branch compares with x0
+            xlen_t v = ALUFU::execute(entry, src1, src2);
+            wb_n.data = v;
+            op1 = ((entry.instr2 >> 15) & 0x1F) ? v : 0;
+            op2 = ((entry.instr2 >> 20) & 0x1F) ? v : 0;
+        } else if (entry.fuse == FuseRule::CONST_JALR && ((entry.instr2 >> 7) & 0x1F) == 0) {
+            // jalr x0: rd keeps the constant
+            wb_n.data = entry.imm;
+        }
+        
+        // Fetch went to next_pc unless it predicted a taken jump (the
+        // default always-not-taken front end never does)
+        bool taken = computeTaken(entry, op1, op2);
+        xlen_t target = taken ? computeTarget(entry, src1) : next_pc;
+        if (taken != entry.pred.taken || (taken && target != entry.pred.target)) {
+            mp_n = true;
+            tgt_n = target;
+            rtag_n = entry.rob_tag;
+            pred_n = entry.pred;
+        }
+        jump_n = entry.is_jump;
+        jump_target_n = target;
+    }
+    
+    wb_q = wb_n;
+    mp_q = mp_n;
+    tgt_q = tgt_n;
+    rtag_q = rtag_n;
+    ckpt_q = ckpt_n;
+    pred_q = pred_n;
+    jump_q = jump_n;
+    if (jump_n) {
+        // The predictor saw the jump half of a fused pair
+        bool fused = entry.fuse != FuseRule::NONE;
+        jump_pc_q = fused ? entry.pc + 4 : entry.pc;
+        jump_instr_q = fused ? entry.instr2 : entry.instr;
+        jump_target_q = jump_target_n;
+    }
+}
+
+bool BranchFU::computeTaken(const RSEntry& entry, xlen_t src1, xlen_t src2) const {
+    if (entry.is_jump) {
+        return true;
+    }
+    if (!entry.is_branch) {
+        return false;
+    }
+    
+    uint32_t instr = entry.fuse == FuseRule::ALU_BRANCH ? entry.instr2 : entry.instr;
+    uint8_t funct3 = (instr >> 12) & 0x7;
+    switch (funct3) {
+        case 0x0: return src1 == src2;                                               // BEQ
+        case 0x1: return src1 != src2;                                               // BNE
+        case 0x4: return static_cast<int32_t>(src1) < static_cast<int32_t>(src2);    // BLT
+        case 0x5: return static_cast<int32_t>(src1) >= static_cast<int32_t>(src2);   // BGE
+        case 0x6: return src1 < src2;                                                // BLTU
+        case 0x7: return src1 >= src2;                                               // BGEU
+        default:  return false;
+    }
+}
+
+xlen_t BranchFU::computeTarget(const RSEntry& entry, xlen_t src1) const {
+    if (entry.fuse == FuseRule::CONST_JALR) {
+        return (entry.imm + entry.imm2) & 0xFFFFFFFE;
+    }
+    if (entry.fuse == FuseRule::ALU_BRANCH) {
+        return entry.pc + 4 + entry.imm2;
+    }
+    uint8_t opcode = entry.instr & 0x7F;
+    if (opcode == 0x67) {
+        // JALR target = (rs1 + imm) & ~1
+        return (src1 + entry.imm) & 0xFFFFFFFE;
+    }
+    return entry.pc + entry.imm;
+}
@@ -0,0 +1,119 @@
+#include "branch_pred.h"
+#include <algorithm>
+
+namespace {
+
+bool isLink(uint32_t r) { return r == 1 || r == 5; }
+
+int32_t immJ(uint32_t in) {
+    return (static_cast<int32_t>(in & 0x80000000) >> 11) | (in & 0xFF000) |
+           ((in >> 9) & 0x800) | ((in >> 20) & 0x7FE);
+}
+
+} // namespace
+
+BranchPred::BranchPred() : ras_depth(0) {
+    reset();
+}
+
+void BranchPred::reset() {
+    ras.fill(0);
+    tos = 0;
+    count = 0;
+    itt.fill(ITTEntry{});
+    stats = {};
+}
+
+void BranchPred::setRASDepth(int depth) {
+    ras_depth = std::min(std::max(depth, 0), MAX_RAS_DEPTH);
+    reset();
+}
+
+BranchPred::Kind BranchPred::classify(uint32_t instr) {
+    uint32_t op = instr & 0x7F;
+    uint32_t rd = (instr >> 7) & 0x1F;
+    uint32_t rs1 = (instr >> 15) & 0x1F;
+    if (op == 0x6F) {
+        return isLink(rd) ? Kind::CALL : Kind::JUMP;
+    }
+    if (op != 0x67) {
+        return Kind::NONE;
+    }
+    if (isLink(rd)) return Kind::CALL;
+    if (isLink(rs1)) return Kind::RETURN;
+    return Kind::INDIRECT;
+}
+
+const BranchPred::ITTEntry* BranchPred::lookup(xlen_t pc) const {
+    const ITTEntry& e = itt[(pc >> 2) % ITT_ENTRIES];
+    return (e.valid && e.pc == pc) ? &e : nullptr;
+}
+
+FetchPred BranchPred::predict(xlen_t pc, uint32_t instr) const {
+    FetchPred p = {false, 0, tos, count, ras[tos]};
+    if (ras_depth == 0) {
+        return p;
+    }
+
+    Kind kind = classify(instr);
+    bool jal = (instr & 0x7F) == 0x6F;
+    if (kind == Kind::NONE) {
+        return p;
+    }
+
+    if (jal) {
+        p.taken = true;
+        p.target = pc + immJ(instr);
+    } else if (kind == Kind::RETURN && count > 0) {
+        p.taken = true;
+        p.target = ras[tos];
+    } else if (const ITTEntry* e = lookup(pc)) {
+        // Other JALRs, and returns with the RAS empty
+        p.taken = true;
+        p.target = e->target;
+    }
+
+    if (kind == Kind::CALL) {
+        p.ras_tos = static_cast<uint8_t>((tos + 1) % ras_depth);
+        p.ras_count = static_cast<uint8_t>(std::min<int>(count + 1, ras_depth));
+        p.ras_top = pc + 4;
+    } else if (kind == Kind::RETURN && count > 0) {
+        p.ras_tos = static_cast<uint8_t>((tos + ras_depth - 1) % ras_depth);
+        p.ras_count = count - 1;
+        p.ras_top = ras[p.ras_tos];
+    }
+    return p;
+}
+
+void BranchPred::tick(bool flush, const FetchPred& recover_pred,
+                      bool fire, const FetchPred& fire_pred,
+                      bool resolve, xlen_t res_pc, uint32_t res_instr,
+                      xlen_t res_target, bool res_mispredict) {
+    if (ras_depth == 0) {
+        return;
+    }
+
+    // Wrong-path pushes and pops only moved the pointer and overwrote the
+    // slots above it, so the pointer and top entry are all that needs repair
+    const FetchPred* apply = flush ? &recover_pred : fire ? &fire_pred : nullptr;
+    if (apply) {
+        tos = apply->ras_tos;
+        count = apply->ras_count;
+        ras[tos] = apply->ras_top;
+    }
+
+    if (!resolve) {
+        return;
+    }
+    Kind kind = classify(res_instr);
+    if ((res_instr & 0x7F) == 0x67) {
+        itt[(res_pc >> 2) % ITT_ENTRIES] = {true, res_pc, res_target};
+    }
+    switch (kind) {
+        case Kind::JUMP:     stats.jumps++;    stats.jump_miss += res_mispredict;     break;
+        case Kind::CALL:     stats.calls++;    stats.call_miss += res_mispredict;     break;
+        case Kind::RETURN:   stats.returns++;  stats.return_miss += res_mispredict;   break;
+        case Kind::INDIRECT: stats.indirect++; stats.indirect_miss += res_mispredict; break;
+        default: break;
+    }
+}
@@ -0,0 +1,61 @@
+#include "ckpt_pool.h"
+
+CkptPool::CkptPool() {
+    setSlots(N_CKPT);
+}
+
+void CkptPool::reset() {
+    busy.assign(slots, 0);
+    owner.assign(slots, 0);
+    busy_count = 0;
+}
+
+void CkptPool::setSlots(int n) {
+    slots = n < 1 ? 1 : (n > N_CKPT ? N_CKPT : n);
+    reset();
+}
+
+void CkptPool::tick(bool flush, bool recover, ckpt_t recover_ckpt,
+                    const std::bitset<ROB_DEPTH>& live_tag,
+                    bool resolve, ckpt_t resolve_ckpt,
+                    bool take, ckpt_t take_ckpt, rob_tag_t take_tag) {
+    // A correctly predicted branch no longer needs its snapshot
+    auto release = [this](int i) {
+        busy_count -= busy[i];
+        busy[i] = 0;
+    };
+    if (resolve) {
+        release(resolve_ckpt);
+    }
+    
+    if (recover) {
+        // live_tag holds the tags surviving the recovery; slots of the
+        // squashed (younger) branches go back with the recovering one
+        release(recover_ckpt);
+        for (int i = 0; i < slots; i++) {
+            if (busy[i] && !live_tag.test(owner[i])) {
+                release(i);
+            }
+        }
+        return;
+    }
+    
+    if (flush) {
+        return;
+    }
+    
+    if (take) {
+        busy_count += !busy[take_ckpt];
+        busy[take_ckpt] = 1;
+        owner[take_ckpt] = take_tag;
+    }
+}
+
+ckpt_t CkptPool::getSlot() const {
+    for (int i = 0; i < slots; i++) {
+        if (!busy[i]) {
+            return static_cast<ckpt_t>(i);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "commit_check.h"
+#include "rv32i.h"
+#include <iomanip>
+
+namespace {
+
+uint32_t sizeMask(LSSize size) {
+    switch (size) {
+        case LSSize::B: return 0xFF;
+        case LSSize::H: return 0xFFFF;
+        default:        return 0xFFFFFFFF;
+    }
+}
+
+} // namespace
+
+CommitChecker::CommitChecker() : loaded(false) {
+    reset();
+}
+
+bool CommitChecker::loadProgram(const std::string& filename) {
+    if (!iss.loadProgram(filename)) {
+        return false;
+    }
+    loaded = true;
+    reset();
+    return true;
+}
+
+void CommitChecker::loadProgramWords(const std::vector<uint32_t>& words) {
+    iss.loadWords(words);
+    loaded = true;
+    reset();
+}
+
+void CommitChecker::reset() {
+    iss.reset();
+    checked = 0;
+    failed = false;
+    first = {};
+    store_valid = false;
+    store_tag = 0;
+    store_addr = 0;
+    store_data = 0;
+    store_size = LSSize::W;
+}
+
+void CommitChecker::fail(uint64_t cycle, const ISS::StepInfo& s, const char* what,
+                         uint32_t expected, uint32_t got) {
+    if (failed) {
+        return;
+    }
+    failed = true;
+    first = {cycle, checked, s.pc, s.instr, what, expected, got};
+}
+
+void CommitChecker::onStore(uint64_t cycle, rob_tag_t tag, uint32_t addr, uint32_t data,
+                            LSSize size) {
+    (void)cycle;
+    store_valid = true;
+    store_tag = tag;
+    store_addr = addr;
+    store_data = data;
+    store_size = size;
+}
+
+void CommitChecker::onCommit(uint64_t cycle, const CommitPkt& c) {
+    if (!loaded || failed) {
+        return;
+    }
+    checked++;
+    ISS::StepInfo s = iss.step();
+    
+    if (c.pc != s.pc) {
+        fail(cycle, s, "pc", s.pc, c.pc);
+        return;
+    }
+    if (c.fuse != FuseRule::NONE) {
+        // A fused pair retires both instructions (neither is a store); the
+        // core shows the last register written
+        checked++;
+        ISS::StepInfo s2 = iss.step();
+        if (s2.rd_written) {
+            s.rd_written = true;
+            s.rd = s2.rd;
+            s.rd_value = s2.rd_value;
+        }
+        s.is_store = s.is_store || s2.is_store;
+    }
+    
+    bool core_writes = c.rd_used && c.rd != 0;
+    if (core_writes != s.rd_written || (s.rd_written && c.rd != s.rd)) {
+        fail(cycle, s, "rd", s.rd_written ? s.rd : 0, core_writes ? c.rd : 0);
+        return;
+    }
+    if (s.rd_written && c.rd_value != s.rd_value) {
+        fail(cycle, s, "rd value", s.rd_value, c.rd_value);
+        return;
+    }
+    
+    bool core_store = store_valid && store_tag == c.rob_tag;
+    if (core_store != s.is_store) {
+        fail(cycle, s, "store", s.is_store, core_store);
+        return;
+    }
+    if (s.is_store) {
+        store_valid = false;
+        uint32_t mask = sizeMask(s.store_size);
+        if (store_addr != s.store_addr) {
+            fail(cycle, s, "store addr", s.store_addr, store_addr);
+        } else if (store_size != s.store_size) {
+            fail(cycle, s, "store size", static_cast<uint32_t>(s.store_size),
+                 static_cast<uint32_t>(store_size));
+        } else if ((store_data & mask) != (s.store_data & mask)) {
+            fail(cycle, s, "store data", s.store_data & mask, store_data & mask);
+        }
+    }
+}
+
+void CommitChecker::report(std::ostream& os) const {
+    if (!failed) {
+        os << "Commit check: " << checked << " commits match the ISS" << std::endl;
+        return;
+    }
+    os << "COMMIT MISMATCH @ cycle " << first.cycle << ", commit #" << first.commit
+       << ": pc 0x" << std::hex << std::setw(8) << std::setfill('0') << first.pc
+       << std::setfill(' ') << std::dec << " " << rv32::disasm(first.instr) << ": "
+       << first.what << " expected 0x" << std::hex << first.expected << " got 0x"
+       << first.got << std::dec << std::endl;
+}
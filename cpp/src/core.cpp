@@ -0,0 +1,3 @@
+#include "core_impl.h"
+
+template class BasicCore<NoObserver>;
@@ -1,6 +1,36 @@
 #include "decode.h"
+#include "rv32i.h"
 
-Decode::Decode() {}
+namespace {
+
+uint32_t opcodeOf(const DecodePkt& p) {
+    return p.instr & 0x7F;
+}
+
+uint32_t funct3Of(const DecodePkt& p) {
+    return (p.instr >> 12) & 0x7;
+}
+
+bool enabled(uint32_t rules, FuseRule r) {
+    return (rules >> static_cast<int>(r)) & 1;
+}
+
+// ALU op from OP / OP-IMM (not LUI) with a destination
+bool writesAluResult(const DecodePkt& a) {
+    return a.fu_type == FUType::ALU && a.rd_used &&
+           (opcodeOf(a) == rv32::OP_IMM || opcodeOf(a) == rv32::OP_REG);
+}
+
+// lui t, C or addi t, x0, C: t = C, known at decode
+bool loadsConstant(const DecodePkt& a) {
+    if (!a.rd_used) return false;
+    if (opcodeOf(a) == rv32::OP_LUI) return true;
+    return opcodeOf(a) == rv32::OP_IMM && funct3Of(a) == 0x0 && a.rs1 == 0;
+}
+
+} // namespace
+
+Decode::Decode() : fuse_rules(0) {}
 
 DecodePkt Decode::decode(bool valid_in, xlen_t pc_in, uint32_t instr_in) {
     DecodePkt pkt = {};
@@ -93,6 +123,22 @@ DecodePkt Decode::decode(bool valid_in, xlen_t pc_in, uint32_t instr_in) {
             pkt.rs2_used = true;
             pkt.rd_used = (pkt.rd != 0);
             
+            if (funct7 == 0x01) {
+                // RV32M
+                pkt.fu_type = FUType::MDU;
+                switch (funct3) {
+                    case 0x0: pkt.alu_op = ALUOp::MUL; break;
+                    case 0x1: pkt.alu_op = ALUOp::MULH; break;
+                    case 0x2: pkt.alu_op = ALUOp::MULHSU; break;
+                    case 0x3: pkt.alu_op = ALUOp::MULHU; break;
+                    case 0x4: pkt.alu_op = ALUOp::DIV; break;
+                    case 0x5: pkt.alu_op = ALUOp::DIVU; break;
+                    case 0x6: pkt.alu_op = ALUOp::REM; break;
+                    default:  pkt.alu_op = ALUOp::REMU; break;
+                }
+                break;
+            }
+            
             switch (funct3) {
                 case 0x0:
                     if (funct7 == 0x20) pkt.alu_op = ALUOp::SUB;  // SUB
@@ -170,3 +216,88 @@ DecodePkt Decode::decode(bool valid_in, xlen_t pc_in, uint32_t instr_in) {
     
     return pkt;
 }
+
+bool Decode::isFusionHead(const DecodePkt& a) const {
+    if (fuse_rules == 0 || !a.valid) {
+        return false;
+    }
+    return (enabled(fuse_rules, FuseRule::LUI_ADDI) && opcodeOf(a) == rv32::OP_LUI && a.rd_used) ||
+           (enabled(fuse_rules, FuseRule::CONST_JALR) && loadsConstant(a)) ||
+           (enabled(fuse_rules, FuseRule::ALU_BRANCH) && writesAluResult(a)) ||
+           (enabled(fuse_rules, FuseRule::ADD_LOAD) && writesAluResult(a) &&
+            opcodeOf(a) == rv32::OP_REG && a.alu_op == ALUOp::ADD);
+}
+
+FuseRule Decode::fuse(const DecodePkt& a, const DecodePkt& b, DecodePkt& out) const {
+    if (!isFusionHead(a) || !b.valid || b.pc != a.pc + 4) {
+        return FuseRule::NONE;
+    }
+    reg_t t = a.rd;
+    uint32_t op_b = opcodeOf(b);
+    
+    FuseRule rule = FuseRule::NONE;
+    if (enabled(fuse_rules, FuseRule::LUI_ADDI) && opcodeOf(a) == rv32::OP_LUI &&
+        op_b == rv32::OP_IMM && funct3Of(b) == 0x0 && b.rd == t && b.rs1 == t) {
+        rule = FuseRule::LUI_ADDI;
+    } else if (enabled(fuse_rules, FuseRule::CONST_JALR) && loadsConstant(a) &&
+               op_b == rv32::OP_JALR && b.rs1 == t && (b.rd == t || b.rd == 0)) {
+        rule = FuseRule::CONST_JALR;
+    } else if (enabled(fuse_rules, FuseRule::ALU_BRANCH) && writesAluResult(a) &&
+               op_b == rv32::OP_BRANCH && (b.rs1 == t || b.rs2 == t) &&
+               (b.rs1 == t || b.rs1 == 0) && (b.rs2 == t || b.rs2 == 0)) {
+        rule = FuseRule::ALU_BRANCH;
+    } else if (enabled(fuse_rules, FuseRule::ADD_LOAD) && writesAluResult(a) &&
+               opcodeOf(a) == rv32::OP_REG && a.alu_op == ALUOp::ADD &&
+               b.is_load && b.rs1 == t && b.rd == t) {
+        rule = FuseRule::ADD_LOAD;
+    }
+    if (rule == FuseRule::NONE) {
+        return rule;
+    }
+    
+    out = a;
+    out.fuse = rule;
+    out.instr2 = b.instr;
+    out.imm2 = b.imm;
+    out.pred = b.pred;      // fetch continued after b
+    switch (rule) {
+        case FuseRule::LUI_ADDI:
+            out.imm = a.imm + b.imm;
+            break;
+            
+        case FuseRule::CONST_JALR:
+            // BRU: jump to C + off, t = C (jalr x0) or the link
+            out.fu_type = FUType::BRU;
+            out.alu_op = ALUOp::LUI;
+            out.is_jump = true;
+            out.rs1_used = false;
+            break;
+            
+        case FuseRule::ALU_BRANCH:
+            // BRU: ALU result to t, then the branch on it
+            out.fu_type = FUType::BRU;
+            out.is_branch = true;
+            break;
+            
+        default:
+            // LSU: address rs1 + rs2 + off, loaded value to t
+            out.fu_type = FUType::LSU;
+            out.is_load = true;
+            out.imm = b.imm;
+            out.imm_used = true;
+            out.ls_size = b.ls_size;
+            out.unsigned_load = b.unsigned_load;
+            break;
+    }
+    return rule;
+}
+
+const char* Decode::fuseRuleName(FuseRule rule) {
+    switch (rule) {
+        case FuseRule::LUI_ADDI:   return "lui-addi";
+        case FuseRule::CONST_JALR: return "const-jalr";
+        case FuseRule::ALU_BRANCH: return "alu-branch";
+        case FuseRule::ADD_LOAD:   return "add-load";
+        default:                   return "none";
+    }
+}
@@ -0,0 +1,108 @@
+#include "dispatch.h"
+
+Dispatch::Dispatch() {
+    reset();
+}
+
+void Dispatch::reset() {
+    fifo.reset();
+}
+
+void Dispatch::tick(bool flush, bool valid_in, const RenamePkt& pkt_in,
+                    bool rs_alu_ready, bool rs_bru_ready, bool rs_lsu_ready,
+                    bool rs_mdu_ready, bool rob_ready) {
+    fifo.sample();
+    if (flush) {
+        fifo.flush();
+        return;
+    }
+    
+    bool do_pop = getFire(flush, rs_alu_ready, rs_bru_ready, rs_lsu_ready,
+                          rs_mdu_ready, rob_ready);
+    bool do_push = valid_in && getReadyOut(do_pop);
+    
+    if (do_pop) {
+        fifo.pop();
+    }
+    if (do_push) {
+        fifo.push(pkt_in);
+    }
+}
+
+bool Dispatch::getFire(bool flush, bool rs_alu_ready, bool rs_bru_ready,
+                       bool rs_lsu_ready, bool rs_mdu_ready, bool rob_ready) const {
+    // Do NOT dispatch during flush (which happens during recovery)
+    return !fifo.empty() && rob_ready && !flush &&
+           rsSpaceOk(fifo.front(), rs_alu_ready, rs_bru_ready, rs_lsu_ready, rs_mdu_ready);
+}
+
+bool Dispatch::getRSALUValid(bool fire) const {
+    return fire && fifo.front().fu_type == FUType::ALU;
+}
+
+bool Dispatch::getRSBRUValid(bool fire) const {
+    return fire && fifo.front().fu_type == FUType::BRU;
+}
+
+bool Dispatch::getRSLSUValid(bool fire) const {
+    return fire && fifo.front().fu_type == FUType::LSU;
+}
+
+bool Dispatch::getRSMDUValid(bool fire) const {
+    return fire && fifo.front().fu_type == FUType::MDU;
+}
+
+RSEntry Dispatch::buildRSEntry(const RenamePkt& pkt) const {
+    RSEntry entry = {};
+    
+    entry.valid = true;
+    entry.pc = pkt.pc;
+    entry.instr = pkt.instr;
+    
+    entry.fu_type = pkt.fu_type;
+    entry.alu_op = pkt.alu_op;
+    
+    entry.imm = pkt.imm;
+    entry.imm_used = pkt.imm_used;
+    
+    entry.rd_used = pkt.rd_used;
+    
+    entry.is_load = pkt.is_load;
+    entry.is_store = pkt.is_store;
+    entry.ls_size = pkt.ls_size;
+    entry.unsigned_load = pkt.unsigned_load;
+    
+    entry.is_branch = pkt.is_branch;
+    entry.is_jump = pkt.is_jump;
+    entry.pred = pkt.pred;
+    entry.fuse = pkt.fuse;
+    entry.instr2 = pkt.instr2;
+    entry.imm2 = pkt.imm2;
+    
+    entry.rs1_used = pkt.rs1_used;
+    entry.rs2_used = pkt.rs2_used;
+    
+    entry.prs1 = pkt.prs1;
+    entry.prs2 = pkt.prs2;
+    entry.prd = pkt.prd;
+    
+    entry.prs1_ready = pkt.prs1_ready;
+    entry.prs2_ready = pkt.prs2_ready;
+    
+    entry.rob_tag = pkt.rob_tag;
+    entry.ckpt_id = pkt.ckpt_id;
+    
+    return entry;
+}
+
+bool Dispatch::rsSpaceOk(const RenamePkt& pkt, bool rs_alu_ready,
+                         bool rs_bru_ready, bool rs_lsu_ready, bool rs_mdu_ready) const {
+    switch (pkt.fu_type) {
+        case FUType::ALU: return rs_alu_ready;
+        case FUType::BRU: return rs_bru_ready;
+        case FUType::LSU: return rs_lsu_ready;
+        case FUType::MDU: return rs_mdu_ready;
+        case FUType::NONE: return pkt.eliminated;    // ROB only
+        default: return false;
+    }
+}
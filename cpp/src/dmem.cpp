@@ -0,0 +1,68 @@
+#include "dmem.h"
+#include "shared_mem.h"
+
+DMem::DMem() : shared(nullptr), port(0) {
+    reset();
+}
+
+void DMem::attach(SharedMem* mem_backend, int port_id) {
+    shared = mem_backend;
+    port = port_id;
+}
+
+void DMem::reset() {
+    mem.fill(0);
+    v1_q = false;
+    v2_q = false;
+    rdata1_q = 0;
+    rdata2_q = 0;
+    cycle = 0;
+}
+
+void DMem::tick(bool en, bool we, uint32_t addr, uint32_t wdata, LSSize size) {
+    // Stage 2
+    v2_q = v1_q;
+    rdata2_q = rdata1_q;
+    
+    // Stage 1 (word index wraps, matching dmem_bram.sv)
+    uint32_t idx = (addr >> 2) & (DEPTH_WORDS - 1);
+    uint8_t off = addr & 0x3;
+    
+    v1_q = en;
+    if (en) {
+        if (shared) {
+            rdata1_q = shared->load(port, idx);
+            if (we) {
+                shared->store(port, cycle, idx, wdata, size, off);
+            }
+        } else {
+            rdata1_q = mem[idx];
+            if (we) {
+                mem[idx] = writeMerge(mem[idx], wdata, size, off);
+            }
+        }
+    }
+    cycle++;
+}
+
+uint32_t DMem::peek(uint32_t addr) const {
+    return shared ? shared->peek(addr) : mem[(addr >> 2) & (DEPTH_WORDS - 1)];
+}
+
+uint32_t DMem::writeMerge(uint32_t old_word, uint32_t new_word,
+                          LSSize size, uint8_t off) {
+    switch (size) {
+        case LSSize::B: {
+            uint32_t shift = off * 8;
+            uint32_t mask = 0xFFu << shift;
+            return (old_word & ~mask) | ((new_word & 0xFF) << shift);
+        }
+        case LSSize::H: {
+            uint32_t shift = (off & 0x2) * 8;
+            uint32_t mask = 0xFFFFu << shift;
+            return (old_word & ~mask) | ((new_word & 0xFFFF) << shift);
+        }
+        default:
+            return new_word;
+    }
+}
@@ -0,0 +1,115 @@
+#include "energy.h"
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+const std::array<EnergyTable::Event, EnergyTable::N_EVENT>& EnergyTable::events() {
+    static const std::array<Event, N_EVENT> table = {{
+        {"rat.read",           "RAT",      &ActivityCounts::rat_read,      0.6},
+        {"rat.write",          "RAT",      &ActivityCounts::rat_write,     0.8},
+        {"rat.checkpoint",     "RAT",      &ActivityCounts::rat_ckpt,      6.0},
+        {"freelist.alloc",     "FreeList", &ActivityCounts::fl_alloc,      0.4},
+        {"freelist.free",      "FreeList", &ActivityCounts::fl_free,       0.4},
+        {"prf.read",           "PRF",      &ActivityCounts::prf_read,      1.6},
+        {"prf.write",          "PRF",      &ActivityCounts::prf_write,     2.0},
+        {"prf.checkpoint",     "PRF",      &ActivityCounts::prf_ckpt,      30.0},
+        {"rs.insert",          "RS",       &ActivityCounts::rs_insert,     1.2},
+        {"rs.wakeup_compare",  "RS",       &ActivityCounts::rs_wakeup_cmp, 0.05},
+        {"rs.select",          "RS",       &ActivityCounts::rs_select,     0.5},
+        {"rob.alloc",          "ROB",      &ActivityCounts::rob_alloc,     1.5},
+        {"rob.commit",         "ROB",      &ActivityCounts::rob_commit,    1.0},
+        {"cdb.broadcast",      "CDB",      &ActivityCounts::cdb_broadcast, 2.5},
+        {"dmem.read",          "DMem",     &ActivityCounts::dmem_read,     10.0},
+        {"dmem.write",         "DMem",     &ActivityCounts::dmem_write,    11.0},
+        {"icache.read",        "ICache",   &ActivityCounts::icache_read,   8.0},
+    }};
+    return table;
+}
+
+EnergyTable::EnergyTable() : clock_ghz(1.0) {
+    for (int i = 0; i < N_EVENT; i++) {
+        pj[i] = events()[i].default_pj;
+    }
+}
+
+bool EnergyTable::read(std::istream& is, std::string& err) {
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::vector<std::string> f;
+        std::stringstream ss(line);
+        std::string tok;
+        while (std::getline(ss, tok, ',')) {
+            f.push_back(tok);
+        }
+        double v = 0;
+        try {
+            if (f.size() != 2) throw std::invalid_argument("fields");
+            v = std::stod(f[1]);
+        } catch (const std::exception&) {
+            err = line;
+            return false;
+        }
+        if (f[0] == "clock_ghz" && v > 0) {
+            clock_ghz = v;
+            continue;
+        }
+        int i = 0;
+        while (i < N_EVENT && f[0] != events()[i].name) i++;
+        if (i == N_EVENT || v < 0) {
+            err = line;
+            return false;
+        }
+        pj[i] = v;
+    }
+    return true;
+}
+
+void EnergyTable::report(std::ostream& os, const ActivityCounts& a, uint64_t cycles,
+                         uint64_t commits) const {
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize prec = os.precision();
+    double total = 0;
+    for (int i = 0; i < N_EVENT; i++) {
+        total += pj[i] * static_cast<double>(a.*events()[i].count);
+    }
+
+    os << "Energy per structure @ " << std::fixed << std::setprecision(2) << clock_ghz
+       << " GHz (dynamic, per-access table)" << std::endl;
+    os << std::left << std::setw(22) << "structure / event" << std::right << std::setw(12)
+       << "accesses" << std::setw(12) << "pJ/access" << std::setw(14) << "energy nJ"
+       << std::setw(8) << "share" << std::endl;
+    auto share = [&](double e) { return total > 0 ? 100.0 * e / total : 0.0; };
+
+    // Events are listed grouped by structure
+    for (int i = 0; i < N_EVENT;) {
+        const char* s = events()[i].structure;
+        int end = i;
+        double e = 0;
+        while (end < N_EVENT && std::string(events()[end].structure) == s) {
+            e += pj[end] * static_cast<double>(a.*events()[end].count);
+            end++;
+        }
+        os << std::left << std::setw(22) << s << std::right << std::setw(12) << ""
+           << std::setw(12) << "" << std::setw(14) << std::setprecision(3) << e / 1000.0
+           << std::setw(7) << std::setprecision(1) << share(e) << "%" << std::endl;
+        for (; i < end; i++) {
+            uint64_t n = a.*events()[i].count;
+            os << "  " << std::left << std::setw(20) << events()[i].name << std::right
+               << std::setw(12) << n << std::setw(12) << std::setprecision(2) << pj[i]
+               << std::setw(14) << std::setprecision(3) << pj[i] * n / 1000.0 << std::endl;
+        }
+    }
+
+    // pJ per ns is mW
+    double ns = cycles / clock_ghz;
+    os << "total " << std::setprecision(3) << total / 1000.0 << " nJ over " << cycles
+       << " cycles: average power " << (ns > 0 ? total / ns : 0.0) << " mW, "
+       << std::setprecision(2) << (commits ? total / commits : 0.0) << " pJ/instruction"
+       << std::endl;
+    os.flags(flags);
+    os.precision(prec);
+}
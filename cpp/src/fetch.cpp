@@ -1,15 +1,58 @@
 #include "fetch.h"
+#include <algorithm>
 
-Fetch::Fetch() : state(State::IDLE), pc_q(0), instr_q(0x00000013) {}
+Fetch::Fetch() : state(State::IDLE), pc_q(0), instr_q(0x00000013), buf_depth(0) {
+    reset();
+}
 
-void Fetch::reset() {
+void Fetch::reset(xlen_t reset_pc) {
     state = State::IDLE;
-    pc_q = 0;
+    pc_q = reset_pc;
     instr_q = 0x00000013;
+    buf.flush();
+    req_pc_q = reset_pc;
+    stats = {};
+}
+
+void Fetch::setBufferDepth(int depth) {
+    buf_depth = std::min(std::max(depth, 0), MAX_BUFFER_DEPTH);
+    buf.setDepth(buf_depth);
+    reset(pc_q);
 }
 
-void Fetch::tick(bool flush, xlen_t flush_pc, bool ready_in,
+void Fetch::tick(bool flush, xlen_t flush_pc, bool ready_in, xlen_t next_pc,
                  bool icache_rvalid, uint32_t icache_rdata) {
+    if (buf_depth) {
+        stats.cycles++;
+        stats.occupancy_sum += buf.size();
+        stats.empty += buf.empty();
+        stats.full += buf.full();
+
+        // A redirect discards everything younger, including the word the
+        // ICache returned this cycle
+        if (flush) {
+            stats.squashed += buf.size() + icache_rvalid;
+            buf.flush();
+            req_pc_q = flush_pc;
+            return;
+        }
+        if (ready_in && !buf.empty()) {
+            xlen_t pc = buf.front().pc;
+            buf.pop();
+            if (next_pc != pc + 4) {
+                stats.squashed += buf.size() + icache_rvalid;
+                buf.flush();
+                req_pc_q = next_pc;
+                return;
+            }
+        }
+        if (icache_rvalid) {
+            buf.push({req_pc_q, icache_rdata});
+            req_pc_q += 4;
+        }
+        return;
+    }
+
     if (flush) {
         state = State::IDLE;
         pc_q = flush_pc;
@@ -18,17 +61,17 @@ void Fetch::tick(bool flush, xlen_t flush_pc, bool ready_in,
             case State::IDLE:
                 state = State::REQ;
                 break;
-                
+
             case State::REQ:
                 if (icache_rvalid) {
                     instr_q = icache_rdata;
                     state = State::HAVE;
                 }
                 break;
-                
+
             case State::HAVE:
                 if (ready_in) {
-                    pc_q += 4;
+                    pc_q = next_pc;
                     state = State::REQ;
                 }
                 break;
@@ -36,10 +79,10 @@ void Fetch::tick(bool flush, xlen_t flush_pc, bool ready_in,
     }
 }
 
-bool Fetch::getValidOut() const {
-    return (state == State::HAVE);
-}
-
-bool Fetch::getICacheEn() const {
-    return (state == State::REQ);
+void Fetch::skipIdle(uint64_t n) {
+    if (buf_depth) {
+        stats.cycles += n;
+        stats.occupancy_sum += n * buf.size();
+        stats.full += n;
+    }
 }
@@ -0,0 +1,164 @@
+#include "flight_recorder.h"
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
+
+namespace {
+
+// Recorder and file the fatal-signal handler dumps to
+const FlightRecorder* g_recorder = nullptr;
+char g_file[4096];
+char g_buf[1024];       // the handler's record buffer
+
+// Fixed-buffer text writer. snprintf is not async-signal-safe, so the
+// records are formatted by hand; the fatal-signal handler may use this.
+// Output past the buffer is dropped.
+class Text {
+private:
+    char* buf;
+    size_t cap;
+    size_t len = 0;
+    
+public:
+    Text(char* b, size_t n) : buf(b), cap(n) {}
+    int size() const { return static_cast<int>(len); }
+    
+    Text& operator<<(const char* s) {
+        while (*s && len < cap) buf[len++] = *s++;
+        return *this;
+    }
+    Text& dec(uint64_t v) {
+        char d[20];
+        int i = 0;
+        do { d[i++] = static_cast<char>('0' + v % 10); v /= 10; } while (v);
+        while (i > 0 && len < cap) buf[len++] = d[--i];
+        return *this;
+    }
+    Text& sdec(int v) {
+        if (v < 0) *this << "-";
+        return dec(v < 0 ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v));
+    }
+    // "0x" and at least `digits` hex digits
+    Text& hex(uint32_t v, int digits = 1) {
+        int n = 1;
+        while (n < 8 && (v >> (4 * n)) != 0) n++;
+        if (n < digits) n = digits;
+        *this << "0x";
+        for (int i = n - 1; i >= 0 && len < cap; i--) {
+            buf[len++] = "0123456789abcdef"[(v >> (4 * i)) & 0xf];
+        }
+        return *this;
+    }
+};
+
+void formatWB(Text& t, const WBPkt& w) {
+    t << "'{valid:"; t.sdec(w.valid) << ",rob_tag:"; t.sdec(w.rob_tag) << ",prd:"; t.sdec(w.prd)
+      << ",data:"; t.hex(w.data, 8) << ",rd_used:"; t.sdec(w.rd_used) << "}";
+}
+
+// One record as core_cycle_dump.log lines. Returns the length written.
+int formatRecord(char* buf, size_t n, const CycleRecord& r) {
+    Text t(buf, n);
+    t << "C"; t.dec(r.cycle) << " | commit="; t.dec(r.commits)
+      << " | flush="; t.sdec(r.flush) << " flush_pc="; t.hex(r.flush_pc, 8)
+      << " recover="; t.sdec(r.recover) << " rtag="; t.sdec(r.recover_tag)
+      << " walking="; t.sdec(r.walking) << " | mp="; t.sdec(r.mispredict)
+      << " tgt="; t.hex(r.mp_target, 8) << " mp_tag="; t.sdec(r.mp_tag) << "\n";
+    t << "  FETCH: pc_q="; t.hex(r.fetch_pc, 8) << " out_v="; t.sdec(r.fetch_valid)
+      << " | DEC: v="; t.sdec(r.dec_valid) << " r="; t.sdec(r.dec_ready)
+      << " | RENAME: v="; t.sdec(r.ren_valid) << " r="; t.sdec(r.ren_ready)
+      << " fire="; t.sdec(r.ren_fire) << " | DISP: v="; t.sdec(r.disp_valid)
+      << " r="; t.sdec(r.disp_ready) << " fire="; t.sdec(r.disp_fire) << "\n";
+    t << "  RS_ISS: iss_alu="; t.sdec(r.iss_alu) << " iss_bru="; t.sdec(r.iss_bru)
+      << " iss_lsu="; t.sdec(r.iss_lsu) << " iss_mdu="; t.sdec(r.iss_mdu)
+      << " sel_tag="; t.sdec(r.iss_tag) << "\n";
+    t << "  WB_ALU: "; formatWB(t, r.wb_alu); t << "\n";
+    t << "  WB_BRU: "; formatWB(t, r.wb_bru); t << "\n";
+    t << "  WB_LSU: "; formatWB(t, r.wb_lsu); t << "\n";
+    t << "  WB_MDU: "; formatWB(t, r.wb_mdu); t << "\n";
+    t << "  ROB: head="; t.sdec(r.rob_head) << " tail="; t.sdec(r.rob_tail)
+      << " count="; t.sdec(r.rob_count) << " | commit_fire="; t.sdec(r.commit)
+      << " | live_tag="; t.hex(r.live_tag) << "\n";
+    return t.size();
+}
+
+int formatHeader(char* buf, size_t n, size_t held, const char* reason) {
+    Text t(buf, n);
+    t << "=== flight recorder: last "; t.dec(held) << " cycles (" << reason << ") ===\n";
+    return t.size();
+}
+
+} // namespace
+
+FlightRecorder::FlightRecorder(size_t cycles, uint64_t stall_limit)
+    : ring(cycles), stall_limit(stall_limit) {
+    reset();
+}
+
+FlightRecorder::~FlightRecorder() {
+    if (g_recorder == this) {
+        g_recorder = nullptr;
+    }
+}
+
+void FlightRecorder::reset() {
+    next = 0;
+    recorded = 0;
+    stall = 0;
+}
+
+void FlightRecorder::dump(std::ostream& os, const std::string& reason) const {
+    char buf[1024];
+    size_t held = getHeld();
+    os.write(buf, formatHeader(buf, sizeof(buf), held, reason.c_str()));
+    size_t start = held < ring.size() ? 0 : next;
+    for (size_t i = 0; i < held; i++) {
+        os.write(buf, formatRecord(buf, sizeof(buf), ring[(start + i) % ring.size()]));
+    }
+}
+
+bool FlightRecorder::dump(const std::string& filename, const std::string& reason) const {
+    std::ofstream out(filename);
+    dump(out, reason);
+    return static_cast<bool>(out);
+}
+
+void FlightRecorder::dumpFd(int fd, const char* reason) const {
+    size_t held = getHeld();
+    ssize_t ignored = ::write(fd, g_buf, formatHeader(g_buf, sizeof(g_buf), held, reason));
+    size_t start = held < ring.size() ? 0 : next;
+    for (size_t i = 0; i < held; i++) {
+        ignored = ::write(fd, g_buf, formatRecord(g_buf, sizeof(g_buf), ring[(start + i) % ring.size()]));
+    }
+    (void)ignored;
+}
+
+void FlightRecorder::installSignalHandlers(const std::string& filename) {
+    g_recorder = this;
+    size_t n = filename.copy(g_file, sizeof(g_file) - 1);
+    g_file[n] = '\0';
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+    std::signal(SIGSEGV, onFatalSignal);
+    std::signal(SIGABRT, onFatalSignal);
+    std::signal(SIGFPE, onFatalSignal);
+}
+
+void FlightRecorder::onStopSignal(int sig) {
+    (void)sig;
+    stop_signal = 1;
+}
+
+// Best effort: the core state may be corrupt, so only read the ring and
+// write with plain syscalls, then die by the same signal
+void FlightRecorder::onFatalSignal(int sig) {
+    std::signal(sig, SIG_DFL);
+    const FlightRecorder* rec = g_recorder;
+    int fd = rec ? ::open(g_file, O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+    if (fd >= 0) {
+        rec->dumpFd(fd, sig == SIGABRT ? "abort / assertion" :
+                        sig == SIGSEGV ? "segmentation fault" : "fatal signal");
+        ::close(fd);
+    }
+    std::raise(sig);
+}
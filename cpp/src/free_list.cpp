@@ -1,72 +1,94 @@
 #include "free_list.h"
 
-FreeList::FreeList() : alloc_gnt_q(false), alloc_preg_q(0) {
+FreeList::FreeList() : ckpt_free_map(N_CKPT), alloc_gnt_q(false), alloc_preg_q(0) {
     reset();
 }
 
-void FreeList::reset() {
+void FreeList::reset(int mapped) {
     free_map.reset();
     // Set P32-P127 as free (P0-P31 are reserved for architectural regs)
-    for (int i = N_ARCH_REGS; i < N_PHYS_REGS; i++) {
+    for (int i = mapped; i < N_PHYS_REGS; i++) {
         free_map.set(i);
     }
+    shares.fill(0);
     
-    for (int i = 0; i < ROB_DEPTH; i++) {
-        ckpt_free_map[i].free_map = free_map;
+    for (auto& snap : ckpt_free_map) {
+        snap.free_map = free_map;
+        snap.shares = shares;
     }
+    first_free = findFree();
 }
 
-void FreeList::tick(bool flush, bool recover, rob_tag_t recover_tag,
+void FreeList::tick(bool flush, bool recover, ckpt_t recover_ckpt,
                     bool alloc_req, bool free_req, preg_t free_preg,
-                    bool checkpoint_take, rob_tag_t checkpoint_tag) {
-    if (flush) {
+                    bool share_req, preg_t share_preg,
+                    bool checkpoint_take, ckpt_t checkpoint_id) {
+    bool do_free = free_req && free_preg != 0;
+    bool do_share = share_req && share_preg != 0;
+    
+    // Idle: no free, allocation, sharing or checkpoint, so only the grant drops
+    if (!do_free && !recover && !flush && !alloc_req && !do_share && !checkpoint_take) {
+        alloc_gnt_q = false;
         return;
     }
     
+    // Pick before this cycle's free, matching what rename saw
+    preg_t found_preg = first_free;
+    bool can_alloc = hasFree();
+    
+    // Free on commit. A committed free is visible to every younger
+    // checkpoint too, otherwise restoring one would leak the register.
+    // A shared preg only loses one mapping; the committing instruction
+    // is older than any live checkpoint, so each still counts it.
+    auto drop = [free_preg](std::bitset<N_PHYS_REGS>& map, std::array<uint8_t, N_PHYS_REGS>& sh) {
+        if (sh[free_preg] != 0) {
+            sh[free_preg]--;
+        } else {
+            map.set(free_preg);
+        }
+    };
+    bool freed = false;
+    if (do_free) {
+        freed = shares[free_preg] == 0;
+        drop(free_map, shares);
+        for (auto& snap : ckpt_free_map) {
+            drop(snap.free_map, snap.shares);
+        }
+    }
+    
     if (recover) {
-        free_map = ckpt_free_map[recover_tag].free_map;
+        free_map = ckpt_free_map[recover_ckpt].free_map;
+        shares = ckpt_free_map[recover_ckpt].shares;
+        first_free = findFree();
         return;
     }
     
-    // Free on commit
-    if (free_req && free_preg != 0) {
-        free_map.set(free_preg);
+    if (flush) {
+        if (freed) noteFreed(free_preg);
+        return;
     }
     
     // Allocate on rename
-    preg_t found_preg = findFree();
-    bool can_alloc = hasFree();
     alloc_gnt_q = alloc_req && can_alloc;
     
     if (alloc_gnt_q) {
         free_map.reset(found_preg);
         alloc_preg_q = found_preg;
     }
+    if (alloc_gnt_q || freed) {
+        first_free = findFree();
+    }
+    if (do_share) {
+        shares[share_preg]++;
+    }
     
-    // Checkpoint
+    // Checkpoint (free_map already reflects this cycle's free/alloc)
     if (checkpoint_take) {
-        auto next_map = free_map;
-        if (free_req && free_preg != 0) {
-            next_map.set(free_preg);
-        }
-        if (alloc_gnt_q) {
-            next_map.reset(found_preg);
-        }
-        ckpt_free_map[checkpoint_tag].free_map = next_map;
+        ckpt_free_map[checkpoint_id].free_map = free_map;
+        ckpt_free_map[checkpoint_id].shares = shares;
     }
 }
 
-bool FreeList::hasFree() const {
-    for (int i = N_ARCH_REGS; i < N_PHYS_REGS; i++) {
-        if (free_map.test(i)) return true;
-    }
-    return false;
-}
-
-preg_t FreeList::getAllocPreg() const {
-    return alloc_preg_q;
-}
-
 bool FreeList::getAllocGnt() const {
     return alloc_gnt_q;
 }
@@ -0,0 +1,413 @@
+#include "fuzz.h"
+#include "commit_check.h"
+#include "core_impl.h"
+#include "rv32i.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+// Feature map layout (bit offsets into the coverage bitmap)
+constexpr int F_ROB = 0;            // ROB count x {running, recovering, walking}
+constexpr int F_RS = 64;            // FU x RS occupancy x recovering
+constexpr int F_CKPT = 144;         // checkpoint slots busy x rename stalled
+constexpr int F_ISSUE = 192;        // issue port combination
+constexpr int F_WB = 208;           // writeback port combination
+constexpr int F_STORE_RECOVER = 224;    // cycles from a store to DMem to a recovery
+constexpr int F_RECOVER_GAP = 232;  // log2 cycles between recoveries
+constexpr int F_SQUASH = 240;       // instructions squashed by one recovery
+constexpr int F_FUSE = 264;         // fused pair committed, per rule
+constexpr int F_DISP_STALL = 272;   // dispatch stalled x ROB count
+constexpr int F_MISPREDICT = 296;   // mispredict while running / recovering / walking
+static_assert(F_MISPREDICT + 4 <= Fuzzer::N_FEATURES, "feature map overflow");
+
+using CoverageMap = std::array<uint64_t, Fuzzer::N_WORDS>;
+
+class FuzzCoverage : public NoObserver {
+private:
+    CoverageMap* map = nullptr;     // null: not collecting
+    uint64_t last_store = 0;        // cycle + 1 of the last store, 0 = none
+    uint64_t last_recover = 0;
+    int squashed = 0;
+    CycleRecord rec = {};
+
+    void hit(int f) { (*map)[f >> 6] |= 1ull << (f & 63); }
+
+public:
+    void attach(CoverageMap* m) {
+        map = m;
+        last_store = 0;
+        last_recover = 0;
+        squashed = 0;
+        rec = {};
+    }
+
+    void onStore(uint64_t cycle, rob_tag_t, uint32_t, uint32_t, LSSize) { last_store = cycle + 1; }
+
+    void onCommit(uint64_t, const CommitPkt& c) {
+        if (map && c.fuse != FuseRule::NONE) hit(F_FUSE + static_cast<int>(c.fuse));
+    }
+
+    void onRecover(uint64_t cycle, rob_tag_t, xlen_t) {
+        if (!map) return;
+        if (last_store && cycle + 1 - last_store < 8) hit(F_STORE_RECOVER + (cycle + 1 - last_store));
+        if (last_recover) {
+            int gap = 0;
+            for (uint64_t d = cycle + 1 - last_recover; d > 1 && gap < 7; d >>= 1) gap++;
+            hit(F_RECOVER_GAP + gap);
+        }
+        last_recover = cycle + 1;
+    }
+
+    void onSquash(uint64_t, rob_tag_t) { squashed++; }
+
+    void onCycle(const CycleRecord& r) {
+        rec = r;
+        if (!map) return;
+        int state = r.walking ? 2 : r.recover ? 1 : 0;
+        hit(F_ROB + state * (ROB_DEPTH + 1) + r.rob_count);
+        hit(F_ISSUE + (r.iss_alu | r.iss_bru << 1 | r.iss_lsu << 2 | r.iss_mdu << 3));
+        hit(F_WB + (r.wb_alu.valid | r.wb_bru.valid << 1 | r.wb_lsu.valid << 2 |
+                    r.wb_mdu.valid << 3));
+        if (r.recover) {
+            hit(F_SQUASH + std::min(squashed, 16));
+            squashed = 0;
+        }
+        if (r.disp_valid && !r.disp_ready) hit(F_DISP_STALL + r.rob_count);
+        if (r.mispredict) hit(F_MISPREDICT + state);
+    }
+
+    // Structures the events do not show, read after the clock edge
+    template <typename CoreT>
+    void sample(const CoreT& core) {
+        if (!map) return;
+        static constexpr FUType fus[] = {FUType::ALU, FUType::BRU, FUType::LSU, FUType::MDU};
+        for (int f = 0; f < 4; f++) {
+            hit(F_RS + (f * 2 + rec.recover) * (RS_DEPTH + 1) + core.getRSOccupancy(fus[f]));
+        }
+        bool ren_stall = rec.ren_valid && !rec.ren_ready;
+        hit(F_CKPT + ren_stall * (ROB_DEPTH + 1) + std::min(core.getCkptBusy(), ROB_DEPTH));
+    }
+};
+
+using FuzzCore = BasicCore<Observers<CommitChecker, FuzzCoverage>>;
+
+struct Outcome {
+    std::string what;               // empty: passed
+    uint64_t cycles;
+    uint64_t commits;
+};
+
+// Run one case to the final self-loop, collecting coverage into map if
+// given. The reference is the ISS: a0/a1 and the retired instruction
+// count come from a functional run of the same image.
+Outcome execute(FuzzCore& core, const FuzzCase& fc, const std::vector<uint32_t>& words,
+                CoverageMap* map) {
+    ISS ref;
+    ref.loadWords(words);
+    ref.run(1000000);
+
+    auto& checker = core.getObserver().get<CommitChecker>();
+    auto& cov = core.getObserver().get<FuzzCoverage>();
+    core.setRecoveryWalk(fc.walk);
+    core.setCkptSlots(fc.ckpt_slots);
+    core.setMulLatency(fc.mul_latency);
+    core.setRASDepth(fc.ras);
+    core.setFetchBuffer(fc.fetch_buffer);
+    for (int q = 0; q < N_STAGE_QUEUES; q++) {
+        core.setQueueDepth(static_cast<StageQueue>(q), fc.queues[q]);
+    }
+    core.setMoveElimination(fc.move_elim);
+    core.setFusion(fc.fuse);
+    core.loadProgramWords(words);
+    checker.loadProgramWords(words);
+    cov.attach(map);
+    core.reset();
+
+    // Worst case is about 40 cycles per instruction (a divide behind a
+    // recovery); anything far beyond that is a hang
+    uint64_t budget = 64 * ref.getInstCount() + 1000;
+    while (core.getCycleCount() < budget && !core.isHalted() && !checker.hasFailed()) {
+        core.tick();
+        cov.sample(core);
+    }
+
+    Outcome o = {"", core.getCycleCount(), core.getCommitCount()};
+    std::ostringstream os;
+    if (checker.hasFailed()) {
+        checker.report(os);
+    } else if (!core.isHalted()) {
+        os << "hang: no self-loop after " << budget << " cycles, " << core.getCommitCount()
+           << " commits (ISS " << ref.getInstCount() << ")";
+    } else if (core.getArchRegValue(10) != ref.getReg(10) ||
+               core.getArchRegValue(11) != ref.getReg(11)) {
+        os << std::hex << "result: a0=0x" << core.getArchRegValue(10) << " a1=0x"
+           << core.getArchRegValue(11) << ", expected a0=0x" << ref.getReg(10) << " a1=0x"
+           << ref.getReg(11);
+    }
+    o.what = os.str();
+    if (!o.what.empty() && o.what.back() == '\n') o.what.pop_back();
+    return o;
+}
+
+double uniformReal(std::mt19937& rng, double lo, double hi) {
+    return lo + (hi - lo) * std::generate_canonical<double, 32>(rng);
+}
+
+int uniformInt(std::mt19937& rng, int lo, int hi) {
+    return std::uniform_int_distribution<int>(lo, hi)(rng);
+}
+
+// Half the time a knob is off, else somewhere in (0, hi]
+double sometimes(std::mt19937& rng, double hi) {
+    return rng() & 1 ? uniformReal(rng, 0.05, hi) : 0.0;
+}
+
+uint32_t randomFuse(std::mt19937& rng) {
+    return rng() & 1 ? (rng() & ((1u << N_FUSE_RULES) - 2)) : 0;
+}
+
+} // namespace
+
+std::string FuzzCase::simArgs() const {
+    std::ostringstream os;
+    os << "--check-commits";
+    if (walk > 0) os << " --walk " << walk;
+    if (ckpt_slots != N_CKPT) os << " --ckpt-slots " << ckpt_slots;
+    if (ras > 0) os << " --ras " << ras;
+    if (fetch_buffer > 0) os << " --fetch-buffer " << fetch_buffer;
+    if (queues != std::array<int, N_STAGE_QUEUES>{1, 1, 1, 1}) {
+        os << " --queues ";
+        for (int q = 0; q < N_STAGE_QUEUES; q++) {
+            os << (q ? "," : "") << stageQueueName(static_cast<StageQueue>(q)) << "=" << queues[q];
+        }
+    }
+    if (move_elim) os << " --move-elim";
+    if (fuse != 0) {
+        os << " --fuse ";
+        const char* sep = "";
+        for (int r = 1; r < N_FUSE_RULES; r++) {
+            if (fuse & (1u << r)) {
+                os << sep << Decode::fuseRuleName(static_cast<FuseRule>(r));
+                sep = ",";
+            }
+        }
+    }
+    if (mul_latency != MDUFU::DEFAULT_MUL_LATENCY) os << " --mul-latency " << mul_latency;
+    return os.str();
+}
+
+Fuzzer::Fuzzer(const FuzzConfig& config)
+    : cfg(config), issued(0), done(0), cycles(0), commits(0), stop(false), host_sec(0) {
+    for (auto& w : coverage) w = 0;
+}
+
+int Fuzzer::getNumThreads() const {
+    if (cfg.threads > 0) return cfg.threads;
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+FuzzStats Fuzzer::getStats() const {
+    FuzzStats s = {};
+    s.programs = done;
+    s.cycles = cycles;
+    s.commits = commits;
+    for (const auto& w : coverage) s.coverage += __builtin_popcountll(w.load(std::memory_order_relaxed));
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        s.failures = failures.size();
+        s.corpus = static_cast<int>(corpus.size());
+    }
+    s.host_sec = host_sec;
+    return s;
+}
+
+bool Fuzzer::mergeCoverage(const CoverageMap& local) {
+    bool fresh = false;
+    for (int i = 0; i < N_WORDS; i++) {
+        if (local[i] & ~coverage[i].load(std::memory_order_relaxed)) {
+            uint64_t old = coverage[i].fetch_or(local[i], std::memory_order_relaxed);
+            fresh |= (local[i] & ~old) != 0;
+        }
+    }
+    return fresh;
+}
+
+FuzzCase Fuzzer::randomCase(std::mt19937& rng) {
+    FuzzCase fc;
+    GenConfig& g = fc.gen;
+    g.seed = rng();
+    g.length = uniformInt(rng, 48, 320);
+    g.chain_len = uniformInt(rng, 1, 8);
+    g.ilp = uniformInt(rng, 1, 4);
+    g.branch_freq = uniformReal(rng, 0.05, 0.45);
+    g.taken_rate = uniformReal(rng, 0.2, 0.9);
+    g.mem_ratio = uniformReal(rng, 0.1, 0.5);
+    g.store_ratio = uniformReal(rng, 0.2, 0.8);
+    g.alias_rate = uniformReal(rng, 0.0, 1.0);
+    g.muldiv_ratio = sometimes(rng, 0.4);
+    g.move_ratio = sometimes(rng, 0.4);
+    g.fuse_ratio = sometimes(rng, 0.6);
+    g.regs = uniformInt(rng, 3, 16);
+
+    static constexpr int walks[] = {0, 0, 1, 2, 4};
+    // Mostly pools small enough to fill (a stall at rename, slots freed
+    // by both resolve and recovery in one cycle)
+    static constexpr int ckpt_slots[] = {1, 2, 2, 3, 4, 6, N_CKPT};
+    static constexpr int ras_depths[] = {0, 2, 8};
+    static constexpr int fetch_buffers[] = {0, 1, 2, 4, 16};
+    fc.walk = walks[uniformInt(rng, 0, 4)];
+    fc.ckpt_slots = ckpt_slots[uniformInt(rng, 0, 6)];
+    fc.ras = ras_depths[uniformInt(rng, 0, 2)];
+    fc.fetch_buffer = fetch_buffers[uniformInt(rng, 0, 4)];
+    if (rng() & 1) {
+        for (int& d : fc.queues) d = 1 << uniformInt(rng, 0, 3);
+    }
+    fc.move_elim = rng() & 1;
+    fc.fuse = randomFuse(rng);
+    fc.mul_latency = uniformInt(rng, 1, MDUFU::MAX_MUL_LATENCY);
+    return fc;
+}
+
+FuzzCase Fuzzer::mutate(const FuzzCase& base, std::mt19937& rng) {
+    FuzzCase fc = base;
+    FuzzCase other = randomCase(rng);
+    if (rng() & 1) fc.gen.seed = other.gen.seed;
+    // Take one to three fields from a fresh case
+    for (int n = uniformInt(rng, 1, 3); n > 0; n--) {
+        switch (uniformInt(rng, 0, 19)) {
+            case 0:  fc.gen.length = other.gen.length; break;
+            case 1:  fc.gen.chain_len = other.gen.chain_len; break;
+            case 2:  fc.gen.ilp = other.gen.ilp; break;
+            case 3:  fc.gen.branch_freq = other.gen.branch_freq; break;
+            case 4:  fc.gen.taken_rate = other.gen.taken_rate; break;
+            case 5:  fc.gen.mem_ratio = other.gen.mem_ratio; break;
+            case 6:  fc.gen.store_ratio = other.gen.store_ratio; break;
+            case 7:  fc.gen.alias_rate = other.gen.alias_rate; break;
+            case 8:  fc.gen.muldiv_ratio = other.gen.muldiv_ratio; break;
+            case 9:  fc.gen.move_ratio = other.gen.move_ratio; break;
+            case 10: fc.gen.fuse_ratio = other.gen.fuse_ratio; break;
+            case 11: fc.gen.regs = other.gen.regs; break;
+            case 12: fc.walk = other.walk; break;
+            case 13: fc.ras = other.ras; break;
+            case 14: fc.move_elim = other.move_elim; break;
+            case 15: fc.fuse = other.fuse; break;
+            case 16: fc.fetch_buffer = other.fetch_buffer; break;
+            case 17: fc.queues = other.queues; break;
+            case 18: fc.ckpt_slots = other.ckpt_slots; break;
+            default: fc.mul_latency = other.mul_latency; break;
+        }
+    }
+    return fc;
+}
+
+std::string Fuzzer::check(const FuzzCase& fc, const std::vector<uint32_t>& words) {
+    FuzzCore core;
+    return execute(core, fc, words, nullptr).what;
+}
+
+std::vector<uint32_t> Fuzzer::minimize(const FuzzCase& fc, const std::vector<uint32_t>& words,
+                                       uint64_t max_runs, uint64_t& runs) {
+    // Chunks of halving size become NOPs if the case still fails without
+    // them; the final self-loop is kept so every candidate terminates
+    std::vector<uint32_t> best = words;
+    FuzzCore core;
+    runs = 0;
+    size_t n = best.size() > 1 ? best.size() - 1 : 0;
+    for (size_t chunk = std::max<size_t>(n / 2, 1); runs < max_runs; chunk /= 2) {
+        bool shrunk = false;
+        for (size_t begin = 0; begin < n && runs < max_runs; begin += chunk) {
+            size_t end = std::min(begin + chunk, n);
+            std::vector<uint32_t> cand = best;
+            bool changed = false;
+            for (size_t i = begin; i < end; i++) {
+                changed |= cand[i] != rv32::NOP;
+                cand[i] = rv32::NOP;
+            }
+            if (!changed) continue;
+            runs++;
+            if (!execute(core, fc, cand, nullptr).what.empty()) {
+                best = cand;
+                shrunk = true;
+            }
+        }
+        // Single instructions: repeat until nothing more can go
+        if (chunk == 1) {
+            if (!shrunk) break;
+            chunk = 2;
+        }
+    }
+    return best;
+}
+
+void Fuzzer::worker(int id) {
+    std::mt19937 rng(cfg.seed * 1000003u + id);
+    FuzzCore core;
+    CoverageMap local;
+    while (!stop.load(std::memory_order_relaxed)) {
+        if (cfg.programs && issued.fetch_add(1, std::memory_order_relaxed) >= cfg.programs) break;
+
+        // A fifth fresh cases, the rest mutations of cases that found coverage
+        FuzzCase fc;
+        bool fresh = true;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!corpus.empty() && uniformInt(rng, 0, 4) != 0) {
+                fc = mutate(corpus[uniformInt(rng, 0, static_cast<int>(corpus.size()) - 1)], rng);
+                fresh = false;
+            }
+        }
+        if (fresh) fc = randomCase(rng);
+
+        GenProgram prog = WorkloadGen(fc.gen).generate();
+        local.fill(0);
+        Outcome o = execute(core, fc, prog.words, &local);
+
+        if (!o.what.empty()) {
+            FuzzFailure f = {fc, prog.words, prog.words, o.what, 0};
+            if (cfg.minimize) f.minimized = minimize(fc, prog.words, cfg.minimize_runs, f.min_runs);
+            std::lock_guard<std::mutex> lock(mtx);
+            failures.push_back(f);
+            if (static_cast<int>(failures.size()) >= cfg.max_failures) stop = true;
+        } else {
+            cycles.fetch_add(o.cycles, std::memory_order_relaxed);
+            commits.fetch_add(o.commits, std::memory_order_relaxed);
+            if (mergeCoverage(local)) {
+                std::lock_guard<std::mutex> lock(mtx);
+                corpus.push_back(fc);
+            }
+        }
+        done.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Fuzzer::run(const std::function<void(const FuzzStats&)>& progress) {
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::vector<std::thread> pool;
+    std::atomic<int> running(getNumThreads());
+    for (int t = 0; t < getNumThreads(); t++) {
+        pool.emplace_back([this, t, &running]() {
+            worker(t);
+            running--;
+        });
+    }
+
+    double next_report = 1.0;
+    while (running > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        host_sec = elapsed();
+        if (cfg.seconds > 0 && host_sec >= cfg.seconds) stop = true;
+        if (progress && host_sec >= next_report) {
+            progress(getStats());
+            next_report += 1.0;
+        }
+    }
+    for (auto& t : pool) t.join();
+    host_sec = elapsed();
+}
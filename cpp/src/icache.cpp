@@ -54,6 +54,18 @@ bool ICache::loadProgram(const std::string& filename) {
     return true;
 }
 
+void ICache::loadWords(const std::vector<uint32_t>& words) {
+    mem.fill(0x00000013);
+    for (size_t i = 0; i < words.size() && i < DEPTH_WORDS; i++) {
+        mem[i] = words[i];
+    }
+}
+
+uint32_t ICache::peek(uint32_t addr) const {
+    uint32_t word_idx = addr >> 2;
+    return (word_idx < DEPTH_WORDS) ? mem[word_idx] : 0x00000013;
+}
+
 void ICache::tick(bool en, uint32_t addr) {
     if (en) {
         uint32_t word_idx = addr >> 2;
@@ -0,0 +1,234 @@
+#include "iss.h"
+#include "icache.h"
+
+ISS::ISS() {
+    imem.fill(0x00000013);
+    reset();
+}
+
+void ISS::reset() {
+    dmem.fill(0);
+    regs.fill(0);
+    pc = 0;
+    inst_count = 0;
+}
+
+bool ISS::loadProgram(const std::string& filename) {
+    // Same parser as the model's instruction memory
+    ICache ic;
+    if (!ic.loadProgram(filename)) {
+        return false;
+    }
+    for (int i = 0; i < IMEM_WORDS; i++) {
+        imem[i] = ic.peek(i * 4);
+    }
+    return true;
+}
+
+void ISS::loadWords(const std::vector<uint32_t>& words) {
+    imem.fill(0x00000013);
+    for (size_t i = 0; i < words.size() && i < IMEM_WORDS; i++) {
+        imem[i] = words[i];
+    }
+}
+
+uint32_t ISS::fetch(xlen_t addr) const {
+    uint32_t word_idx = addr >> 2;
+    return (word_idx < IMEM_WORDS) ? imem[word_idx] : 0x00000013;
+}
+
+ArchState ISS::getState() const {
+    ArchState s;
+    s.pc = pc;
+    s.regs = regs;
+    s.dmem.assign(dmem.begin(), dmem.end());
+    return s;
+}
+
+ISS::StepInfo ISS::step() {
+    return execute(fetch(pc));
+}
+
+ISS::StepInfo ISS::execute(uint32_t in) {
+    StepInfo s = {};
+    s.pc = pc;
+    s.instr = in;
+    s.next_pc = pc + 4;
+    
+    uint32_t op = in & 0x7F;
+    uint32_t f3 = (in >> 12) & 0x7;
+    uint32_t f7 = (in >> 25) & 0x7F;
+    reg_t rd = (in >> 7) & 0x1F;
+    xlen_t a = regs[(in >> 15) & 0x1F];
+    xlen_t b = regs[(in >> 20) & 0x1F];
+    
+    xlen_t imm_i = static_cast<xlen_t>(static_cast<int32_t>(in) >> 20);
+    xlen_t imm_s = static_cast<xlen_t>(((static_cast<int32_t>(in) >> 20) & ~0x1F) | ((in >> 7) & 0x1F));
+    xlen_t imm_b = static_cast<xlen_t>((static_cast<int32_t>(in & 0x80000000) >> 19) |
+                                       ((in << 4) & 0x800) | ((in >> 20) & 0x7E0) |
+                                       ((in >> 7) & 0x1E));
+    xlen_t imm_j = static_cast<xlen_t>((static_cast<int32_t>(in & 0x80000000) >> 11) |
+                                       (in & 0xFF000) | ((in >> 9) & 0x800) |
+                                       ((in >> 20) & 0x7FE));
+    
+    bool wr = false;
+    xlen_t val = 0;
+    
+    switch (op) {
+        case 0x37: // LUI
+            wr = true;
+            val = in & 0xFFFFF000;
+            break;
+            
+        case 0x6F: // JAL
+            wr = true;
+            val = pc + 4;
+            s.next_pc = pc + imm_j;
+            break;
+            
+        case 0x67: // JALR
+            wr = true;
+            val = pc + 4;
+            s.next_pc = (a + imm_i) & 0xFFFFFFFE;
+            break;
+            
+        case 0x63: { // BRANCH
+            bool taken = false;
+            switch (f3) {
+                case 0x0: taken = a == b; break;
+                case 0x1: taken = a != b; break;
+                case 0x4: taken = static_cast<int32_t>(a) < static_cast<int32_t>(b); break;
+                case 0x5: taken = static_cast<int32_t>(a) >= static_cast<int32_t>(b); break;
+                case 0x6: taken = a < b; break;
+                case 0x7: taken = a >= b; break;
+                default: break;
+            }
+            if (taken) s.next_pc = pc + imm_b;
+            break;
+        }
+            
+        case 0x03: // LOAD
+            wr = true;
+            val = (f3 == 0x4) ? load(a + imm_i, LSSize::B, true) : load(a + imm_i, LSSize::W, false);
+            break;
+            
+        case 0x23: // STORE
+            s.is_store = true;
+            s.store_addr = a + imm_s;
+            s.store_data = b;
+            s.store_size = (f3 == 0x1) ? LSSize::H : LSSize::W;
+            store(s.store_addr, b, s.store_size);
+            break;
+            
+        case 0x13: { // OP-IMM
+            wr = true;
+            uint32_t sh = imm_i & 0x1F;
+            switch (f3) {
+                case 0x6: val = a | imm_i; break;
+                case 0x7: val = a & imm_i; break;
+                case 0x3: val = (a < imm_i) ? 1 : 0; break;
+                case 0x5:
+                    val = (f7 == 0x20) ? static_cast<xlen_t>(static_cast<int32_t>(a) >> sh) : (a >> sh);
+                    break;
+                default: val = a + imm_i; break;
+            }
+            break;
+        }
+            
+        case 0x33: // OP
+            wr = true;
+            if (f7 == 0x01) {
+                val = mulDiv(f3, a, b);
+                break;
+            }
+            switch (f3) {
+                case 0x0: val = (f7 == 0x20) ? a - b : a + b; break;
+                case 0x7: val = a & b; break;
+                case 0x6: val = a | b; break;
+                case 0x5: val = static_cast<xlen_t>(static_cast<int32_t>(a) >> (b & 0x1F)); break;
+                default: val = a + b; break;
+            }
+            break;
+            
+        default:
+            // Unknown instruction - treat as NOP
+            break;
+    }
+    
+    if (wr && rd != 0) {
+        regs[rd] = val;
+        s.rd_written = true;
+        s.rd = rd;
+        s.rd_value = val;
+    }
+    
+    pc = s.next_pc;
+    inst_count++;
+    return s;
+}
+
+bool ISS::run(uint64_t max_insts) {
+    for (uint64_t i = 0; i < max_insts; i++) {
+        StepInfo s = step();
+        if (s.next_pc == s.pc) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t ISS::load(uint32_t addr, LSSize size, bool uns) const {
+    uint32_t word = dmem[(addr >> 2) & (DMEM_WORDS - 1)];
+    uint32_t off = addr & 0x3;
+    switch (size) {
+        case LSSize::B: {
+            uint32_t v = (word >> (off * 8)) & 0xFF;
+            return uns ? v : static_cast<uint32_t>(static_cast<int32_t>(v << 24) >> 24);
+        }
+        case LSSize::H: {
+            uint32_t v = (word >> ((off & 0x2) * 8)) & 0xFFFF;
+            return uns ? v : static_cast<uint32_t>(static_cast<int32_t>(v << 16) >> 16);
+        }
+        default:
+            return word;
+    }
+}
+
+void ISS::store(uint32_t addr, uint32_t data, LSSize size) {
+    uint32_t& word = dmem[(addr >> 2) & (DMEM_WORDS - 1)];
+    uint32_t off = addr & 0x3;
+    switch (size) {
+        case LSSize::B: {
+            uint32_t mask = 0xFFu << (off * 8);
+            word = (word & ~mask) | ((data & 0xFF) << (off * 8));
+            break;
+        }
+        case LSSize::H: {
+            uint32_t sh = (off & 0x2) * 8;
+            uint32_t mask = 0xFFFFu << sh;
+            word = (word & ~mask) | ((data & 0xFFFF) << sh);
+            break;
+        }
+        default:
+            word = data;
+            break;
+    }
+}
+
+xlen_t ISS::mulDiv(uint32_t f3, xlen_t a, xlen_t b) {
+    // 64-bit arithmetic covers MULH* and the DIV/REM overflow case
+    int64_t sa = static_cast<int32_t>(a);
+    int64_t sb = static_cast<int32_t>(b);
+    uint64_t ua = a;
+    uint64_t ub = b;
+    switch (f3) {
+        case 0x0: return a * b;
+        case 0x1: return static_cast<xlen_t>(static_cast<uint64_t>(sa * sb) >> 32);
+        case 0x2: return static_cast<xlen_t>(static_cast<uint64_t>(sa * static_cast<int64_t>(ub)) >> 32);
+        case 0x3: return static_cast<xlen_t>((ua * ub) >> 32);
+        case 0x4: return b == 0 ? 0xFFFFFFFF : static_cast<xlen_t>(sa / sb);
+        case 0x5: return b == 0 ? 0xFFFFFFFF : a / b;
+        case 0x6: return b == 0 ? a : static_cast<xlen_t>(sa % sb);
+        default:  return b == 0 ? a : a % b;
+    }
+}
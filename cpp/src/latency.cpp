@@ -0,0 +1,285 @@
+#include "latency.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const STAGE_NAMES[] = {"dispatch_ready", "ready_issue", "issue_wb", "wb_commit"};
+const char* const CLASS_NAMES[] = {"alu_reg", "alu_imm", "lui", "load", "store", "branch", "jump",
+                                   "mul", "div"};
+const char* const FU_NAMES[] = {"ALU", "BRU", "LSU", "MDU"};
+
+template <size_t N>
+int indexOf(const char* const (&names)[N], const std::string& s) {
+    for (size_t i = 0; i < N; i++) {
+        if (s == names[i]) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// LatencyHist
+// ---------------------------------------------------------------------------
+
+int LatencyHist::bucketOf(uint64_t v) {
+    int b = 0;
+    while (v != 0 && b < BUCKETS - 1) {
+        v >>= 1;
+        b++;
+    }
+    return b;
+}
+
+void LatencyHist::add(uint64_t v) {
+    buckets[bucketOf(v)]++;
+    count++;
+    sum += v;
+    max = std::max(max, v);
+}
+
+void LatencyHist::merge(const LatencyHist& o) {
+    for (int i = 0; i < BUCKETS; i++) {
+        buckets[i] += o.buckets[i];
+    }
+    count += o.count;
+    sum += o.sum;
+    max = std::max(max, o.max);
+}
+
+uint64_t LatencyHist::quantileBound(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(q * count);
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen > target) {
+            return i == 0 ? 0 : std::min<uint64_t>(max, (1ull << i) - 1);
+        }
+    }
+    return max;
+}
+
+// ---------------------------------------------------------------------------
+// Names
+// ---------------------------------------------------------------------------
+
+const char* latStageName(LatStage s) { return STAGE_NAMES[static_cast<int>(s)]; }
+const char* opClassName(OpClass c) { return CLASS_NAMES[static_cast<int>(c)]; }
+const char* fuTypeName(FUType fu) { return FU_NAMES[static_cast<int>(fu)]; }
+
+OpClass classifyOp(const RSEntry& e) {
+    if (e.is_load) return OpClass::LOAD;
+    if (e.is_store) return OpClass::STORE;
+    if (e.is_jump) return OpClass::JUMP;
+    if (e.is_branch) return OpClass::BRANCH;
+    if (e.fu_type == FUType::MDU) return e.alu_op >= ALUOp::DIV ? OpClass::DIV : OpClass::MUL;
+    if ((e.instr & 0x7F) == 0x37) return OpClass::LUI;
+    return e.imm_used ? OpClass::ALU_IMM : OpClass::ALU_REG;
+}
+
+// ---------------------------------------------------------------------------
+// LatencyStats
+// ---------------------------------------------------------------------------
+
+void LatencyStats::merge(const LatencyStats& o) {
+    for (int f = 0; f < N_FU; f++) {
+        for (int s = 0; s < N_STAGE; s++) {
+            by_fu[f][s].merge(o.by_fu[f][s]);
+        }
+    }
+    for (int c = 0; c < N_CLASS; c++) {
+        for (int s = 0; s < N_STAGE; s++) {
+            by_class[c][s].merge(o.by_class[c][s]);
+        }
+    }
+}
+
+void LatencyStats::write(std::ostream& os) const {
+    os << "# group,key,stage,count,sum,max";
+    for (int b = 0; b < LatencyHist::BUCKETS; b++) {
+        os << ",b" << b;
+    }
+    os << "\n";
+    auto row = [&](const char* group, const char* key, int s, const LatencyHist& h) {
+        os << group << "," << key << "," << STAGE_NAMES[s] << "," << h.count << ","
+           << h.sum << "," << h.max;
+        for (uint64_t n : h.buckets) {
+            os << "," << n;
+        }
+        os << "\n";
+    };
+    for (int f = 0; f < N_FU; f++) {
+        for (int s = 0; s < N_STAGE; s++) {
+            row("fu", FU_NAMES[f], s, by_fu[f][s]);
+        }
+    }
+    for (int c = 0; c < N_CLASS; c++) {
+        for (int s = 0; s < N_STAGE; s++) {
+            row("class", CLASS_NAMES[c], s, by_class[c][s]);
+        }
+    }
+}
+
+bool LatencyStats::read(std::istream& is) {
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::vector<std::string> f;
+        std::stringstream ss(line);
+        std::string tok;
+        while (std::getline(ss, tok, ',')) {
+            f.push_back(tok);
+        }
+        if (f.size() != 6 + LatencyHist::BUCKETS) {
+            return false;
+        }
+
+        int s = indexOf(STAGE_NAMES, f[2]);
+        LatencyHist* h = nullptr;
+        if (f[0] == "fu" && s >= 0) {
+            int i = indexOf(FU_NAMES, f[1]);
+            if (i >= 0) h = &by_fu[i][s];
+        } else if (f[0] == "class" && s >= 0) {
+            int i = indexOf(CLASS_NAMES, f[1]);
+            if (i >= 0) h = &by_class[i][s];
+        }
+        if (!h) {
+            return false;
+        }
+
+        LatencyHist o;
+        o.count = std::stoull(f[3]);
+        o.sum = std::stoull(f[4]);
+        o.max = std::stoull(f[5]);
+        for (int b = 0; b < LatencyHist::BUCKETS; b++) {
+            o.buckets[b] = std::stoull(f[6 + b]);
+        }
+        h->merge(o);
+    }
+    return true;
+}
+
+void LatencyStats::print(std::ostream& os) const {
+    os << "Latency per committed instruction, cycles: mean [p50 p90 bucket bound]" << std::endl;
+    os << std::left << std::setw(9) << "group" << std::right << std::setw(8) << "count";
+    for (int s = 0; s < N_STAGE; s++) {
+        os << std::setw(20) << STAGE_NAMES[s];
+    }
+    os << std::endl;
+
+    auto row = [&](const char* name, const std::array<LatencyHist, N_STAGE>& hs) {
+        if (hs[0].count == 0) {
+            return;
+        }
+        os << std::left << std::setw(9) << name << std::right << std::setw(8) << hs[0].count;
+        for (const LatencyHist& h : hs) {
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(2) << h.mean() << " ["
+                 << h.quantileBound(0.5) << " " << h.quantileBound(0.9) << "]";
+            os << std::setw(20) << cell.str();
+        }
+        os << std::endl;
+    };
+    for (int f = 0; f < N_FU; f++) {
+        row(FU_NAMES[f], by_fu[f]);
+    }
+    for (int c = 0; c < N_CLASS; c++) {
+        row(CLASS_NAMES[c], by_class[c]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// LatencyObserver
+// ---------------------------------------------------------------------------
+
+LatencyObserver::LatencyObserver() {
+    for (Inflight& i : inflight) {
+        i = {};
+    }
+}
+
+void LatencyObserver::onRename(uint64_t cycle, const RenamePkt& pkt) {
+    (void)cycle;
+    // An eliminated move shares its source's preg, which is pending
+    // (or not) on its own producer
+    if (pkt.rd_used && pkt.prd != 0 && !pkt.eliminated) {
+        pending.set(pkt.prd);
+    }
+}
+
+void LatencyObserver::onDispatch(uint64_t cycle, const RSEntry& entry) {
+    Inflight& i = inflight[entry.rob_tag];
+    i.valid = true;
+    i.fu = entry.fu_type;
+    i.cls = classifyOp(entry);
+    i.wait1 = (entry.rs1_used && pending.test(entry.prs1)) ? entry.prs1 : 0;
+    i.wait2 = (entry.rs2_used && pending.test(entry.prs2)) ? entry.prs2 : 0;
+    i.dispatch = cycle;
+    i.ready = (i.wait1 == 0 && i.wait2 == 0) ? cycle : NONE;
+    i.issue = NONE;
+    i.wb = NONE;
+}
+
+void LatencyObserver::onIssue(uint64_t cycle, const RSEntry& entry) {
+    Inflight& i = inflight[entry.rob_tag];
+    if (!i.valid) {
+        return;
+    }
+    i.issue = cycle;
+    if (i.ready == NONE) {
+        i.ready = cycle;
+    }
+}
+
+void LatencyObserver::onWriteback(uint64_t cycle, FUType fu, const WBPkt& wb) {
+    (void)fu;
+    if (inflight[wb.rob_tag].valid) {
+        inflight[wb.rob_tag].wb = cycle;
+    }
+    if (!wb.rd_used || wb.prd == 0) {
+        return;
+    }
+
+    // Wake up the operands waiting on this preg
+    pending.reset(wb.prd);
+    for (Inflight& i : inflight) {
+        if (!i.valid || i.ready != NONE) {
+            continue;
+        }
+        if (i.wait1 == wb.prd) i.wait1 = 0;
+        if (i.wait2 == wb.prd) i.wait2 = 0;
+        if (i.wait1 == 0 && i.wait2 == 0) {
+            i.ready = cycle;
+        }
+    }
+}
+
+void LatencyObserver::onCommit(uint64_t cycle, const CommitPkt& c) {
+    Inflight& i = inflight[c.rob_tag];
+    if (!i.valid || i.issue == NONE || i.wb == NONE) {
+        i.valid = false;
+        return;
+    }
+    std::array<uint64_t, LatencyStats::N_STAGE> d = {
+        i.ready - i.dispatch, i.issue - i.ready, i.wb - i.issue, cycle - i.wb
+    };
+    for (int s = 0; s < LatencyStats::N_STAGE; s++) {
+        stats.by_fu[static_cast<int>(i.fu)][s].add(d[s]);
+        stats.by_class[static_cast<int>(i.cls)][s].add(d[s]);
+    }
+    i.valid = false;
+}
+
+void LatencyObserver::onSquash(uint64_t cycle, rob_tag_t tag) {
+    (void)cycle;
+    inflight[tag].valid = false;
+}
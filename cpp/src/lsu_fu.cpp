@@ -0,0 +1,77 @@
+#include "lsu_fu.h"
+
+LSUFU::LSUFU() {
+    reset();
+}
+
+void LSUFU::reset() {
+    m0_q = {};
+    m1_q = {};
+    block_cnt = 0;
+}
+
+void LSUFU::tick(bool flush, const std::bitset<ROB_DEPTH>& live_tag,
+                 bool issue_valid, const RSEntry& entry,
+                 xlen_t src1, xlen_t src2) {
+    (void)src2;
+    
+    if (flush) {
+        // Block new requests while the pipeline drains, but let accesses
+        // older than the mispredicted branch complete (lsu_fu.sv drops
+        // them, which loses their writeback and hangs the ROB).
+        block_cnt = 2;
+        Meta m1_next = (m0_q.v && live_tag.test(m0_q.rob_tag)) ? m0_q : Meta{};
+        m0_q = {};
+        m1_q = m1_next;
+        return;
+    }
+    
+    if (block_cnt != 0) {
+        block_cnt--;
+    }
+    
+    // Stage 1 shift
+    m1_q = m0_q;
+    
+    // Stage 0 capture
+    m0_q = {};
+    if (getDMemEn(issue_valid) && entry.valid) {
+        m0_q.v = true;
+        m0_q.is_load = entry.is_load;
+        m0_q.rd_used = entry.rd_used;
+        m0_q.rob_tag = entry.rob_tag;
+        m0_q.prd = entry.prd;
+        m0_q.size = entry.ls_size;
+        m0_q.uns = entry.unsigned_load;
+        m0_q.off = getDMemAddr(entry, src1, src2) & 0x3;
+    }
+}
+
+WBPkt LSUFU::getWB(bool dmem_rvalid, uint32_t dmem_rdata) const {
+    WBPkt wb = {};
+    if (!m1_q.v || !dmem_rvalid) {
+        return wb;
+    }
+    
+    wb.valid = true;
+    wb.rob_tag = m1_q.rob_tag;
+    wb.rd_used = m1_q.is_load && m1_q.rd_used;
+    wb.prd = wb.rd_used ? m1_q.prd : 0;
+    wb.data = m1_q.is_load ? extractLoad(dmem_rdata, m1_q) : 0;
+    return wb;
+}
+
+uint32_t LSUFU::extractLoad(uint32_t rdata, const Meta& m) const {
+    switch (m.size) {
+        case LSSize::B: {
+            uint32_t b = (rdata >> (m.off * 8)) & 0xFF;
+            return m.uns ? b : static_cast<uint32_t>(static_cast<int32_t>(b << 24) >> 24);
+        }
+        case LSSize::H: {
+            uint32_t h = (rdata >> ((m.off & 0x2) * 8)) & 0xFFFF;
+            return m.uns ? h : static_cast<uint32_t>(static_cast<int32_t>(h << 16) >> 16);
+        }
+        default:
+            return rdata;
+    }
+}
@@ -1,52 +1,300 @@
-#include "core.h"
+#include "core_impl.h"
+#include "commit_check.h"
+#include "energy.h"
+#include "flight_recorder.h"
+#include "latency.h"
+#include "pipeview.h"
+#include "time_travel.h"
 #include <iostream>
 #include <string>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
 
 void printUsage(const char* prog) {
-    std::cerr << "Usage: " << prog << " <inst_mem_file.txt> [max_cycles]" << std::endl;
+    std::cerr << "Usage: " << prog << " <inst_mem_file.txt> [max_cycles] [expected.txt] [options]" << std::endl;
     std::cerr << "  inst_mem_file.txt: Instruction memory file (byte format)" << std::endl;
     std::cerr << "  max_cycles: Maximum cycles to run (default: 20000)" << std::endl;
+    std::cerr << "  expected.txt: Listing ending in '# a0 = N' / '# a1 = N' to check against" << std::endl;
+    std::cerr << "  --pipeview FILE    Write a gem5 O3PipeView / Konata pipeline trace" << std::endl;
+    std::cerr << "  --pv-cycles A:B    Only instructions fetched in cycles [A, B)" << std::endl;
+    std::cerr << "  --pv-insts A:B     Only sequence numbers [A, B) (first fetch is 1)" << std::endl;
+    std::cerr << "  --latency FILE     Per-stage latency histograms, printed and written as CSV" << std::endl;
+    std::cerr << "  --latency-merge    Add FILE's existing histograms before writing it" << std::endl;
+    std::cerr << "  --walk W           ROB-walk recovery, W entries/cycle (default: snapshot restore)" << std::endl;
+    std::cerr << "  --ckpt-slots N     Branch checkpoint slots, 1-" << N_CKPT << " (default: " << N_CKPT << ", never stalls)" << std::endl;
+    std::cerr << "  --mul-latency N    RV32M multiplier latency, 1-8 cycles (default: 3)" << std::endl;
+    std::cerr << "  --ras N            predict JAL/JALR at fetch, N-entry return address stack (1-32)" << std::endl;
+    std::cerr << "  --fetch-buffer N   Decoupled fetch, one ICache request per cycle into an" << std::endl;
+    std::cerr << "                     N-entry instruction buffer (1-16; default: RTL fetch FSM)" << std::endl;
+    std::cerr << "  --queues SPEC      Inter-stage queue depths, 1-8: N for all, or a comma list of" << std::endl;
+    std::cerr << "                     f2d=N, d2r=N, r2d=N, disp=N (default: 1); prints occupancy" << std::endl;
+    std::cerr << "  --move-elim        Complete moves and zero idioms at rename" << std::endl;
+    std::cerr << "  --fuse RULES       Macro-op fusion in decode: 'all' or a comma list of" << std::endl;
+    std::cerr << "                     lui-addi, const-jalr, alu-branch, add-load" << std::endl;
+    std::cerr << "  --energy           Per-structure access counts, energy and average power" << std::endl;
+    std::cerr << "  --energy-table F   pJ per access ('event,pJ' rows, 'clock_ghz,F'); implies --energy" << std::endl;
+    std::cerr << "  --check-commits    Step the ISS at every commit, stop at the first mismatch" << std::endl;
+    std::cerr << "  --debug            Read time-travel commands from stdin (run, step, goto, back," << std::endl;
+    std::cerr << "                     state, regs, mem, snaps, hash, quit); no observers" << std::endl;
+    std::cerr << "  --snap-every K     With --debug: snapshot every K cycles (default: 1000)" << std::endl;
+    std::cerr << "  --snap-max N       With --debug: keep at most N snapshots (default: 32)" << std::endl;
+    std::cerr << "  --flight N         Keep the last N cycles, dump them if the run fails or stalls" << std::endl;
+    std::cerr << "  --flight-file FILE Flight recorder dump (default: core_cycle_dump.log)" << std::endl;
+    std::cerr << "  --stall-limit N    With --flight: stop after N cycles without a commit (default: 200, 0: off)" << std::endl;
 }
 
-int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        printUsage(argv[0]);
-        return 1;
+// "A:B" -> [A, B); either side may be empty
+bool parseWindow(const std::string& s, uint64_t& begin, uint64_t& end) {
+    size_t colon = s.find(':');
+    if (colon == std::string::npos) {
+        return false;
+    }
+    if (colon > 0) begin = std::stoull(s.substr(0, colon));
+    if (colon + 1 < s.size()) end = std::stoull(s.substr(colon + 1));
+    return true;
+}
+
+// "all" or "rule,rule,..." (Decode::fuseRuleName) -> bit (1 << FuseRule) each
+bool parseFuseRules(const std::string& s, uint32_t& rules) {
+    rules = 0;
+    if (s == "all") {
+        for (int r = 1; r < N_FUSE_RULES; r++) rules |= 1u << r;
+        return true;
+    }
+    size_t begin = 0;
+    while (begin <= s.size()) {
+        size_t comma = s.find(',', begin);
+        std::string name = s.substr(begin, comma == std::string::npos ? std::string::npos : comma - begin);
+        int r = 1;
+        while (r < N_FUSE_RULES && name != Decode::fuseRuleName(static_cast<FuseRule>(r))) r++;
+        if (r == N_FUSE_RULES) {
+            return false;
+        }
+        rules |= 1u << r;
+        if (comma == std::string::npos) break;
+        begin = comma + 1;
+    }
+    return true;
+}
+
+// "N" (every queue) or "name=N,..." (stageQueueName) -> depths
+bool parseQueueDepths(const std::string& s, std::array<int, N_STAGE_QUEUES>& depths) {
+    auto valid = [](int d) { return d >= 1 && d <= MAX_STAGE_QUEUE_DEPTH; };
+    if (s.find('=') == std::string::npos) {
+        int d = std::stoi(s);
+        depths.fill(d);
+        return valid(d);
+    }
+    size_t begin = 0;
+    while (begin <= s.size()) {
+        size_t comma = s.find(',', begin);
+        std::string item = s.substr(begin, comma == std::string::npos ? std::string::npos : comma - begin);
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) {
+            return false;
+        }
+        int q = 0;
+        while (q < N_STAGE_QUEUES && item.substr(0, eq) != stageQueueName(static_cast<StageQueue>(q))) q++;
+        if (q == N_STAGE_QUEUES) {
+            return false;
+        }
+        depths[q] = std::stoi(item.substr(eq + 1));
+        if (!valid(depths[q])) {
+            return false;
+        }
+        if (comma == std::string::npos) break;
+        begin = comma + 1;
+    }
+    return true;
+}
+
+// Read the expected a0/a1 (signed decimal) from a trace listing
+bool loadExpected(const std::string& filename, int32_t& a0, int32_t& a1) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Could not open expected file: " << filename << std::endl;
+        return false;
     }
     
-    std::string inst_file = argv[1];
-    uint64_t max_cycles = 20000;
+    bool have_a0 = false, have_a1 = false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind("# a0 = ", 0) == 0) {
+            a0 = static_cast<int32_t>(std::stoll(line.substr(7)));
+            have_a0 = true;
+        } else if (line.rfind("# a1 = ", 0) == 0) {
+            a1 = static_cast<int32_t>(std::stoll(line.substr(7)));
+            have_a1 = true;
+        }
+    }
     
-    if (argc >= 3) {
-        max_cycles = std::stoull(argv[2]);
+    if (!have_a0 || !have_a1) {
+        std::cerr << "ERROR: No '# a0 = ' / '# a1 = ' lines in " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+// Core knobs from the command line; the defaults are the RTL configuration
+struct CoreOptions {
+    int walk = 0;
+    int ckpt_slots = N_CKPT;
+    int mul_latency = MDUFU::DEFAULT_MUL_LATENCY;
+    int ras = 0;
+    int fetch_buffer = 0;
+    std::array<int, N_STAGE_QUEUES> queues = {1, 1, 1, 1};
+    bool queue_stats = false;       // --queues given
+    bool move_elim = false;
+    uint32_t fuse = 0;
+};
+
+// Load the program, apply the knobs and reset; false if the program
+// could not be loaded
+template <typename CoreT>
+bool setup(CoreT& core, const std::string& inst_file, const CoreOptions& opt) {
+    if (!core.loadProgram(inst_file)) {
+        std::cerr << "ERROR: Failed to load program" << std::endl;
+        return false;
     }
     
+    core.setRecoveryWalk(opt.walk);
+    core.setCkptSlots(opt.ckpt_slots);
+    core.setMulLatency(opt.mul_latency);
+    core.setRASDepth(opt.ras);
+    core.setFetchBuffer(opt.fetch_buffer);
+    for (int q = 0; q < N_STAGE_QUEUES; q++) {
+        core.setQueueDepth(static_cast<StageQueue>(q), opt.queues[q]);
+    }
+    core.setMoveElimination(opt.move_elim);
+    core.setFusion(opt.fuse);
+    core.reset();
+    return true;
+}
+
+// after_run(result_ok) reports anything the core's observer collected;
+// result_ok is false if the a0/a1 check will fail. Returning false fails the run.
+// A non-null energy table adds the energy report.
+template <typename CoreT, typename AfterRun>
+int simulate(CoreT& core, const std::string& inst_file, uint64_t max_cycles,
+             const CoreOptions& opt, const EnergyTable* energy, bool check, int32_t exp_a0, int32_t exp_a1, AfterRun&& after_run) {
     std::cout << "============================================================" << std::endl;
     std::cout << "OOOP C++ Model" << std::endl;
     std::cout << "============================================================" << std::endl;
     std::cout << "Instruction file: " << inst_file << std::endl;
     std::cout << "Max cycles: " << max_cycles << std::endl;
+    if (opt.walk > 0) {
+        std::cout << "Recovery: ROB walk, " << opt.walk << " entries/cycle" << std::endl;
+    }
+    if (opt.mul_latency != MDUFU::DEFAULT_MUL_LATENCY) {
+        std::cout << "Multiplier latency: " << opt.mul_latency << " cycles" << std::endl;
+    }
+    if (opt.ras > 0) {
+        std::cout << "Fetch prediction: JAL/JALR, " << opt.ras << "-entry RAS" << std::endl;
+    }
+    if (opt.fetch_buffer > 0) {
+        std::cout << "Fetch: decoupled, " << opt.fetch_buffer << "-entry instruction buffer" << std::endl;
+    }
+    if (opt.queue_stats) {
+        std::cout << "Stage queues:";
+        for (int q = 0; q < N_STAGE_QUEUES; q++) {
+            std::cout << " " << stageQueueName(static_cast<StageQueue>(q)) << "=" << opt.queues[q];
+        }
+        std::cout << std::endl;
+    }
+    if (opt.move_elim) {
+        std::cout << "Rename: move and zero-idiom elimination" << std::endl;
+    }
+    if (opt.fuse != 0) {
+        std::cout << "Decode: macro-op fusion";
+        for (int r = 1; r < N_FUSE_RULES; r++) {
+            if (opt.fuse & (1u << r)) std::cout << " " << Decode::fuseRuleName(static_cast<FuseRule>(r));
+        }
+        std::cout << std::endl;
+    }
     std::cout << std::endl;
     
-    Core core;
-    
-    if (!core.loadProgram(inst_file)) {
-        std::cerr << "ERROR: Failed to load program" << std::endl;
+    if (!setup(core, inst_file, opt)) {
         return 1;
     }
-    
-    core.reset();
     core.run(max_cycles);
     
+    // Print a0 (x10) and a1 (x11)
+    uint32_t a0 = core.getArchRegValue(10);
+    uint32_t a1 = core.getArchRegValue(11);
+    bool result_ok = static_cast<int32_t>(a0) == exp_a0 && static_cast<int32_t>(a1) == exp_a1;
+    bool observed_ok = after_run(!check || result_ok);
+    if (energy) {
+        energy->report(std::cout, core.getActivity(), core.getCycleCount(), core.getCommitCount());
+    }
+    
     std::cout << std::endl;
     std::cout << "============================================================" << std::endl;
     std::cout << "FINAL RESULTS @ cycle=" << core.getCycleCount()
               << " commits=" << core.getCommitCount() << std::endl;
-    
-    // Print a0 (x10) and a1 (x11)
-    uint32_t a0 = core.getArchRegValue(10);
-    uint32_t a1 = core.getArchRegValue(11);
+    std::cout << "checkpoint slots=" << core.getCkptSlots()
+              << " pool-full stall cycles=" << core.getCkptStallCount() << std::endl;
+    std::cout << "recoveries=" << core.getRecoverCount();
+    if (opt.walk > 0) {
+        std::cout << " walk cycles=" << core.getWalkCycles()
+                  << " rename stalled by walk=" << core.getWalkStallCount();
+    }
+    std::cout << std::endl;
+    if (opt.ras > 0) {
+        // correct/resolved per kind
+        const BranchPred::Stats& ps = core.getPredStats();
+        std::cout << "fetch predict: calls=" << ps.calls - ps.call_miss << "/" << ps.calls
+                  << " returns=" << ps.returns - ps.return_miss << "/" << ps.returns
+                  << " indirect=" << ps.indirect - ps.indirect_miss << "/" << ps.indirect
+                  << " jumps=" << ps.jumps - ps.jump_miss << "/" << ps.jumps << std::endl;
+    }
+    if (opt.fetch_buffer > 0) {
+        const Fetch::BufferStats& fs = core.getFetchBufferStats();
+        double n = static_cast<double>(std::max<uint64_t>(fs.cycles, 1));
+        std::ios::fmtflags flags = std::cout.flags();
+        std::streamsize prec = std::cout.precision();
+        std::cout << std::fixed << std::setprecision(2) << "fetch buffer: avg occupancy "
+                  << fs.occupancy_sum / n << "/" << opt.fetch_buffer << " empty="
+                  << std::setprecision(1) << 100.0 * fs.empty / n << "% full="
+                  << 100.0 * fs.full / n << "% squashed=" << fs.squashed << std::endl;
+        std::cout.flags(flags);
+        std::cout.precision(prec);
+    }
+    if (opt.queue_stats) {
+        // cycles holding 0..depth entries
+        std::ios::fmtflags flags = std::cout.flags();
+        std::streamsize prec = std::cout.precision();
+        for (int q = 0; q < N_STAGE_QUEUES; q++) {
+            StageQueue sq = static_cast<StageQueue>(q);
+            const StageQueueHistogram& h = core.getQueueOccupancy(sq);
+            int depth = core.getQueueDepth(sq);
+            uint64_t n = 0, sum = 0;
+            for (int k = 0; k <= depth; k++) {
+                n += h[k];
+                sum += k * h[k];
+            }
+            double cycles = static_cast<double>(std::max<uint64_t>(n, 1));
+            std::cout << "queue " << stageQueueName(sq) << ": " << std::fixed << std::setprecision(2)
+                      << "avg occupancy " << sum / cycles << "/" << depth << std::setprecision(1)
+                      << " full=" << 100.0 * h[depth] / cycles << "% cycles";
+            for (int k = 0; k <= depth; k++) std::cout << " " << k << ":" << h[k];
+            std::cout << std::endl;
+        }
+        std::cout.flags(flags);
+        std::cout.precision(prec);
+    }
+    if (opt.move_elim) {
+        std::cout << "eliminated at rename: moves=" << core.getElimMoveCount()
+                  << " zero idioms=" << core.getElimZeroCount() << std::endl;
+    }
+    if (opt.fuse != 0) {
+        std::cout << "fused pairs:";
+        for (int r = 1; r < N_FUSE_RULES; r++) {
+            FuseRule rule = static_cast<FuseRule>(r);
+            std::cout << " " << Decode::fuseRuleName(rule) << "=" << core.getFuseCount(rule);
+        }
+        std::cout << std::endl;
+    }
     
     std::cout << "a0 (x10) = 0x" << std::hex << std::setw(8) << std::setfill('0')
               << a0 << " (" << std::dec << static_cast<int32_t>(a0) << ")" << std::endl;
@@ -54,5 +302,388 @@ int main(int argc, char* argv[]) {
               << a1 << " (" << std::dec << static_cast<int32_t>(a1) << ")" << std::endl;
     std::cout << "============================================================" << std::endl;
     
-    return 0;
+    if (check) {
+        bool pass = observed_ok && result_ok;
+        std::cout << "CHECK " << (pass ? "PASS" : "FAIL") << " (expected a0=" << exp_a0
+                  << " a1=" << exp_a1 << ")" << std::endl;
+        return pass ? 0 : 1;
+    }
+    
+    return observed_ok ? 0 : 1;
+}
+
+// --debug: time-travel commands, one per line, on a Core. Every command
+// that moves prints the state line; run without a count runs to
+// max_cycles. Returns 1 if any command failed.
+int debugSession(std::istream& cmds, const std::string& inst_file, uint64_t max_cycles,
+                 const CoreOptions& opt, uint64_t snap_every, int snap_max) {
+    Core core;
+    if (!setup(core, inst_file, opt)) {
+        return 1;
+    }
+    TimeTravel tt(core, snap_every, snap_max);
+    std::cout << "Time travel: snapshot every " << tt.getInterval() << " cycles, at most "
+              << tt.getMaxSnapshots() << " kept (" << tt.getSnapshotBytes() / 1024 << " KiB each)" << std::endl;
+    
+    auto printState = [&]() {
+        std::cout << "cycle=" << core.getCycleCount() << " commits=" << core.getCommitCount()
+                  << " recoveries=" << core.getRecoverCount() << " last_pc=0x" << std::hex
+                  << std::setw(8) << std::setfill('0') << core.getLastCommitPC() << std::dec
+                  << std::setfill(' ') << " rob=" << core.getROBCount() << " rs="
+                  << core.getRSOccupancy(FUType::ALU) << "/" << core.getRSOccupancy(FUType::BRU) << "/"
+                  << core.getRSOccupancy(FUType::LSU) << "/" << core.getRSOccupancy(FUType::MDU)
+                  << " halted=" << (core.isHalted() ? "yes" : "no") << std::endl;
+    };
+    
+    bool ok = true;
+    std::string line;
+    while (std::getline(cmds, line)) {
+        std::istringstream in(line);
+        std::string cmd, arg;
+        if (!(in >> cmd) || cmd[0] == '#') {
+            continue;
+        }
+        bool has_arg = static_cast<bool>(in >> arg);
+        uint64_t n = 0;
+        try {
+            if (has_arg) n = std::stoull(arg, nullptr, 0);
+        } catch (const std::exception&) {
+            std::cerr << "ERROR: bad number '" << arg << "'" << std::endl;
+            ok = false;
+            continue;
+        }
+        uint64_t now = core.getCycleCount();
+        
+        if (cmd == "quit" || cmd == "exit") {
+            break;
+        } else if (cmd == "run" || cmd == "step") {
+            tt.run(has_arg ? n : cmd == "step" ? 1 : max_cycles > now ? max_cycles - now : 0);
+            printState();
+        } else if ((cmd == "goto" || cmd == "back") && has_arg) {
+            bool moved = cmd == "goto" ? tt.gotoCycle(n) : tt.stepBack(n);
+            if (!moved) {
+                std::cerr << "ERROR: cycle " << (cmd == "goto" ? n : n > now ? 0 : now - n)
+                          << " is before the oldest snapshot (cycle " << tt.getSnapshotCycle(0)
+                          << ")" << std::endl;
+                ok = false;
+                continue;
+            }
+            printState();
+        } else if (cmd == "state") {
+            printState();
+        } else if (cmd == "regs") {
+            for (reg_t r = 0; r < N_ARCH_REGS; r++) {
+                std::cout << "x" << std::left << std::setw(2) << static_cast<int>(r) << std::right
+                          << " = 0x" << std::hex << std::setw(8) << std::setfill('0')
+                          << core.getArchRegValue(r) << std::dec << std::setfill(' ')
+                          << ((r % 4 == 3) ? "\n" : "   ");
+            }
+        } else if (cmd == "mem" && has_arg) {
+            uint32_t addr = static_cast<uint32_t>(n) & ~3u;
+            std::cout << "mem[0x" << std::hex << std::setw(8) << std::setfill('0') << addr
+                      << "] = 0x" << std::setw(8) << core.readMemWord(addr) << std::dec
+                      << std::setfill(' ') << std::endl;
+        } else if (cmd == "snaps") {
+            std::cout << "snapshots: " << tt.getSnapshotCount() << " (" << tt.getSnapshotBytes() / 1024
+                      << " KiB), cycles";
+            for (size_t i = 0; i < tt.getSnapshotCount(); i++) std::cout << " " << tt.getSnapshotCycle(i);
+            std::cout << std::endl;
+        } else if (cmd == "hash") {
+            std::cout << "cycle=" << core.getCycleCount() << " hash=0x" << std::hex << std::setw(16)
+                      << std::setfill('0') << TimeTravel::hashState(core) << std::dec
+                      << std::setfill(' ') << std::endl;
+        } else {
+            std::cerr << "ERROR: unknown command '" << line << "'" << std::endl;
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> pos;
+    std::string pipeview_file;
+    PipeViewConfig pv_cfg;
+    std::string latency_file;
+    bool latency_merge = false;
+    CoreOptions opt;
+    bool check_commits = false;
+    bool debug = false;
+    uint64_t snap_every = TimeTravel::DEFAULT_INTERVAL;
+    int snap_max = TimeTravel::DEFAULT_MAX_SNAPSHOTS;
+    EnergyTable energy;
+    bool energy_report = false;
+    size_t flight = 0;
+    std::string flight_file = "core_cycle_dump.log";
+    uint64_t stall_limit = 200;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool has_value = i + 1 < argc;
+        if (a == "--pipeview" && has_value) {
+            pipeview_file = argv[++i];
+        } else if (a == "--pv-cycles" && has_value) {
+            if (!parseWindow(argv[++i], pv_cfg.cycle_begin, pv_cfg.cycle_end)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (a == "--pv-insts" && has_value) {
+            if (!parseWindow(argv[++i], pv_cfg.seq_begin, pv_cfg.seq_end)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (a == "--latency" && has_value) {
+            latency_file = argv[++i];
+        } else if (a == "--latency-merge") {
+            latency_merge = true;
+        } else if (a == "--walk" && has_value) {
+            opt.walk = std::stoi(argv[++i]);
+            if (opt.walk < 1 || opt.walk > ROB_DEPTH) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (a == "--ckpt-slots" && has_value) {
+            opt.ckpt_slots = std::stoi(argv[++i]);
+            if (opt.ckpt_slots < 1 || opt.ckpt_slots > N_CKPT) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (a == "--mul-latency" && has_value) {
+            opt.mul_latency = std::stoi(argv[++i]);
+            if (opt.mul_latency < 1 || opt.mul_latency > MDUFU::MAX_MUL_LATENCY) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (a == "--ras" && has_value) {
+            opt.ras = std::stoi(argv[++i]);
+            if (opt.ras < 1 || opt.ras > BranchPred::MAX_RAS_DEPTH) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (a == "--fetch-buffer" && has_value) {
+            opt.fetch_buffer = std::stoi(argv[++i]);
+            if (opt.fetch_buffer < 1 || opt.fetch_buffer > Fetch::MAX_BUFFER_DEPTH) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (a == "--queues" && has_value) {
+            if (!parseQueueDepths(argv[++i], opt.queues)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            opt.queue_stats = true;
+        } else if (a == "--move-elim") {
+            opt.move_elim = true;
+        } else if (a == "--fuse" && has_value) {
+            if (!parseFuseRules(argv[++i], opt.fuse)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (a == "--energy") {
+            energy_report = true;
+        } else if (a == "--energy-table" && has_value) {
+            std::string file = argv[++i];
+            std::ifstream in(file);
+            std::string err;
+            if (!in) {
+                std::cerr << "ERROR: Could not open " << file << std::endl;
+                return 1;
+            }
+            if (!energy.read(in, err)) {
+                std::cerr << "ERROR: " << file << ": bad energy table row '" << err << "'" << std::endl;
+                return 1;
+            }
+            energy_report = true;
+        } else if (a == "--check-commits") {
+            check_commits = true;
+        } else if (a == "--debug") {
+            debug = true;
+        } else if (a == "--snap-every" && has_value) {
+            snap_every = std::stoull(argv[++i]);
+            if (snap_every < 1) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (a == "--snap-max" && has_value) {
+            snap_max = std::stoi(argv[++i]);
+            if (snap_max < TimeTravel::MIN_SNAPSHOTS) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (a == "--flight" && has_value) {
+            flight = std::stoul(argv[++i]);
+        } else if (a == "--flight-file" && has_value) {
+            flight_file = argv[++i];
+        } else if (a == "--stall-limit" && has_value) {
+            stall_limit = std::stoull(argv[++i]);
+        } else if (a.rfind("--", 0) == 0) {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            pos.push_back(a);
+        }
+    }
+    
+    if (pos.empty() || pos.size() > 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    std::string inst_file = pos[0];
+    uint64_t max_cycles = 20000;
+    
+    if (pos.size() >= 2) {
+        max_cycles = std::stoull(pos[1]);
+    }
+    
+    int32_t exp_a0 = 0, exp_a1 = 0;
+    bool check = pos.size() >= 3;
+    if (check && !loadExpected(pos[2], exp_a0, exp_a1)) {
+        return 1;
+    }
+    
+    const EnergyTable* energy_ptr = energy_report ? &energy : nullptr;
+    bool pv = !pipeview_file.empty();
+    bool lat = !latency_file.empty();
+    if (debug) {
+        if (pv || lat || check_commits || flight > 0) {
+            std::cerr << "ERROR: --debug runs without observers (--pipeview, --latency, "
+                      << "--check-commits, --flight)" << std::endl;
+            return 1;
+        }
+        return debugSession(std::cin, inst_file, max_cycles, opt, snap_every, snap_max);
+    }
+    if (!pv && !lat && !check_commits && flight == 0) {
+        Core core;
+        return simulate(core, inst_file, max_cycles, opt, energy_ptr, check, exp_a0, exp_a1,
+                        [](bool) { return true; });
+    }
+    
+    // Observed runs: the pipeline view streams records while the core runs
+    std::ofstream pv_out;
+    if (pv) {
+        pv_out.open(pipeview_file);
+        if (!pv_out) {
+            std::cerr << "ERROR: Could not open " << pipeview_file << std::endl;
+            return 1;
+        }
+    }
+    auto reportPipeView = [&](PipeView& view) {
+        view.close();
+        std::cout << "Pipeline view: " << view.getWritten()
+                  << " instructions written to " << pipeview_file << std::endl;
+    };
+    auto reportLatency = [&](const LatencyObserver& obs) {
+        LatencyStats stats = obs.getStats();
+        stats.print(std::cout);
+        if (latency_merge) {
+            std::ifstream in(latency_file);
+            if (in && !stats.read(in)) {
+                std::cerr << "WARNING: " << latency_file << " is not a latency CSV, overwriting" << std::endl;
+                stats = obs.getStats();
+            }
+        }
+        std::ofstream out(latency_file);
+        stats.write(out);
+        if (!out) {
+            std::cerr << "ERROR: Could not write " << latency_file << std::endl;
+        }
+    };
+    auto reportChecker = [&](const CommitChecker& chk) {
+        if (!check_commits) {
+            return true;
+        }
+        chk.report(std::cout);
+        return !chk.hasFailed();
+    };
+    // Dump the flight recorder if the run failed, stalled or was
+    // interrupted; false if that should fail the run
+    auto reportFlight = [&](const FlightRecorder& rec, const char* failure) {
+        std::string reason;
+        if (FlightRecorder::interrupted()) {
+            reason = "signal";
+        } else if (rec.timedOut()) {
+            reason = "timeout: no commits for " + std::to_string(rec.getStallLimit()) + " cycles";
+        } else if (failure) {
+            reason = failure;
+        }
+        if (reason.empty()) {
+            return true;
+        }
+        if (flight == 0) {
+            return false;
+        }
+        if (rec.dump(flight_file, reason)) {
+            std::cout << "Flight recorder: last " << rec.getHeld() << " cycles (" << reason
+                      << ") written to " << flight_file << std::endl;
+        } else {
+            std::cerr << "ERROR: Could not write " << flight_file << std::endl;
+        }
+        return false;
+    };
+    auto failureOf = [](bool checker_ok, bool result_ok) -> const char* {
+        return !checker_ok ? "commit mismatch" : !result_ok ? "a0/a1 check failed" : nullptr;
+    };
+    
+    if (check_commits && !pv && !lat && flight == 0) {
+        BasicCore<CommitChecker> core;
+        if (!core.getObserver().loadProgram(inst_file)) {
+            std::cerr << "ERROR: Failed to load program" << std::endl;
+            return 1;
+        }
+        return simulate(core, inst_file, max_cycles, opt, energy_ptr, check, exp_a0, exp_a1,
+                        [&](bool) { return reportChecker(core.getObserver()); });
+    }
+    if (check_commits || flight > 0) {
+        // The checker only checks once loaded; an unopened pv_out discards
+        // the pipeline view's records
+        using Checked = Observers<CommitChecker, FlightRecorder>;
+        using All = Observers<PipeView, LatencyObserver, CommitChecker, FlightRecorder>;
+        FlightRecorder recorder(flight, flight > 0 ? stall_limit : 0);
+        auto run = [&](auto& core) {
+            auto& obs = core.getObserver();
+            if (check_commits && !obs.template get<CommitChecker>().loadProgram(inst_file)) {
+                std::cerr << "ERROR: Failed to load program" << std::endl;
+                return 1;
+            }
+            if (flight > 0) {
+                obs.template get<FlightRecorder>().installSignalHandlers(flight_file);
+            }
+            return simulate(core, inst_file, max_cycles, opt, energy_ptr, check, exp_a0, exp_a1,
+                            [&](bool result_ok) {
+                if constexpr (std::is_same_v<std::decay_t<decltype(obs)>, All>) {
+                    if (pv) reportPipeView(obs.template get<PipeView>());
+                    if (lat) reportLatency(obs.template get<LatencyObserver>());
+                }
+                bool ok = reportChecker(obs.template get<CommitChecker>());
+                return reportFlight(obs.template get<FlightRecorder>(),
+                                    failureOf(ok, result_ok)) && ok;
+            });
+        };
+        if (!pv && !lat) {
+            BasicCore<Checked> core(Checked(CommitChecker(), recorder));
+            return run(core);
+        }
+        BasicCore<All> core(All(PipeView(&pv_out, pv_cfg), LatencyObserver(), CommitChecker(),
+                                recorder));
+        return run(core);
+    }
+    
+    if (pv && lat) {
+        using Both = Observers<PipeView, LatencyObserver>;
+        BasicCore<Both> core(Both(PipeView(&pv_out, pv_cfg), LatencyObserver()));
+        return simulate(core, inst_file, max_cycles, opt, energy_ptr, check, exp_a0, exp_a1, [&](bool) {
+            reportPipeView(core.getObserver().get<PipeView>());
+            reportLatency(core.getObserver().get<LatencyObserver>());
+            return true;
+        });
+    }
+    if (pv) {
+        BasicCore<PipeView> core(PipeView(&pv_out, pv_cfg));
+        return simulate(core, inst_file, max_cycles, opt, energy_ptr, check, exp_a0, exp_a1,
+                        [&](bool) { reportPipeView(core.getObserver()); return true; });
+    }
+    BasicCore<LatencyObserver> core;
+    return simulate(core, inst_file, max_cycles, opt, energy_ptr, check, exp_a0, exp_a1,
+                    [&](bool) { reportLatency(core.getObserver()); return true; });
 }
@@ -1,33 +1,32 @@
 #include "map_table.h"
 
-MapTable::MapTable() {
+MapTable::MapTable() : ckpt_rat(N_CKPT) {
     reset();
 }
 
-void MapTable::reset() {
-    // Initialize RAT: x0-x31 map to P0-P31
+void MapTable::reset(preg_t base) {
+    // Initialize RAT: x0-x31 map to P0-P31 (plus base)
     for (int i = 0; i < N_ARCH_REGS; i++) {
-        rat[i] = i;
+        rat[i] = i ? static_cast<preg_t>(base + i) : 0;
+        arch_rat[i] = rat[i];
     }
     
-    for (int i = 0; i < ROB_DEPTH; i++) {
-        for (int j = 0; j < N_ARCH_REGS; j++) {
-            ckpt_rat[i].rat[j] = j;
-        }
+    for (auto& snap : ckpt_rat) {
+        snap.rat = rat;
     }
 }
 
-void MapTable::tick(bool flush, bool recover, rob_tag_t recover_tag,
+void MapTable::tick(bool flush, bool recover, ckpt_t recover_ckpt,
                     bool we, reg_t we_arch, preg_t we_new_phys,
-                    bool checkpoint_take, rob_tag_t checkpoint_tag) {
-    if (flush) {
-        // Flush: no-op (recovery handles it)
+                    bool checkpoint_take, ckpt_t checkpoint_id) {
+    if (recover) {
+        // Restore from checkpoint
+        rat = ckpt_rat[recover_ckpt].rat;
         return;
     }
     
-    if (recover) {
-        // Restore from checkpoint
-        rat = ckpt_rat[recover_tag].rat;
+    if (flush) {
+        // Flush: no-op (recovery handles it)
         return;
     }
     
@@ -42,6 +41,6 @@ void MapTable::tick(bool flush, bool recover, rob_tag_t recover_tag,
     
     // Checkpoint after update
     if (checkpoint_take) {
-        ckpt_rat[checkpoint_tag].rat = rat_next;
+        ckpt_rat[checkpoint_id].rat = rat_next;
     }
 }
@@ -0,0 +1,142 @@
+#include "mdu_fu.h"
+#include <algorithm>
+
+namespace {
+
+// Position of the leading one plus one (0 for 0)
+int bitLength(uint32_t v) {
+    int n = 0;
+    while (v != 0) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+}
+
+} // namespace
+
+MDUFU::MDUFU() : mul_latency(DEFAULT_MUL_LATENCY) {
+    reset();
+}
+
+void MDUFU::reset() {
+    mul_q.fill(Op{});
+    div_q = {};
+    div_cnt = 0;
+}
+
+void MDUFU::setMulLatency(int cycles) {
+    mul_latency = std::min(std::max(cycles, 1), MAX_MUL_LATENCY);
+    mul_q.fill(Op{});
+}
+
+void MDUFU::tick(bool flush, const std::bitset<ROB_DEPTH>& live_tag,
+                 bool issue_valid, const RSEntry& entry,
+                 xlen_t src1, xlen_t src2) {
+    // The op on the writeback port this cycle leaves the unit
+    if (div_q.v && div_cnt == 0 && !mulWB()) {
+        div_q = {};
+    } else if (div_cnt != 0) {
+        div_cnt--;
+    }
+    for (int i = mul_latency - 1; i > 0; i--) {
+        mul_q[i] = mul_q[i - 1];
+    }
+    mul_q[0] = {};
+
+    if (flush) {
+        // Ops older than the mispredicted branch still complete
+        for (int i = 0; i < mul_latency; i++) {
+            if (mul_q[i].v && !live_tag.test(mul_q[i].rob_tag)) {
+                mul_q[i] = {};
+            }
+        }
+        if (div_q.v && !live_tag.test(div_q.rob_tag)) {
+            div_q = {};
+            div_cnt = 0;
+        }
+        return;
+    }
+
+    if (!issue_valid || !entry.valid) {
+        return;
+    }
+
+    Op op = {};
+    op.v = true;
+    op.rd_used = entry.rd_used;
+    op.rob_tag = entry.rob_tag;
+    op.prd = entry.rd_used ? entry.prd : 0;
+    op.data = execute(entry.alu_op, src1, src2);
+    if (isDiv(entry)) {
+        div_q = op;
+        div_cnt = static_cast<uint8_t>(divLatency(entry, src1, src2) - 1);
+    } else {
+        mul_q[0] = op;
+    }
+}
+
+WBPkt MDUFU::getWB() const {
+    WBPkt wb = {};
+    const Op* o = mulWB() ? &mul_q[mul_latency - 1] :
+                  (div_q.v && div_cnt == 0) ? &div_q : nullptr;
+    if (!o) {
+        return wb;
+    }
+
+    wb.valid = true;
+    wb.rob_tag = o->rob_tag;
+    wb.rd_used = o->rd_used;
+    wb.prd = o->prd;
+    wb.data = o->data;
+    return wb;
+}
+
+bool MDUFU::isIdle() const {
+    for (int i = 0; i < mul_latency; i++) {
+        if (mul_q[i].v) return false;
+    }
+    return !div_q.v;
+}
+
+uint64_t MDUFU::quietCycles() const {
+    for (int i = 0; i < mul_latency; i++) {
+        if (mul_q[i].v) return 0;
+    }
+    if (!div_q.v) {
+        return UINT64_MAX;
+    }
+    // div_cnt == 0 writes back this cycle; counts d-1 .. 1 follow
+    return div_cnt == 0 ? 0 : div_cnt - 1;
+}
+
+int MDUFU::divLatency(const RSEntry& entry, xlen_t a, xlen_t b) {
+    bool sgn = entry.alu_op == ALUOp::DIV || entry.alu_op == ALUOp::REM;
+    if (sgn && a == 0x80000000u && b == 0xFFFFFFFFu) {
+        return 1;
+    }
+    uint32_t ma = (sgn && static_cast<int32_t>(a) < 0) ? 0u - a : a;
+    uint32_t mb = (sgn && static_cast<int32_t>(b) < 0) ? 0u - b : b;
+    if (mb == 0 || ma < mb) {
+        return 1;
+    }
+    return bitLength(ma) - bitLength(mb) + 2;
+}
+
+xlen_t MDUFU::execute(ALUOp op, xlen_t a, xlen_t b) {
+    int32_t sa = static_cast<int32_t>(a);
+    int32_t sb = static_cast<int32_t>(b);
+    bool overflow = a == 0x80000000u && b == 0xFFFFFFFFu;
+
+    switch (op) {
+        case ALUOp::MUL:    return a * b;
+        case ALUOp::MULH:   return static_cast<xlen_t>((static_cast<int64_t>(sa) * sb) >> 32);
+        case ALUOp::MULHSU: return static_cast<xlen_t>((static_cast<int64_t>(sa) * static_cast<int64_t>(b)) >> 32);
+        case ALUOp::MULHU:  return static_cast<xlen_t>((static_cast<uint64_t>(a) * b) >> 32);
+        case ALUOp::DIV:    return b == 0 ? 0xFFFFFFFFu : overflow ? a : static_cast<xlen_t>(sa / sb);
+        case ALUOp::DIVU:   return b == 0 ? 0xFFFFFFFFu : a / b;
+        case ALUOp::REM:    return b == 0 ? a : overflow ? 0 : static_cast<xlen_t>(sa % sb);
+        case ALUOp::REMU:   return b == 0 ? a : a % b;
+        default:            return 0;
+    }
+}
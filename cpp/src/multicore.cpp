@@ -0,0 +1,163 @@
+#include "multicore.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+// Spinning generation barrier; the last thread to arrive runs the
+// completion step before anyone is released
+class QuantumBarrier {
+private:
+    const int n;
+    std::atomic<int> arrived;
+    std::atomic<uint32_t> generation;
+
+public:
+    explicit QuantumBarrier(int n_threads) : n(n_threads), arrived(0), generation(0) {}
+    
+    template <typename F>
+    void arriveAndWait(F&& completion) {
+        uint32_t gen = generation.load(std::memory_order_acquire);
+        if (arrived.fetch_add(1, std::memory_order_acq_rel) == n - 1) {
+            completion();
+            arrived.store(0, std::memory_order_relaxed);
+            generation.store(gen + 1, std::memory_order_release);
+            return;
+        }
+        int spins = 0;
+        while (generation.load(std::memory_order_acquire) == gen) {
+            if (++spins > 256) {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
+
+// At least one core and one cycle per quantum
+MultiCoreConfig clampConfig(MultiCoreConfig c) {
+    c.cores = std::max(c.cores, 1);
+    c.quantum = std::max<uint64_t>(c.quantum, 1);
+    return c;
+}
+
+} // namespace
+
+// cfg is clamped before mem is sized from it (declaration order)
+MultiCore::MultiCore(const MultiCoreConfig& config) : cfg(clampConfig(config)), mem(cfg.cores) {
+    for (int h = 0; h < cfg.cores; h++) {
+        cores.push_back(std::make_unique<Core>());
+        cores[h]->setHartId(h);
+        cores[h]->attachMemory(&mem, h);
+    }
+    reset();
+}
+
+bool MultiCore::loadProgram(const std::string& filename) {
+    for (auto& c : cores) {
+        if (!c->loadProgram(filename)) return false;
+    }
+    return true;
+}
+
+void MultiCore::loadProgramWords(const std::vector<uint32_t>& words) {
+    for (auto& c : cores) {
+        c->loadProgramWords(words);
+    }
+}
+
+void MultiCore::reset() {
+    mem.reset();
+    for (auto& c : cores) {
+        c->reset();
+    }
+    cycle_count = 0;
+    host_sec = 0;
+}
+
+int MultiCore::getNumThreads() const {
+    int t = cfg.threads;
+    if (t <= 0) {
+        t = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    return std::min(t, cfg.cores);
+}
+
+bool MultiCore::allHalted() const {
+    for (const auto& c : cores) {
+        if (!c->isHalted()) return false;
+    }
+    return true;
+}
+
+uint64_t MultiCore::nextQuantum(uint64_t end_cycle, bool stop_when_halted) const {
+    if (cycle_count >= end_cycle || (stop_when_halted && allHalted())) {
+        return 0;
+    }
+    return std::min(cfg.quantum, end_cycle - cycle_count);
+}
+
+void MultiCore::runCores(int first, int last, uint64_t cycles) {
+    for (int h = first; h < last; h++) {
+        Core& c = *cores[h];
+        for (uint64_t i = 0; i < cycles; i++) {
+            c.tick();
+        }
+    }
+}
+
+uint64_t MultiCore::run(uint64_t max_cycles, bool stop_when_halted) {
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t start = cycle_count;
+    uint64_t end_cycle = cycle_count + max_cycles;
+    int n_threads = getNumThreads();
+    
+    if (n_threads == 1) {
+        for (uint64_t q; (q = nextQuantum(end_cycle, stop_when_halted)) != 0; ) {
+            runCores(0, getNumCores(), q);
+            mem.publish();
+            cycle_count += q;
+        }
+    } else {
+        // Thread t owns a contiguous block of harts; the caller is thread 0
+        QuantumBarrier barrier(n_threads);
+        uint64_t q = nextQuantum(end_cycle, stop_when_halted);
+        auto worker = [&](int t) {
+            int first = getNumCores() * t / n_threads;
+            int last = getNumCores() * (t + 1) / n_threads;
+            while (q != 0) {
+                runCores(first, last, q);
+                barrier.arriveAndWait([&] {
+                    mem.publish();
+                    cycle_count += q;
+                    q = nextQuantum(end_cycle, stop_when_halted);
+                });
+            }
+        };
+        
+        std::vector<std::thread> pool;
+        for (int t = 1; t < n_threads; t++) {
+            pool.emplace_back(worker, t);
+        }
+        worker(0);
+        for (auto& th : pool) {
+            th.join();
+        }
+    }
+    
+    host_sec += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return cycle_count - start;
+}
+
+MultiCoreStats MultiCore::getStats() const {
+    MultiCoreStats s = {};
+    s.cycles = cycle_count;
+    for (const auto& c : cores) {
+        s.commits += c->getCommitCount();
+        s.recoveries += c->getRecoverCount();
+        s.halted += c->isHalted() ? 1 : 0;
+    }
+    s.host_sec = host_sec;
+    return s;
+}
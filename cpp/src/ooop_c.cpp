@@ -0,0 +1,190 @@
+#include "ooop_c.h"
+#include "core.h"
+#include "time_travel.h"
+#include <memory>
+#include <new>
+
+struct ooop_core {
+    Core core;
+    std::unique_ptr<TimeTravel> tt;     // null unless ooop_time_travel enabled it
+};
+
+namespace {
+
+void tick(ooop_core* core) {
+    if (core->tt) {
+        core->tt->tick();
+    } else {
+        core->core.tick();
+    }
+}
+
+} // namespace
+
+int ooop_api_version(void) {
+    return OOOP_API_VERSION;
+}
+
+ooop_core* ooop_create(void) {
+    return new (std::nothrow) ooop_core();
+}
+
+void ooop_destroy(ooop_core* core) {
+    delete core;
+}
+
+void ooop_reset(ooop_core* core) {
+    core->core.reset();
+    if (core->tt) core->tt->restart();
+}
+
+int ooop_load_program(ooop_core* core, const char* path) {
+    if (!path) return -1;
+    try {
+        return core->core.loadProgram(path) ? 0 : -1;
+    } catch (...) {
+        return -1;
+    }
+}
+
+int ooop_load_words(ooop_core* core, const uint32_t* words, size_t count) {
+    if (!words && count != 0) return -1;
+    try {
+        core->core.loadProgramWords(std::vector<uint32_t>(words, words + count));
+    } catch (...) {
+        return -1;
+    }
+    return 0;
+}
+
+uint64_t ooop_step(ooop_core* core, uint64_t cycles) {
+    if (core->tt) {
+        core->tt->run(cycles);
+        return cycles;
+    }
+    for (uint64_t i = 0; i < cycles; i++) {
+        core->core.tick();
+    }
+    return cycles;
+}
+
+uint64_t ooop_run_until(ooop_core* core, int cond, uint64_t arg, uint64_t max_cycles) {
+    Core& c = core->core;
+    uint64_t n = 0;
+    
+    auto done = [&]() {
+        switch (cond) {
+            case OOOP_UNTIL_HALT:    return c.isHalted();
+            case OOOP_UNTIL_COMMITS: return c.getCommitCount() >= arg;
+            case OOOP_UNTIL_CYCLE:   return c.getCycleCount() >= arg;
+            default:                 return false;
+        }
+    };
+    
+    if (cond == OOOP_UNTIL_PC) {
+        // Stop on the cycle an instruction at arg commits
+        while (n < max_cycles) {
+            uint64_t commits = c.getCommitCount();
+            tick(core);
+            n++;
+            if (c.getCommitCount() != commits && c.getLastCommitPC() == static_cast<xlen_t>(arg)) {
+                break;
+            }
+        }
+        return n;
+    }
+    
+    while (n < max_cycles && !done()) {
+        tick(core);
+        n++;
+    }
+    return n;
+}
+
+uint64_t ooop_run_while(ooop_core* core, ooop_predicate pred, void* user,
+                        uint64_t max_cycles) {
+    uint64_t n = 0;
+    while (n < max_cycles && pred(core, user)) {
+        tick(core);
+        n++;
+    }
+    return n;
+}
+
+int ooop_time_travel(ooop_core* core, uint64_t interval, int max_snapshots) {
+    try {
+        core->tt.reset();
+        if (interval > 0) {
+            core->tt = std::make_unique<TimeTravel>(core->core, interval, max_snapshots);
+        }
+    } catch (...) {
+        return -1;
+    }
+    return 0;
+}
+
+int ooop_goto_cycle(ooop_core* core, uint64_t cycle) {
+    if (!core->tt) return -1;
+    try {
+        return core->tt->gotoCycle(cycle) ? 0 : -1;
+    } catch (...) {
+        return -1;
+    }
+}
+
+int ooop_step_back(ooop_core* core, uint64_t cycles) {
+    if (!core->tt) return -1;
+    try {
+        return core->tt->stepBack(cycles) ? 0 : -1;
+    } catch (...) {
+        return -1;
+    }
+}
+
+uint64_t ooop_state_hash(const ooop_core* core) {
+    return TimeTravel::hashState(core->core);
+}
+
+uint32_t ooop_arch_reg(const ooop_core* core, unsigned reg) {
+    return reg < N_ARCH_REGS ? core->core.getArchRegValue(static_cast<reg_t>(reg)) : 0;
+}
+
+unsigned ooop_arch_mapping(const ooop_core* core, unsigned reg) {
+    return reg < N_ARCH_REGS ? core->core.getArchMapping(static_cast<reg_t>(reg)) : 0;
+}
+
+uint32_t ooop_phys_reg(const ooop_core* core, unsigned preg) {
+    return preg < N_PHYS_REGS ? core->core.getPhysRegValue(static_cast<preg_t>(preg)) : 0;
+}
+
+int ooop_phys_valid(const ooop_core* core, unsigned preg) {
+    return preg < N_PHYS_REGS ? core->core.getPhysRegValid(static_cast<preg_t>(preg)) : 0;
+}
+
+uint32_t ooop_read_mem(const ooop_core* core, uint32_t addr) {
+    return core->core.readMemWord(addr);
+}
+
+int ooop_rob_count(const ooop_core* core) {
+    return core->core.getROBCount();
+}
+
+int ooop_rs_count(const ooop_core* core, int rs) {
+    switch (rs) {
+        case OOOP_RS_ALU: return core->core.getRSOccupancy(FUType::ALU);
+        case OOOP_RS_BRU: return core->core.getRSOccupancy(FUType::BRU);
+        case OOOP_RS_LSU: return core->core.getRSOccupancy(FUType::LSU);
+        case OOOP_RS_MDU: return core->core.getRSOccupancy(FUType::MDU);
+        default: return -1;
+    }
+}
+
+void ooop_get_stats(const ooop_core* core, ooop_stats* out) {
+    if (!out) return;
+    const Core& c = core->core;
+    out->cycles = c.getCycleCount();
+    out->commits = c.getCommitCount();
+    out->recoveries = c.getRecoverCount();
+    out->last_commit_pc = c.getLastCommitPC();
+    out->halted = c.isHalted() ? 1 : 0;
+}
@@ -0,0 +1,168 @@
+#include "pipeview.h"
+#include "rv32i.h"
+#include <iomanip>
+
+PipeView::PipeView() : PipeView(nullptr, PipeViewConfig{}) {}
+
+PipeView::PipeView(std::ostream* os, const PipeViewConfig& config)
+    : out(os), cfg(config), next_seq(1), next_decode(1), next_rename(1),
+      flush_cycle(NONE), fused_decode(NONE), written(0) {
+    tag_seq.fill(0);
+}
+
+PipeView::Record* PipeView::find(uint64_t seq) {
+    if (inflight.empty() || seq < inflight.front().seq) {
+        return nullptr;
+    }
+    uint64_t idx = seq - inflight.front().seq;
+    return idx < inflight.size() ? &inflight[idx] : nullptr;
+}
+
+void PipeView::stamp(uint64_t seq, int64_t Record::*stage, int64_t cycle) {
+    if (Record* r = find(seq)) {
+        r->*stage = cycle;
+        if (r->fused) {
+            if (Record* second = find(seq + 1)) second->*stage = cycle;
+        }
+    }
+}
+
+void PipeView::finish(uint64_t seq, int64_t retire) {
+    if (Record* r = find(seq)) {
+        r->retire = retire;
+        r->done = true;
+        if (r->fused) {
+            if (Record* second = find(seq + 1)) {
+                second->retire = retire;
+                second->done = true;
+            }
+        }
+    }
+}
+
+void PipeView::drain() {
+    while (!inflight.empty() && inflight.front().done) {
+        write(inflight.front());
+        inflight.pop_front();
+    }
+}
+
+void PipeView::write(const Record& r) {
+    uint64_t fetch = static_cast<uint64_t>(r.fetch);
+    if (!out || fetch < cfg.cycle_begin || fetch >= cfg.cycle_end ||
+        r.seq < cfg.seq_begin || r.seq >= cfg.seq_end) {
+        return;
+    }
+    auto tick = [&](int64_t cycle) { return cycle == NONE ? 0 : cycle * cfg.ticks_per_cycle; };
+    std::ostream& os = *out;
+    os << "O3PipeView:fetch:" << tick(r.fetch) << ":0x" << std::hex << std::setw(8)
+       << std::setfill('0') << r.pc << std::dec << ":0:" << r.seq << ":"
+       << rv32::disasm(r.instr) << "\n";
+    os << "O3PipeView:decode:" << tick(r.decode) << "\n";
+    os << "O3PipeView:rename:" << tick(r.rename) << "\n";
+    os << "O3PipeView:dispatch:" << tick(r.dispatch) << "\n";
+    os << "O3PipeView:issue:" << tick(r.issue) << "\n";
+    os << "O3PipeView:complete:" << tick(r.complete) << "\n";
+    // Stores write DMem when they issue at the ROB head, before retiring;
+    // the store stage is reported at retire
+    os << "O3PipeView:retire:" << tick(r.retire);
+    if (r.is_store) {
+        os << ":store:" << tick(r.retire);
+    }
+    os << "\n";
+    written++;
+}
+
+void PipeView::onFetch(uint64_t cycle, const FetchPkt& pkt) {
+    Record r = {};
+    r.seq = next_seq++;
+    r.pc = pkt.pc;
+    r.instr = pkt.instr;
+    r.fetch = cycle;
+    r.decode = fused_decode;    // NONE unless this is a fused pair's second half
+    r.rename = r.dispatch = r.issue = r.complete = r.retire = NONE;
+    fused_decode = NONE;
+    inflight.push_back(r);
+
+    // Latched in the flush cycle, then dropped with the fetch latch
+    if (static_cast<int64_t>(cycle) == flush_cycle) {
+        next_decode = next_rename = next_seq;
+        finish(r.seq, NONE);
+        drain();
+    }
+}
+
+void PipeView::onDecode(uint64_t cycle, const DecodePkt& pkt) {
+    // A decode in the flush cycle belongs to an instruction already squashed
+    if (static_cast<int64_t>(cycle) == flush_cycle) {
+        return;
+    }
+    uint64_t seq = next_decode++;
+    if (Record* r = find(seq)) {
+        r->is_store = pkt.is_store;
+        r->fused = pkt.fuse != FuseRule::NONE;
+    }
+    if (pkt.fuse != FuseRule::NONE) {
+        next_decode++;
+        if (!find(seq + 1)) fused_decode = cycle;
+    }
+    stamp(seq, &Record::decode, cycle);
+}
+
+void PipeView::onRename(uint64_t cycle, const RenamePkt& pkt) {
+    uint64_t seq = next_rename++;
+    if (pkt.fuse != FuseRule::NONE) {
+        next_rename++;
+    }
+    tag_seq[pkt.rob_tag] = seq;
+    stamp(seq, &Record::rename, cycle);
+}
+
+void PipeView::onDispatch(uint64_t cycle, const RSEntry& entry) {
+    stamp(tag_seq[entry.rob_tag], &Record::dispatch, cycle);
+}
+
+void PipeView::onIssue(uint64_t cycle, const RSEntry& entry) {
+    stamp(tag_seq[entry.rob_tag], &Record::issue, cycle);
+}
+
+void PipeView::onWriteback(uint64_t cycle, FUType fu, const WBPkt& wb) {
+    (void)fu;
+    stamp(tag_seq[wb.rob_tag], &Record::complete, cycle);
+}
+
+void PipeView::onCommit(uint64_t cycle, const CommitPkt& c) {
+    finish(tag_seq[c.rob_tag], cycle);
+    drain();
+}
+
+void PipeView::onRecover(uint64_t cycle, rob_tag_t tag, xlen_t flush_pc) {
+    (void)tag;
+    (void)flush_pc;
+
+    // Fetch and decode latches are cleared; renamed instructions follow
+    // as onSquash events
+    flush_cycle = cycle;
+    fused_decode = NONE;
+    for (uint64_t seq = next_rename; seq < next_seq; seq++) {
+        finish(seq, NONE);
+    }
+    next_decode = next_rename = next_seq;
+    drain();
+}
+
+void PipeView::onSquash(uint64_t cycle, rob_tag_t tag) {
+    (void)cycle;
+    finish(tag_seq[tag], NONE);
+    drain();
+}
+
+void PipeView::close() {
+    for (Record& r : inflight) {
+        r.done = true;
+    }
+    drain();
+    if (out) {
+        out->flush();
+    }
+}
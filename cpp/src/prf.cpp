@@ -1,6 +1,6 @@
 #include "prf.h"
 
-PRF::PRF() {
+PRF::PRF() : ckpt_valid(N_CKPT), ckpt_regs(N_CKPT) {
     reset();
 }
 
@@ -8,30 +8,26 @@ void PRF::reset() {
     regs.fill(0);
     valid_bits.set(); // All valid initially
     
-    for (int i = 0; i < ROB_DEPTH; i++) {
+    for (size_t i = 0; i < ckpt_valid.size(); i++) {
         ckpt_valid[i].valid_bits.set();
         ckpt_regs[i].fill(0);
     }
 }
 
-void PRF::tick(bool flush, bool recover, rob_tag_t recover_tag,
+void PRF::setCkptSlots(int n) {
+    ckpt_valid.resize(n);
+    ckpt_regs.resize(n);
+    for (int i = 0; i < n; i++) {
+        ckpt_valid[i].valid_bits.set();
+        ckpt_regs[i].fill(0);
+    }
+}
+
+void PRF::tick(bool flush, bool recover, ckpt_t recover_ckpt,
                const WBPkt& wb_alu, const WBPkt& wb_lsu, const WBPkt& wb_bru,
+               const WBPkt& wb_mdu,
                bool alloc_inval, preg_t alloc_preg,
-               bool checkpoint_take, rob_tag_t checkpoint_tag) {
-    if (recover) {
-        valid_bits = ckpt_valid[recover_tag].valid_bits;
-        regs = ckpt_regs[recover_tag];
-        regs[0] = 0;
-        valid_bits.set(0);
-        return;
-    }
-    
-    if (flush) {
-        regs[0] = 0;
-        valid_bits.set(0);
-        return;
-    }
-    
+               bool checkpoint_take, ckpt_t checkpoint_id) {
     // Helper to apply WB
     auto do_wb = [&](const WBPkt& wb) {
         if (wb.valid && wb.rd_used && wb.prd != 0) {
@@ -39,10 +35,33 @@ void PRF::tick(bool flush, bool recover, rob_tag_t recover_tag,
         }
     };
     
+    auto apply_wb_valid = [](std::bitset<N_PHYS_REGS>& vb, const WBPkt& wb) {
+        if (wb.valid && wb.rd_used && wb.prd != 0) {
+            vb.set(wb.prd);
+        }
+    };
+    
     // Apply writebacks
     do_wb(wb_alu);
     do_wb(wb_lsu);
     do_wb(wb_bru);
+    do_wb(wb_mdu);
+    
+    if (recover || flush) {
+        // NOTE: Do NOT restore PRF data or valid bits (matches prf.sv).
+        // Instructions older than the mispredicting branch may still be
+        // writing back, and their results must survive the recovery.
+        // Squashed pregs go back to the free list and are invalidated
+        // again when they are reallocated.
+        (void)recover_ckpt;
+        apply_wb_valid(valid_bits, wb_alu);
+        apply_wb_valid(valid_bits, wb_lsu);
+        apply_wb_valid(valid_bits, wb_bru);
+        apply_wb_valid(valid_bits, wb_mdu);
+        regs[0] = 0;
+        valid_bits.set(0);
+        return;
+    }
     
     // Update valid bits
     auto valid_next = valid_bits;
@@ -51,36 +70,32 @@ void PRF::tick(bool flush, bool recover, rob_tag_t recover_tag,
         valid_next.reset(alloc_preg);
     }
     
-    auto apply_wb_valid = [](std::bitset<N_PHYS_REGS>& vb, const WBPkt& wb) {
-        if (wb.valid && wb.rd_used && wb.prd != 0) {
-            vb.set(wb.prd);
-        }
-    };
-    
     apply_wb_valid(valid_next, wb_alu);
     apply_wb_valid(valid_next, wb_lsu);
     apply_wb_valid(valid_next, wb_bru);
+    apply_wb_valid(valid_next, wb_mdu);
     
     valid_next.set(0);
     valid_bits = valid_next;
     
     // Checkpoint
     if (checkpoint_take) {
-        ckpt_valid[checkpoint_tag].valid_bits = valid_next;
-        ckpt_regs[checkpoint_tag] = regs;
+        ckpt_valid[checkpoint_id].valid_bits = valid_next;
+        ckpt_regs[checkpoint_id] = regs;
         
         // Apply WB to checkpoint
         auto apply_ckpt_wb = [&](const WBPkt& wb) {
             if (wb.valid && wb.rd_used && wb.prd != 0) {
-                ckpt_regs[checkpoint_tag][wb.prd] = wb.data;
+                ckpt_regs[checkpoint_id][wb.prd] = wb.data;
             }
         };
         
         apply_ckpt_wb(wb_alu);
         apply_ckpt_wb(wb_lsu);
         apply_ckpt_wb(wb_bru);
+        apply_ckpt_wb(wb_mdu);
         
-        ckpt_regs[checkpoint_tag][0] = 0;
+        ckpt_regs[checkpoint_id][0] = 0;
     }
     
     regs[0] = 0;
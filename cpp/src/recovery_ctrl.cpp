@@ -0,0 +1,32 @@
+#include "recovery_ctrl.h"
+
+RecoveryCtrl::RecoveryCtrl() {
+    reset();
+}
+
+void RecoveryCtrl::reset() {
+    mp_q = false;
+    flush_q = false;
+    recover_q = false;
+    flush_pc_q = 0;
+    recover_tag_q = 0;
+    recover_ckpt_q = 0;
+    recover_pred_q = {};
+}
+
+void RecoveryCtrl::tick(bool mispredict, xlen_t target_pc, rob_tag_t recover_tag, ckpt_t recover_ckpt,
+                        const FetchPred& recover_pred) {
+    // Rising edge of mispredict starts a one-cycle flush + recover pulse
+    bool fire = mispredict && !mp_q;
+    mp_q = mispredict;
+    
+    flush_q = fire;
+    recover_q = fire;
+    
+    if (fire) {
+        flush_pc_q = target_pc;
+        recover_tag_q = recover_tag;
+        recover_ckpt_q = recover_ckpt;
+        recover_pred_q = recover_pred;
+    }
+}
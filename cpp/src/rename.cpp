@@ -0,0 +1,148 @@
+#include "rename.h"
+
+Rename::Rename(MapTable* mt, FreeList* fl) : map_table(mt), free_list(fl), elim_enable(false) {}
+
+RenamePkt Rename::rename(const DecodePkt& pkt_in, bool valid_in,
+                        const std::bitset<N_PHYS_REGS>& prf_valid,
+                        bool tag_ok, rob_tag_t rob_tag,
+                        bool ckpt_ok, ckpt_t ckpt_id,
+                        bool ready_in) {
+    (void)ready_in;
+    RenamePkt pkt = {};
+    
+    if (!valid_in) {
+        return pkt;
+    }
+    
+    // Check if need dest allocation
+    reg_t elim_src = 0;
+    bool elim = elimSource(pkt_in, elim_src);
+    bool need_alloc = needAlloc(pkt_in);
+    bool has_free = free_list->hasFree();
+    
+    // Can proceed?
+    bool alloc_ok = (!need_alloc) || has_free;
+    bool need_ckpt = pkt_in.is_branch || pkt_in.is_jump;
+    bool can_proceed = alloc_ok && tag_ok && (!need_ckpt || ckpt_ok);
+    
+    pkt.valid = can_proceed;
+    pkt.pc = pkt_in.pc;
+    pkt.instr = pkt_in.instr;
+    pkt.rs1 = pkt_in.rs1;
+    pkt.rs2 = pkt_in.rs2;
+    pkt.rd = pkt_in.rd;
+    pkt.imm = pkt_in.imm;
+    pkt.imm_used = pkt_in.imm_used;
+    pkt.fu_type = pkt_in.fu_type;
+    pkt.alu_op = pkt_in.alu_op;
+    pkt.rd_used = need_alloc || elim;
+    pkt.is_load = pkt_in.is_load;
+    pkt.is_store = pkt_in.is_store;
+    pkt.ls_size = pkt_in.ls_size;
+    pkt.unsigned_load = pkt_in.unsigned_load;
+    pkt.is_branch = pkt_in.is_branch;
+    pkt.is_jump = pkt_in.is_jump;
+    pkt.pred = pkt_in.pred;
+    pkt.fuse = pkt_in.fuse;
+    pkt.instr2 = pkt_in.instr2;
+    pkt.imm2 = pkt_in.imm2;
+    pkt.rs1_used = pkt_in.rs1_used;
+    pkt.rs2_used = pkt_in.rs2_used;
+    
+    // Rename sources
+    pkt.prs1 = map_table->lookupRS1(pkt_in.rs1);
+    pkt.prs2 = map_table->lookupRS2(pkt_in.rs2);
+    
+    // Check ready (unused operands never wait)
+    auto preg_ready = [&](preg_t p) {
+        return (p == 0) || prf_valid.test(p);
+    };
+    pkt.prs1_ready = !pkt_in.rs1_used || preg_ready(pkt.prs1);
+    pkt.prs2_ready = !pkt_in.rs2_used || preg_ready(pkt.prs2);
+    
+    // Rename dest
+    if (elim) {
+        pkt.fu_type = FUType::NONE;
+        pkt.eliminated = true;
+        pkt.prd = map_table->lookupRS1(elim_src);
+        pkt.old_prd = map_table->lookupRDOld(pkt_in.rd);
+    } else if (need_alloc) {
+        pkt.prd = free_list->getAllocPreg();
+        pkt.old_prd = map_table->lookupRDOld(pkt_in.rd);
+    } else {
+        pkt.prd = 0;
+        pkt.old_prd = 0;
+    }
+    
+    pkt.rob_tag = rob_tag;
+    pkt.ckpt_id = need_ckpt ? ckpt_id : 0;
+    
+    return pkt;
+}
+
+bool Rename::getReadyOut(const DecodePkt& pkt_in, bool has_free, bool tag_ok, bool ckpt_ok,
+                         bool ready_in) const {
+    bool alloc_ok = !needAlloc(pkt_in) || has_free;
+    bool need_ckpt = pkt_in.is_branch || pkt_in.is_jump;
+    return ready_in && alloc_ok && tag_ok && (!need_ckpt || ckpt_ok);
+}
+
+bool Rename::getValidOut(const DecodePkt& pkt_in, bool valid_in, bool has_free, bool tag_ok,
+                         bool ckpt_ok) const {
+    bool alloc_ok = !needAlloc(pkt_in) || has_free;
+    bool need_ckpt = pkt_in.is_branch || pkt_in.is_jump;
+    return valid_in && alloc_ok && tag_ok && (!need_ckpt || ckpt_ok);
+}
+
+bool Rename::getAllocReq(const DecodePkt& pkt_in, bool fire) const {
+    return fire && needAlloc(pkt_in);
+}
+
+bool Rename::getCheckpointTake(const DecodePkt& pkt_in, bool fire) const {
+    return fire && (pkt_in.is_branch || pkt_in.is_jump);
+}
+
+bool Rename::needAlloc(const DecodePkt& pkt_in) const {
+    reg_t src;
+    return pkt_in.rd_used && (pkt_in.rd != 0) && !elimSource(pkt_in, src);
+}
+
+bool Rename::elimSource(const DecodePkt& pkt_in, reg_t& src) const {
+    if (!elim_enable || pkt_in.fu_type != FUType::ALU || !pkt_in.rd_used || pkt_in.rd == 0) {
+        return false;
+    }
+
+    // Decoded ALUOp, not the raw encoding: that is what the ALU executes
+    reg_t a = pkt_in.rs1;
+    reg_t b = pkt_in.rs2;
+    xlen_t imm = pkt_in.imm;
+    bool i = pkt_in.imm_used;
+    switch (pkt_in.alu_op) {
+        case ALUOp::LUI:
+            src = 0;
+            return imm == 0;
+        case ALUOp::ADD:
+        case ALUOp::OR:
+            if (i) {
+                src = a;
+                return imm == 0;
+            }
+            src = (b == 0) ? a : b;
+            return a == 0 || b == 0;
+        case ALUOp::SUB:
+            src = (a == b) ? 0 : a;
+            return a == b || b == 0;
+        case ALUOp::AND:
+            src = 0;
+            return i ? (imm == 0 || a == 0) : (a == 0 || b == 0);
+        case ALUOp::SRL:
+        case ALUOp::SRA:
+            src = a;
+            return a == 0 || (i ? (imm & 0x1F) == 0 : b == 0);
+        case ALUOp::SLTIU:
+            src = 0;
+            return imm == 0;
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,205 @@
+#include "rob.h"
+
+ROB::ROB() : ckpt_ptrs(N_CKPT), walk_width(0) {
+    reset();
+}
+
+void ROB::reset() {
+    for (int i = 0; i < DEPTH; i++) {
+        entries[i] = {};
+    }
+    for (auto& snap : ckpt_ptrs) {
+        snap = {};
+    }
+    head = 0;
+    tail = 0;
+    count = 0;
+    walking = false;
+    walk_stop = 0;
+}
+
+void ROB::tick(bool flush, bool recover, rob_tag_t recover_tag, ckpt_t recover_ckpt,
+               bool alloc_valid, const RenamePkt& alloc_pkt,
+               const WBPkt& wb_alu, const WBPkt& wb_lsu, const WBPkt& wb_bru,
+               const WBPkt& wb_mdu,
+               bool checkpoint_take, ckpt_t checkpoint_id) {
+    // Commit (one per cycle, in order)
+    bool commit = getCommit();
+    rob_tag_t head_next = head;
+    if (commit) {
+        entries[head].valid = false;
+        head_next = (head + 1) & (DEPTH - 1);
+    }
+    
+    // Writeback marks done
+    for (int i = 0; i < DEPTH; i++) {
+        Entry& e = entries[i];
+        if (e.valid && (wbHits(wb_alu, e.tag) || wbHits(wb_lsu, e.tag) || wbHits(wb_bru, e.tag) ||
+                        wbHits(wb_mdu, e.tag))) {
+            e.done = true;
+        }
+    }
+    
+    if (recover && walk_width > 0) {
+        // Remember where the walk stops; the entries stay until popped
+        rob_tag_t idx = head;
+        rob_tag_t stop = head_next;
+        for (int k = 0; k < count; k++) {
+            if (entries[idx].valid && entries[idx].tag == recover_tag) {
+                stop = (idx + 1) & (DEPTH - 1);
+                break;
+            }
+            idx = (idx + 1) & (DEPTH - 1);
+        }
+        head = head_next;
+        if (commit) count--;
+        walk_stop = stop;
+        walking = count > 0 && tail != walk_stop;
+        return;
+    }
+    
+    if (recover) {
+        // Truncate to just after the mispredicted branch. The branch may
+        // be committing this very cycle, in which case nothing survives.
+        rob_tag_t ckpt_tail = ckpt_ptrs[recover_ckpt].tail;
+        rob_tag_t br_idx = (ckpt_tail - 1) & (DEPTH - 1);
+        bool br_live = entries[br_idx].valid && entries[br_idx].tag == recover_tag;
+        
+        for (rob_tag_t idx = ckpt_tail; idx != tail; idx = (idx + 1) & (DEPTH - 1)) {
+            entries[idx].valid = false;
+        }
+        
+        uint8_t n = (ckpt_tail - head_next) & (DEPTH - 1);
+        if (n == 0 && br_live) n = DEPTH;
+        
+        head = head_next;
+        tail = ckpt_tail;
+        count = n;
+        return;
+    }
+    
+    head = head_next;
+    if (commit) count--;
+    
+    if (walking) {
+        for (int k = 0; k < walk_width && tail != walk_stop && count > 0; k++) {
+            tail = (tail - 1) & (DEPTH - 1);
+            entries[tail].valid = false;
+            count--;
+        }
+        walking = count > 0 && tail != walk_stop;
+    }
+    
+    if (flush) {
+        return;
+    }
+    
+    // Allocate at tail
+    if (alloc_valid && count < DEPTH) {
+        Entry& e = entries[tail];
+        e.valid = true;
+        e.done = alloc_pkt.eliminated;     // nothing to execute
+        e.tag = alloc_pkt.rob_tag;
+        e.pc = alloc_pkt.pc;
+        e.rd = alloc_pkt.rd;
+        e.rd_used = alloc_pkt.rd_used;
+        e.prd = alloc_pkt.prd;
+        e.old_prd = alloc_pkt.old_prd;
+        e.eliminated = alloc_pkt.eliminated;
+        e.fuse = alloc_pkt.fuse;
+        tail = (tail + 1) & (DEPTH - 1);
+        count++;
+    }
+    
+    if (checkpoint_take) {
+        ckpt_ptrs[checkpoint_id].tail = tail;
+        ckpt_ptrs[checkpoint_id].count = count;
+    }
+}
+
+bool ROB::getCommit() const {
+    // While walking, everything from walk_stop on is squashed
+    bool squashed = walking && head == walk_stop;
+    return count > 0 && entries[head].valid && entries[head].done && !squashed;
+}
+
+int ROB::getWalkUndo(RenamePkt* out) const {
+    if (!walking) {
+        return 0;
+    }
+    int n = 0;
+    int left = count - (getCommit() ? 1 : 0);
+    rob_tag_t idx = tail;
+    while (n < walk_width && idx != walk_stop && left > 0) {
+        idx = (idx - 1) & (DEPTH - 1);
+        const Entry& e = entries[idx];
+        out[n] = {};
+        out[n].rd = e.rd;
+        out[n].rd_used = e.rd_used;
+        out[n].prd = e.prd;
+        out[n].old_prd = e.old_prd;
+        out[n].rob_tag = e.tag;
+        n++;
+        left--;
+    }
+    return n;
+}
+
+int ROB::getRecoverUndo(ckpt_t recover_ckpt, RenamePkt* out) const {
+    int n = 0;
+    for (rob_tag_t idx = ckpt_ptrs[recover_ckpt].tail; idx != tail; idx = (idx + 1) & (DEPTH - 1)) {
+        const Entry& e = entries[idx];
+        if (!e.valid) continue;
+        out[n] = {};
+        out[n].rd = e.rd;
+        out[n].rd_used = e.rd_used;
+        out[n].prd = e.prd;
+        out[n].old_prd = e.old_prd;
+        out[n].rob_tag = e.tag;
+        n++;
+    }
+    return n;
+}
+
+bool ROB::getFreeReq() const {
+    return getCommit() && entries[head].rd_used;
+}
+
+preg_t ROB::getFreePreg() const {
+    return entries[head].old_prd;
+}
+
+std::bitset<ROB_DEPTH> ROB::getLiveTag() const {
+    std::bitset<DEPTH> live;
+    for (int i = 0; i < DEPTH; i++) {
+        if (entries[i].valid) live.set(entries[i].tag);
+    }
+    return live;
+}
+
+std::bitset<ROB_DEPTH> ROB::getRecoverLiveTag(ckpt_t recover_ckpt) const {
+    std::bitset<DEPTH> live;
+    rob_tag_t ckpt_tail = ckpt_ptrs[recover_ckpt].tail;
+    rob_tag_t idx = head;
+    for (int k = 0; k < count; k++) {
+        if (entries[idx].valid) live.set(entries[idx].tag);
+        idx = (idx + 1) & (DEPTH - 1);
+        if (idx == ckpt_tail) break;
+    }
+    return live;
+}
+
+std::bitset<ROB_DEPTH> ROB::getLiveTagUpTo(rob_tag_t tag) const {
+    std::bitset<DEPTH> live;
+    rob_tag_t idx = head;
+    for (int k = 0; k < count; k++) {
+        if (entries[idx].valid) live.set(entries[idx].tag);
+        if (entries[idx].valid && entries[idx].tag == tag) break;
+        idx = (idx + 1) & (DEPTH - 1);
+    }
+    return live;
+}
+
+bool ROB::wbHits(const WBPkt& wb, rob_tag_t tag) const {
+    return wb.valid && wb.rob_tag == tag;
+}
@@ -0,0 +1,72 @@
+#include "rob_tag_alloc.h"
+#include <algorithm>
+
+ROBTagAlloc::ROBTagAlloc() : next_tag(0), ckpt_next_tag(N_CKPT) {
+    reset();
+}
+
+void ROBTagAlloc::reset() {
+    next_tag = 0;
+    reserved.reset();
+    std::fill(ckpt_next_tag.begin(), ckpt_next_tag.end(), 0);
+}
+
+void ROBTagAlloc::tick(bool flush, bool recover, ckpt_t recover_ckpt,
+                       bool alloc_req, const std::bitset<ROB_DEPTH>& live_tag,
+                       bool rob_alloc_fire, rob_tag_t rob_alloc_tag,
+                       bool checkpoint_take, ckpt_t checkpoint_id) {
+    if (recover) {
+        next_tag = ckpt_next_tag[recover_ckpt];
+        reserved.reset();
+        return;
+    }
+    
+    if (flush) {
+        reserved.reset();
+        return;
+    }
+    
+    // Clear reserved when ROB confirms allocation
+    if (rob_alloc_fire) {
+        reserved.reset(rob_alloc_tag);
+    }
+    
+    // Find free tag
+    std::bitset<ROB_DEPTH> used = live_tag | reserved;
+    rob_tag_t free_tag = findFreeTag(used);
+    bool found = (free_tag < ROB_DEPTH) && !used.test(free_tag);
+    
+    // Allocate if requested
+    if (alloc_req && found) {
+        reserved.set(free_tag);
+        next_tag = (free_tag + 1) & (ROB_DEPTH - 1);
+    }
+    
+    // Checkpoint
+    if (checkpoint_take) {
+        rob_tag_t next_tag_after = (free_tag + 1) & (ROB_DEPTH - 1);
+        if (alloc_req && found) {
+            ckpt_next_tag[checkpoint_id] = next_tag_after;
+        } else {
+            ckpt_next_tag[checkpoint_id] = next_tag;
+        }
+    }
+}
+
+bool ROBTagAlloc::getAllocOk(const std::bitset<ROB_DEPTH>& live_tag) const {
+    return !(live_tag | reserved).all();
+}
+
+rob_tag_t ROBTagAlloc::getTag(const std::bitset<ROB_DEPTH>& live_tag) const {
+    return findFreeTag(live_tag | reserved);
+}
+
+rob_tag_t ROBTagAlloc::findFreeTag(const std::bitset<ROB_DEPTH>& used) const {
+    for (int k = 0; k < ROB_DEPTH; k++) {
+        rob_tag_t cand = (next_tag + k) & (ROB_DEPTH - 1);
+        if (!used.test(cand)) {
+            return cand;
+        }
+    }
+    return next_tag;
+}
@@ -0,0 +1,140 @@
+#include "rs.h"
+
+RS::RS(bool in_order) : age_ctr(0), in_order(in_order) {
+    reset();
+}
+
+void RS::reset() {
+    for (int i = 0; i < DEPTH; i++) {
+        entries[i] = {};
+        occupied[i] = false;
+        age[i] = 0;
+    }
+    age_ctr = 0;
+    refresh();
+}
+
+void RS::tick(bool flush, bool recover, const std::bitset<ROB_DEPTH>& live_tag,
+              bool insert_valid, const RSEntry& insert_entry,
+              const WBPkt& wb_alu, const WBPkt& wb_lsu, const WBPkt& wb_bru,
+              const WBPkt& wb_mdu,
+              bool issue_ready, const std::bitset<N_PHYS_REGS>& prf_valid) {
+    // Idle: an empty RS with nothing to insert has no state to change
+    if (count == 0 && !insert_valid) {
+        return;
+    }
+    bool dirty = false;
+    
+    // Issue (select was made on current state)
+    int issued = -1;
+    if (issue_ready && ready_idx >= 0) {
+        issued = ready_idx;
+        occupied[issued] = false;
+        entries[issued].valid = false;
+        dirty = true;
+    }
+    
+    // Wakeup
+    bool any_wb = matchWB(wb_alu, wb_alu.prd) || matchWB(wb_lsu, wb_lsu.prd) ||
+                  matchWB(wb_bru, wb_bru.prd) || matchWB(wb_mdu, wb_mdu.prd);
+    for (int i = 0; any_wb && i < DEPTH; i++) {
+        if (!occupied[i]) continue;
+        RSEntry& e = entries[i];
+        if (!e.prs1_ready &&
+            (matchWB(wb_alu, e.prs1) || matchWB(wb_lsu, e.prs1) || matchWB(wb_bru, e.prs1) ||
+             matchWB(wb_mdu, e.prs1))) {
+            e.prs1_ready = true;
+            dirty = true;
+        }
+        if (!e.prs2_ready &&
+            (matchWB(wb_alu, e.prs2) || matchWB(wb_lsu, e.prs2) || matchWB(wb_bru, e.prs2) ||
+             matchWB(wb_mdu, e.prs2))) {
+            e.prs2_ready = true;
+            dirty = true;
+        }
+    }
+    
+    if (recover) {
+        // Squash only entries younger than the mispredicted branch
+        for (int i = 0; i < DEPTH; i++) {
+            if (occupied[i] && !live_tag.test(entries[i].rob_tag)) {
+                occupied[i] = false;
+                entries[i].valid = false;
+                dirty = true;
+            }
+        }
+        if (dirty) refresh();
+        return;
+    }
+    
+    if (flush) {
+        for (int i = 0; i < DEPTH; i++) {
+            occupied[i] = false;
+            entries[i].valid = false;
+        }
+        refresh();
+        return;
+    }
+    
+    // Insert. Readiness is recomputed here (as rs.sv does) because the
+    // producer may have written back while the packet sat in dispatch.
+    // The lowest free slot may be the one just issued.
+    int slot = (issued >= 0 && (free_idx < 0 || issued < free_idx)) ? issued : free_idx;
+    if (insert_valid && slot >= 0) {
+        RSEntry e = insert_entry;
+        auto now_ready = [&](bool used, preg_t p) {
+            return !used || p == 0 || prf_valid.test(p) ||
+                   matchWB(wb_alu, p) || matchWB(wb_lsu, p) || matchWB(wb_bru, p) ||
+                   matchWB(wb_mdu, p);
+        };
+        e.valid = true;
+        e.prs1_ready = e.prs1_ready || now_ready(e.rs1_used, e.prs1);
+        e.prs2_ready = e.prs2_ready || now_ready(e.rs2_used, e.prs2);
+        entries[slot] = e;
+        occupied[slot] = true;
+        age[slot] = age_ctr++;
+        dirty = true;
+    }
+    
+    if (dirty) refresh();
+}
+
+void RS::refresh() {
+    // One pass: first free slot, occupancy and the oldest ready entry
+    // (in-order RSs only look at the oldest entry)
+    count = 0;
+    free_idx = -1;
+    int best = -1;
+    int oldest = -1;
+    for (int i = 0; i < DEPTH; i++) {
+        if (!occupied[i]) {
+            if (free_idx < 0) free_idx = i;
+            continue;
+        }
+        count++;
+        if (oldest < 0 || age[i] < age[oldest]) {
+            oldest = i;
+        }
+        if (entries[i].prs1_ready && entries[i].prs2_ready &&
+            (best < 0 || age[i] < age[best])) {
+            best = i;
+        }
+    }
+    if (in_order) {
+        ready_idx = (oldest >= 0 && oldest == best) ? oldest : -1;
+    } else {
+        ready_idx = best;
+    }
+}
+
+int RS::getOccupancy(const std::bitset<ROB_DEPTH>& tags) const {
+    int n = 0;
+    for (int i = 0; i < DEPTH; i++) {
+        n += occupied[i] && tags.test(entries[i].rob_tag);
+    }
+    return n;
+}
+
+bool RS::matchWB(const WBPkt& wb, preg_t preg) const {
+    return wb.valid && wb.rd_used && wb.prd != 0 && wb.prd == preg;
+}
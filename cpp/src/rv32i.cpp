@@ -0,0 +1,86 @@
+#include "rv32i.h"
+#include <cstdio>
+
+namespace rv32 {
+
+namespace {
+
+std::string x(uint32_t r) {
+    return "x" + std::to_string(r);
+}
+
+int32_t immI(uint32_t in) { return static_cast<int32_t>(in) >> 20; }
+
+int32_t immS(uint32_t in) {
+    return ((static_cast<int32_t>(in) >> 20) & ~0x1F) | ((in >> 7) & 0x1F);
+}
+
+int32_t immB(uint32_t in) {
+    return (static_cast<int32_t>(in & 0x80000000) >> 19) | ((in << 4) & 0x800) |
+           ((in >> 20) & 0x7E0) | ((in >> 7) & 0x1E);
+}
+
+int32_t immJ(uint32_t in) {
+    return (static_cast<int32_t>(in & 0x80000000) >> 11) | (in & 0xFF000) |
+           ((in >> 9) & 0x800) | ((in >> 20) & 0x7FE);
+}
+
+} // namespace
+
+std::string disasm(uint32_t in) {
+    uint32_t op = in & 0x7F;
+    uint32_t rd = (in >> 7) & 0x1F;
+    uint32_t f3 = (in >> 12) & 0x7;
+    uint32_t rs1 = (in >> 15) & 0x1F;
+    uint32_t rs2 = (in >> 20) & 0x1F;
+    uint32_t f7 = (in >> 25) & 0x7F;
+    char buf[64];
+
+    switch (op) {
+        case OP_LUI:
+            std::snprintf(buf, sizeof(buf), "lui %s 0x%x", x(rd).c_str(), in >> 12);
+            return buf;
+        case OP_JAL:
+            return "jal " + x(rd) + " " + std::to_string(immJ(in));
+        case OP_JALR:
+            return "jalr " + x(rd) + " " + x(rs1) + " " + std::to_string(immI(in));
+        case OP_BRANCH: {
+            static const char* names[8] = {"beq", "bne", "b?", "b?", "blt", "bge", "bltu", "bgeu"};
+            return std::string(names[f3]) + " " + x(rs1) + " " + x(rs2) + " " + std::to_string(immB(in));
+        }
+        case OP_LOAD:
+            return std::string(f3 == 0x4 ? "lbu " : "lw ") + x(rd) + " " + std::to_string(immI(in)) + " " + x(rs1);
+        case OP_STORE:
+            return std::string(f3 == 0x1 ? "sh " : "sw ") + x(rs2) + " " + std::to_string(immS(in)) + " " + x(rs1);
+        case OP_IMM: {
+            const char* name = "addi";
+            int32_t imm = immI(in);
+            switch (f3) {
+                case 0x3: name = "sltiu"; break;
+                case 0x6: name = "ori"; break;
+                case 0x7: name = "andi"; break;
+                case 0x5: name = (f7 == 0x20) ? "srai" : "srli"; imm &= 0x1F; break;
+                default: break;
+            }
+            return std::string(name) + " " + x(rd) + " " + x(rs1) + " " + std::to_string(imm);
+        }
+        case OP_REG: {
+            static const char* mext[8] = {"mul", "mulh", "mulhsu", "mulhu", "div", "divu", "rem", "remu"};
+            const char* name = "add";
+            switch (f3) {
+                case 0x0: name = (f7 == 0x20) ? "sub" : "add"; break;
+                case 0x5: name = "sra"; break;
+                case 0x6: name = "or"; break;
+                case 0x7: name = "and"; break;
+                default: break;
+            }
+            if (f7 == 0x01) name = mext[f3];
+            return std::string(name) + " " + x(rd) + " " + x(rs1) + " " + x(rs2);
+        }
+        default:
+            std::snprintf(buf, sizeof(buf), "unknown 0x%08x", in);
+            return buf;
+    }
+}
+
+} // namespace rv32
@@ -0,0 +1,49 @@
+#include "shared_mem.h"
+#include "dmem.h"
+#include <algorithm>
+
+SharedMem::SharedMem(int n_ports) : mem(DEPTH_WORDS, 0), ports(n_ports) {
+}
+
+void SharedMem::reset() {
+    std::fill(mem.begin(), mem.end(), 0);
+    for (auto& p : ports) {
+        p.pending.clear();
+        p.overlay.clear();
+    }
+}
+
+uint32_t SharedMem::load(int port, uint32_t idx) const {
+    const Port& p = ports[port];
+    if (!p.overlay.empty()) {
+        auto it = p.overlay.find(idx);
+        if (it != p.overlay.end()) {
+            return it->second;
+        }
+    }
+    return mem[idx];
+}
+
+void SharedMem::store(int port, uint64_t cycle, uint32_t idx, uint32_t wdata,
+                      LSSize size, uint8_t off) {
+    Port& p = ports[port];
+    p.overlay[idx] = DMem::writeMerge(load(port, idx), wdata, size, off);
+    p.pending.push_back({cycle, idx, wdata, size, off});
+}
+
+void SharedMem::publish() {
+    // Logs are appended port by port and each is already in cycle order,
+    // so a stable sort by cycle yields (cycle, port) order
+    merge_buf.clear();
+    for (auto& p : ports) {
+        merge_buf.insert(merge_buf.end(), p.pending.begin(), p.pending.end());
+        p.pending.clear();
+        p.overlay.clear();
+    }
+    std::stable_sort(merge_buf.begin(), merge_buf.end(),
+                     [](const Store& a, const Store& b) { return a.cycle < b.cycle; });
+    
+    for (const Store& s : merge_buf) {
+        mem[s.idx] = DMem::writeMerge(mem[s.idx], s.wdata, s.size, s.off);
+    }
+}
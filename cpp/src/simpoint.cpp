@@ -0,0 +1,397 @@
+#include "simpoint.h"
+#include "core.h"
+#include "decode.h"
+#include "iss.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+namespace {
+
+double dist2(const std::vector<double>& a, const std::vector<double>& b) {
+    double d = 0.0;
+    for (size_t i = 0; i < a.size(); i++) {
+        double x = a[i] - b[i];
+        d += x * x;
+    }
+    return d;
+}
+
+} // namespace
+
+SimPoint::SimPoint(const SimPointConfig& config)
+    : cfg(config), total_insts(0), halted(false) {}
+
+bool SimPoint::loadProgram(const std::string& filename) {
+    ISS iss;
+    if (!iss.loadProgram(filename)) {
+        return false;
+    }
+    words.clear();
+    for (int i = 0; i < ISS::IMEM_WORDS; i++) {
+        words.push_back(iss.fetch(i * 4));
+    }
+    return true;
+}
+
+void SimPoint::loadProgramWords(const std::vector<uint32_t>& program) {
+    words = program;
+}
+
+void SimPoint::profile() {
+    // Block ends come from the model's own decoder; past the ICache only
+    // NOPs are fetched, which never end a block
+    Decode dec;
+    std::vector<bool> ends_block(ISS::IMEM_WORDS, false);
+    for (size_t i = 0; i < words.size() && i < ends_block.size(); i++) {
+        DecodePkt d = dec.decode(true, i * 4, words[i]);
+        ends_block[i] = d.is_branch || d.is_jump;
+    }
+
+    ISS iss;
+    iss.loadWords(words);
+
+    std::unordered_map<xlen_t, uint32_t> block_id;
+    std::vector<uint32_t> counts;       // per block, current interval
+    std::vector<uint32_t> touched;      // blocks with a non-zero count
+
+    block_pcs.clear();
+    intervals.clear();
+    total_insts = 0;
+    halted = false;
+
+    uint64_t in_interval = 0;
+    auto closeInterval = [&]() {
+        BBVInterval iv;
+        iv.start = total_insts - in_interval;
+        iv.insts = in_interval;
+        std::sort(touched.begin(), touched.end());
+        for (uint32_t id : touched) {
+            iv.blocks.emplace_back(id, counts[id]);
+            counts[id] = 0;
+        }
+        touched.clear();
+        intervals.push_back(std::move(iv));
+        in_interval = 0;
+    };
+
+    bool block_start = true;
+    uint32_t cur = 0;
+    while (total_insts < cfg.max_insts) {
+        if (block_start) {
+            xlen_t pc = iss.getPC();
+            auto it = block_id.find(pc);
+            if (it == block_id.end()) {
+                it = block_id.emplace(pc, static_cast<uint32_t>(block_pcs.size())).first;
+                block_pcs.push_back(pc);
+                counts.push_back(0);
+            }
+            cur = it->second;
+            block_start = false;
+        }
+        if (counts[cur]++ == 0) {
+            touched.push_back(cur);
+        }
+
+        ISS::StepInfo s = iss.step();
+        total_insts++;
+        in_interval++;
+
+        uint32_t idx = s.pc >> 2;
+        block_start = idx < ends_block.size() && ends_block[idx];
+
+        if (s.next_pc == s.pc) {
+            halted = true;
+            break;
+        }
+        if (in_interval == cfg.interval) {
+            closeInterval();
+        }
+    }
+    if (in_interval > 0) {
+        closeInterval();
+    }
+}
+
+void SimPoint::project() {
+    // Dense random matrix, one row per block, entries uniform in [-1, 1)
+    std::mt19937 rng(cfg.seed);
+    std::uniform_real_distribution<double> u(-1.0, 1.0);
+    std::vector<std::vector<double>> proj(block_pcs.size(), std::vector<double>(cfg.dims));
+    for (auto& row : proj) {
+        for (double& x : row) {
+            x = u(rng);
+        }
+    }
+
+    // Each BBV is normalized to instruction fractions before projecting
+    points.assign(intervals.size(), std::vector<double>(cfg.dims, 0.0));
+    for (size_t i = 0; i < intervals.size(); i++) {
+        double scale = 1.0 / intervals[i].insts;
+        for (const auto& b : intervals[i].blocks) {
+            double f = b.second * scale;
+            for (int d = 0; d < cfg.dims; d++) {
+                points[i][d] += f * proj[b.first][d];
+            }
+        }
+    }
+}
+
+double SimPoint::kmeans(int k, std::mt19937& rng, std::vector<int>& assign,
+                        std::vector<std::vector<double>>& centers) const {
+    size_t n = points.size();
+
+    // k-means++ seeding
+    centers.clear();
+    centers.push_back(points[rng() % n]);
+    std::vector<double> d2(n);
+    while (static_cast<int>(centers.size()) < k) {
+        double sum = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            d2[i] = std::numeric_limits<double>::max();
+            for (const auto& c : centers) {
+                d2[i] = std::min(d2[i], dist2(points[i], c));
+            }
+            sum += d2[i];
+        }
+        size_t pick = rng() % n;
+        if (sum > 0.0) {
+            double r = std::uniform_real_distribution<double>(0.0, sum)(rng);
+            for (pick = 0; pick + 1 < n && r >= d2[pick]; pick++) {
+                r -= d2[pick];
+            }
+        }
+        centers.push_back(points[pick]);
+    }
+
+    // Lloyd iterations until the assignment is stable
+    assign.assign(n, -1);
+    double sse = 0.0;
+    for (int iter = 0; iter < cfg.kmeans_iters; iter++) {
+        bool changed = false;
+        sse = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            int best = 0;
+            double best_d = dist2(points[i], centers[0]);
+            for (int c = 1; c < k; c++) {
+                double d = dist2(points[i], centers[c]);
+                if (d < best_d) {
+                    best_d = d;
+                    best = c;
+                }
+            }
+            changed |= assign[i] != best;
+            assign[i] = best;
+            sse += best_d;
+        }
+        if (!changed) {
+            break;
+        }
+
+        std::vector<int> size(k, 0);
+        for (auto& c : centers) {
+            std::fill(c.begin(), c.end(), 0.0);
+        }
+        for (size_t i = 0; i < n; i++) {
+            size[assign[i]]++;
+            for (int d = 0; d < cfg.dims; d++) {
+                centers[assign[i]][d] += points[i][d];
+            }
+        }
+        for (int c = 0; c < k; c++) {
+            if (size[c] == 0) {
+                // Empty cluster: restart it on the point farthest from its center
+                size_t far = 0;
+                double far_d = -1.0;
+                for (size_t i = 0; i < n; i++) {
+                    double d = dist2(points[i], centers[assign[i]]);
+                    if (d > far_d) {
+                        far_d = d;
+                        far = i;
+                    }
+                }
+                centers[c] = points[far];
+                continue;
+            }
+            for (double& x : centers[c]) {
+                x /= size[c];
+            }
+        }
+    }
+    return sse;
+}
+
+double SimPoint::scoreBIC(int k, const std::vector<int>& assign, double sse) const {
+    // Spherical Gaussian BIC as in X-means (Pelleg and Moore), which
+    // SimPoint uses to compare clusterings
+    double r = static_cast<double>(points.size());
+    double m = cfg.dims;
+    double var = r > k ? sse / (r - k) : 0.0;
+    var = std::max(var, 1e-12);
+
+    std::vector<int> size(k, 0);
+    for (int a : assign) {
+        size[a]++;
+    }
+    double loglik = 0.0;
+    for (int c = 0; c < k; c++) {
+        double rn = size[c];
+        if (rn == 0) {
+            continue;
+        }
+        loglik += -rn / 2.0 * std::log(2.0 * M_PI) - rn * m / 2.0 * std::log(var) -
+                  (rn - k) / 2.0 + rn * std::log(rn) - rn * std::log(r);
+    }
+    double params = (k - 1) + m * k + 1;
+    return loglik - params / 2.0 * std::log(r);
+}
+
+int SimPoint::cluster() {
+    project();
+    size_t n = points.size();
+    int kmax = std::min<int>(cfg.max_k, n);
+
+    std::mt19937 rng(cfg.seed);
+    std::vector<std::vector<int>> assigns(kmax);
+    std::vector<std::vector<std::vector<double>>> centers(kmax);
+    bic.assign(kmax, 0.0);
+    for (int k = 1; k <= kmax; k++) {
+        double best_sse = std::numeric_limits<double>::max();
+        for (int s = 0; s < cfg.kmeans_seeds; s++) {
+            std::vector<int> a;
+            std::vector<std::vector<double>> c;
+            double sse = kmeans(k, rng, a, c);
+            if (sse < best_sse) {
+                best_sse = sse;
+                assigns[k - 1] = a;
+                centers[k - 1] = c;
+            }
+        }
+        bic[k - 1] = scoreBIC(k, assigns[k - 1], best_sse);
+    }
+
+    // Smallest k whose score reaches the threshold of the observed range
+    double lo = *std::min_element(bic.begin(), bic.end());
+    double hi = *std::max_element(bic.begin(), bic.end());
+    int k = 1;
+    while (k < kmax && bic[k - 1] < lo + cfg.bic_threshold * (hi - lo)) {
+        k++;
+    }
+    assignment = assigns[k - 1];
+
+    // Representative: the member closest to its cluster's center
+    picks.clear();
+    for (int c = 0; c < k; c++) {
+        size_t best = n;
+        double best_d = std::numeric_limits<double>::max();
+        uint64_t insts = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (assignment[i] != c) {
+                continue;
+            }
+            insts += intervals[i].insts;
+            double d = dist2(points[i], centers[k - 1][c]);
+            if (d < best_d) {
+                best_d = d;
+                best = i;
+            }
+        }
+        if (best < n) {
+            picks.push_back({best, c, static_cast<double>(insts) / total_insts, 0, 0.0});
+        }
+    }
+    std::sort(picks.begin(), picks.end(),
+              [](const SimPointPick& a, const SimPointPick& b) { return a.interval < b.interval; });
+    return static_cast<int>(picks.size());
+}
+
+void SimPoint::simulate() {
+    ISS iss;
+    iss.loadWords(words);
+    Core core;
+    core.loadProgramWords(words);
+
+    // Picks are in program order, so one functional pass reaches them all
+    for (SimPointPick& p : picks) {
+        const BBVInterval& iv = intervals[p.interval];
+        uint64_t ckpt = iv.start > cfg.warmup ? iv.start - cfg.warmup : 0;
+        while (iss.getInstCount() < ckpt) {
+            iss.step();
+        }
+        core.loadArchState(iss.getState());
+
+        uint64_t warm = iv.start - ckpt;
+        uint64_t end = warm + iv.insts;
+        uint64_t max_cycles = 100 * (end + 100);
+        while (core.getCommitCount() < warm && core.getCycleCount() < max_cycles) {
+            core.tick();
+        }
+        uint64_t c0 = core.getCycleCount();
+        while (core.getCommitCount() < end && core.getCycleCount() < max_cycles) {
+            core.tick();
+        }
+        p.cycles = core.getCycleCount() - c0;
+        p.ipc = p.cycles ? static_cast<double>(iv.insts) / p.cycles : 0.0;
+    }
+}
+
+double SimPoint::estimateIPC() const {
+    double cpi = 0.0;
+    for (const SimPointPick& p : picks) {
+        cpi += p.weight * p.cycles / intervals[p.interval].insts;
+    }
+    return cpi > 0.0 ? 1.0 / cpi : 0.0;
+}
+
+double SimPoint::fullIPC(uint64_t* cycles) const {
+    Core core;
+    core.loadProgramWords(words);
+    core.reset();
+    uint64_t max_cycles = 100 * (total_insts + 100);
+    while (core.getCommitCount() < total_insts && core.getCycleCount() < max_cycles) {
+        core.tick();
+    }
+    if (cycles) {
+        *cycles = core.getCycleCount();
+    }
+    return core.getCycleCount() ? static_cast<double>(total_insts) / core.getCycleCount() : 0.0;
+}
+
+uint64_t SimPoint::getDetailedInsts() const {
+    uint64_t n = 0;
+    for (const SimPointPick& p : picks) {
+        const BBVInterval& iv = intervals[p.interval];
+        n += std::min(iv.start, cfg.warmup) + iv.insts;
+    }
+    return n;
+}
+
+bool SimPoint::writeBBV(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out) {
+        return false;
+    }
+    for (const BBVInterval& iv : intervals) {
+        out << "T";
+        for (const auto& b : iv.blocks) {
+            out << ":" << (b.first + 1) << ":" << b.second << " ";
+        }
+        out << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool SimPoint::writeSimPoints(const std::string& prefix) const {
+    std::ofstream sp(prefix + ".simpoints");
+    std::ofstream wt(prefix + ".weights");
+    if (!sp || !wt) {
+        return false;
+    }
+    for (const SimPointPick& p : picks) {
+        sp << p.interval << " " << p.cluster << "\n";
+        wt << p.weight << " " << p.cluster << "\n";
+    }
+    return static_cast<bool>(sp) && static_cast<bool>(wt);
+}
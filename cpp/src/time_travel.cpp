@@ -0,0 +1,107 @@
+#include "time_travel.h"
+#include "iss.h"
+#include <algorithm>
+#include <limits>
+
+TimeTravel::TimeTravel(Core& c, uint64_t iv, int max_snaps)
+    : core(c), interval(std::max<uint64_t>(iv, 1)),
+      max_snapshots(static_cast<size_t>(std::max(max_snaps, MIN_SNAPSHOTS))) {
+    restart();
+}
+
+void TimeTravel::restart() {
+    snaps.clear();
+    snaps.push_back(core.saveState());
+}
+
+void TimeTravel::tick() {
+    core.tick();
+    if (core.getCycleCount() % interval == 0) {
+        take();
+    }
+}
+
+void TimeTravel::run(uint64_t cycles) {
+    // Up to each snapshot point at run() speed (quiet stretches skipped)
+    while (cycles > 0) {
+        uint64_t n = std::min(cycles, interval - core.getCycleCount() % interval);
+        core.advance(n);
+        cycles -= n;
+        if (core.getCycleCount() % interval == 0) {
+            take();
+        }
+    }
+}
+
+bool TimeTravel::gotoCycle(uint64_t cycle) {
+    if (cycle < snaps.front().cycle_count) {
+        return false;
+    }
+    auto it = std::upper_bound(snaps.begin(), snaps.end(), cycle,
+                               [](uint64_t c, const CoreState& s) { return c < s.cycle_count; });
+    const CoreState& from = *(it - 1);
+    uint64_t now = core.getCycleCount();
+    if (now > cycle || now < from.cycle_count) {
+        core.restoreState(from);
+    }
+    run(cycle - core.getCycleCount());
+    return true;
+}
+
+bool TimeTravel::stepBack(uint64_t cycles) {
+    uint64_t now = core.getCycleCount();
+    return cycles <= now && gotoCycle(now - cycles);
+}
+
+uint64_t TimeTravel::hashState(const Core& c) {
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&](uint32_t v) { hash = (hash ^ v) * 1099511628211ull; };
+
+    mix(static_cast<uint32_t>(c.getCycleCount()));
+    mix(static_cast<uint32_t>(c.getCycleCount() >> 32));
+    mix(static_cast<uint32_t>(c.getCommitCount()));
+    mix(static_cast<uint32_t>(c.getCommitCount() >> 32));
+    for (reg_t r = 0; r < N_ARCH_REGS; r++) {
+        mix(c.getArchRegValue(r));
+        mix(c.getArchMapping(r));
+    }
+    for (int p = 0; p < N_PHYS_REGS; p++) {
+        mix(c.getPhysRegValue(static_cast<preg_t>(p)));
+        mix(c.getPhysRegValid(static_cast<preg_t>(p)));
+    }
+    for (int w = 0; w < ISS::DMEM_WORDS; w++) {
+        mix(c.readMemWord(w * 4));
+    }
+    return hash;
+}
+
+void TimeTravel::take() {
+    // A snapshot already held for this cycle has the same state
+    uint64_t cycle = core.getCycleCount();
+    auto it = std::lower_bound(snaps.begin(), snaps.end(), cycle,
+                               [](const CoreState& s, uint64_t c) { return s.cycle_count < c; });
+    if (it != snaps.end() && it->cycle_count == cycle) {
+        return;
+    }
+    snaps.insert(it, core.saveState());
+    thin();
+}
+
+void TimeTravel::thin() {
+    // Drop the inner snapshot with the least gap left behind per cycle of
+    // age, keeping the spacing roughly proportional to age
+    while (snaps.size() > max_snapshots) {
+        uint64_t newest = snaps.back().cycle_count;
+        size_t victim = 1;
+        double best = std::numeric_limits<double>::max();
+        for (size_t i = 1; i + 1 < snaps.size(); i++) {
+            double gap = static_cast<double>(snaps[i + 1].cycle_count - snaps[i - 1].cycle_count);
+            double cost = gap / static_cast<double>(newest - snaps[i].cycle_count);
+            if (cost < best) {
+                best = cost;
+                victim = i;
+            }
+        }
+        snaps.erase(snaps.begin() + static_cast<std::ptrdiff_t>(victim));
+    }
+}
@@ -0,0 +1,415 @@
+#include "workload_gen.h"
+#include "rv32i.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+constexpr reg_t REG_LINK = 1;    // JAL/JALR link, epilogue base
+constexpr reg_t REG_TMP = 2;     // JALR target, epilogue load data
+constexpr reg_t REG_A0 = 10;
+constexpr reg_t REG_A1 = 11;
+constexpr int MAX_CHECK_STORES = 8;
+constexpr int MAX_CONTROL_SLOTS = 5;  // addi + jalr + 3 skipped slots
+
+} // namespace
+
+WorkloadGen::WorkloadGen(const GenConfig& config) : cfg(config), rng(config.seed), next_chain(0) {
+    cfg.length = std::min(std::max(cfg.length, 32), ISS::IMEM_WORDS);
+    cfg.ilp = std::max(cfg.ilp, 1);
+    cfg.chain_len = std::max(cfg.chain_len, 1);
+    cfg.regs = std::min(std::max(cfg.regs, cfg.ilp + 2), 25);
+
+    for (reg_t r = 5; r < N_ARCH_REGS && static_cast<int>(pool.size()) < cfg.regs; r++) {
+        if (r != REG_A0 && r != REG_A1) pool.push_back(r);
+    }
+}
+
+GenProgram WorkloadGen::generate() {
+    words.clear();
+    executed.clear();
+    store_addrs.clear();
+    last_write.assign(N_ARCH_REGS, 0);
+    chains.assign(cfg.ilp, Chain{0, 0});
+    next_chain = 0;
+    iss.reset();
+
+    // Body
+    while (static_cast<int>(words.size()) + MAX_CONTROL_SLOTS + epilogueSize() < cfg.length) {
+        double r = std::generate_canonical<double, 32>(rng);
+        if (r < cfg.branch_freq) {
+            genControl();
+        } else if (r < cfg.branch_freq + cfg.mem_ratio) {
+            genMem(true);
+        } else {
+            genAlu(true);
+        }
+    }
+
+    genEpilogue();
+
+    // Reference execution of the finished image
+    ISS ref;
+    ref.loadWords(words);
+    ref.run(1000000);
+
+    GenProgram prog;
+    prog.words = words;
+    prog.a0 = ref.getReg(REG_A0);
+    prog.a1 = ref.getReg(REG_A1);
+    prog.dyn_insts = ref.getInstCount();
+    return prog;
+}
+
+void WorkloadGen::emit(uint32_t instr, bool exec) {
+    words.push_back(instr);
+    executed.push_back(exec);
+    if (exec) {
+        ISS::StepInfo s = iss.execute(instr);
+        if (s.rd_written) last_write[s.rd] = words.size();
+    }
+}
+
+void WorkloadGen::genAlu(bool exec) {
+    if (!exec) {
+        // Wrong-path filler: never retires, only has to rename and squash
+        reg_t rd = pool[uniform(0, pool.size() - 1)];
+        bool m = cfg.muldiv_ratio > 0 && chance(cfg.muldiv_ratio);
+        bool mv = cfg.move_ratio > 0 && chance(cfg.move_ratio);
+        emit(m ? rv32::div(rd, pickSrc(), pickSrc()) :
+             mv ? rv32::addi(rd, pickSrc(), 0) : rv32::add(rd, pickSrc(), pickSrc()), false);
+        return;
+    }
+
+    Chain& c = chains[next_chain];
+    next_chain = (next_chain + 1) % cfg.ilp;
+    reg_t rd = pickDest();
+
+    bool pair = cfg.fuse_ratio > 0 && chance(cfg.fuse_ratio);
+
+    if (c.head == 0 || c.len >= cfg.chain_len) {
+        // Start a new chain from constants
+        if (pair) {
+            // 32-bit constant: lui + addi
+            emit(rv32::lui(rd, rng() & 0xFFFFF));
+            emit(rv32::addi(rd, rd, uniform(-2048, 2047)));
+        } else if (chance(0.5)) {
+            emit(rv32::lui(rd, rng() & 0xFFFFF));
+        } else {
+            emit(rv32::addi(rd, 0, uniform(-2048, 2047)));
+        }
+        c.head = rd;
+        c.len = 1;
+        return;
+    }
+
+    reg_t rs1 = c.head;
+    if (pair) {
+        // Indexed load: add + load through the sum. DMem wraps, so any
+        // sum reaches the picked address with a 12-bit offset.
+        bool byte = chance(0.25);
+        reg_t rs2 = pickSrc();
+        uint32_t addr = pickAddr(byte ? LSSize::B : LSSize::W);
+        uint32_t diff = (addr - iss.getReg(rs1) - iss.getReg(rs2)) & 0xFFF;
+        int32_t imm = diff < 2048 ? static_cast<int32_t>(diff) : static_cast<int32_t>(diff) - 4096;
+        emit(rv32::add(rd, rs1, rs2));
+        emit(byte ? rv32::lbu(rd, rd, imm) : rv32::lw(rd, rd, imm));
+        c.head = rd;
+        c.len += 2;
+        return;
+    }
+    if (cfg.muldiv_ratio > 0 && chance(cfg.muldiv_ratio)) {
+        reg_t rs2 = pickSrc();
+        uint32_t instr;
+        switch (uniform(0, 7)) {
+            case 0:  instr = rv32::mul(rd, rs1, rs2); break;
+            case 1:  instr = rv32::mulh(rd, rs1, rs2); break;
+            case 2:  instr = rv32::mulhsu(rd, rs1, rs2); break;
+            case 3:  instr = rv32::mulhu(rd, rs1, rs2); break;
+            case 4:  instr = rv32::div(rd, rs1, rs2); break;
+            case 5:  instr = rv32::divu(rd, rs1, rs2); break;
+            case 6:  instr = rv32::rem(rd, rs1, rs2); break;
+            default: instr = rv32::remu(rd, rs1, rs2); break;
+        }
+        emit(instr);
+        c.head = rd;
+        c.len++;
+        return;
+    }
+    if (cfg.move_ratio > 0 && chance(cfg.move_ratio)) {
+        // Register copies, then idioms that always give zero
+        uint32_t instr;
+        switch (uniform(0, 6)) {
+            case 0:  instr = rv32::addi(rd, rs1, 0); break;
+            case 1:  instr = rv32::add(rd, 0, rs1); break;
+            case 2:  instr = rv32::or_(rd, rs1, 0); break;
+            case 3:  instr = rv32::srli(rd, rs1, 0); break;
+            case 4:  instr = rv32::sub(rd, rs1, rs1); break;
+            case 5:  instr = rv32::andi(rd, rs1, 0); break;
+            default: instr = rv32::addi(rd, 0, 0); break;
+        }
+        emit(instr);
+        c.head = rd;
+        c.len++;
+        return;
+    }
+    int32_t imm = uniform(-2048, 2047);
+    uint32_t instr;
+    switch (uniform(0, 10)) {
+        case 0:  instr = rv32::addi(rd, rs1, imm); break;
+        case 1:  instr = rv32::ori(rd, rs1, imm); break;
+        case 2:  instr = rv32::andi(rd, rs1, imm); break;
+        case 3:  instr = rv32::sltiu(rd, rs1, imm); break;
+        case 4:  instr = rv32::srli(rd, rs1, uniform(0, 31)); break;
+        case 5:  instr = rv32::srai(rd, rs1, uniform(0, 31)); break;
+        case 6:  instr = rv32::add(rd, rs1, pickSrc()); break;
+        case 7:  instr = rv32::sub(rd, rs1, pickSrc()); break;
+        case 8:  instr = rv32::and_(rd, rs1, pickSrc()); break;
+        case 9:  instr = rv32::or_(rd, rs1, pickSrc()); break;
+        default: instr = rv32::sra(rd, rs1, pickSrc()); break;
+    }
+    emit(instr);
+    c.head = rd;
+    c.len++;
+}
+
+void WorkloadGen::genMem(bool exec) {
+    bool is_store = chance(cfg.store_ratio);
+
+    if (is_store) {
+        LSSize size = chance(0.25) ? LSSize::H : LSSize::W;
+        uint32_t addr = pickAddr(size);
+        reg_t data = chains[uniform(0, cfg.ilp - 1)].head;
+        reg_t base;
+        int32_t imm;
+        addrOperands(addr, base, imm);
+        emit(size == LSSize::H ? rv32::sh(data, base, imm) : rv32::sw(data, base, imm), exec);
+        if (exec) {
+            store_addrs.push_back(addr & 0xFFC);
+        }
+        return;
+    }
+
+    // Load: aliasing loads hit a recent store, possibly a narrower slice of it
+    bool byte = chance(0.25);
+    uint32_t addr;
+    if (!store_addrs.empty() && chance(cfg.alias_rate)) {
+        int back = uniform(0, std::min<int>(4, store_addrs.size()) - 1);
+        addr = store_addrs[store_addrs.size() - 1 - back];
+        if (byte) addr += uniform(0, 3);
+    } else {
+        addr = pickAddr(byte ? LSSize::B : LSSize::W);
+    }
+
+    reg_t base;
+    int32_t imm;
+    addrOperands(addr, base, imm);
+
+    if (!exec) {
+        emit(rv32::lw(pool[uniform(0, pool.size() - 1)], base, imm), false);
+        return;
+    }
+
+    // Loads extend a chain
+    Chain& c = chains[next_chain];
+    next_chain = (next_chain + 1) % cfg.ilp;
+    reg_t rd = pickDest();
+    emit(byte ? rv32::lbu(rd, base, imm) : rv32::lw(rd, base, imm));
+    c.head = rd;
+    c.len++;
+}
+
+void WorkloadGen::genControl() {
+    int skip = uniform(1, 3);
+    int32_t off = 4 * (skip + 1);
+    bool taken = true;
+    int kind = uniform(0, 19);
+
+    if (kind < 14) {
+        // Conditional branch steered to the requested outcome
+        taken = chance(cfg.taken_rate);
+        reg_t rs1 = chance(0.2) ? 0 : pool[uniform(0, pool.size() - 1)];
+        reg_t rs2 = chance(0.2) ? 0 : pool[uniform(0, pool.size() - 1)];
+        if (cfg.fuse_ratio > 0 && chance(cfg.fuse_ratio)) {
+            // Compare-and-branch: test a fresh ALU result against x0
+            reg_t t = pickDest();
+            reg_t src = pool[uniform(0, pool.size() - 1)];
+            switch (uniform(0, 3)) {
+                case 0:  emit(rv32::andi(t, src, uniform(1, 255))); break;
+                case 1:  emit(rv32::sltiu(t, src, uniform(0, 2047))); break;
+                case 2:  emit(rv32::srli(t, src, uniform(0, 31))); break;
+                default: emit(rv32::sub(t, src, pickSrc())); break;
+            }
+            rs1 = chance(0.5) ? t : 0;
+            rs2 = rs1 == 0 ? t : 0;
+        }
+        xlen_t a = iss.getReg(rs1);
+        xlen_t b = iss.getReg(rs2);
+
+        std::vector<uint32_t> ok;
+        const uint32_t all[] = {rv32::F3_BEQ, rv32::F3_BNE, rv32::F3_BLT,
+                                rv32::F3_BGE, rv32::F3_BLTU, rv32::F3_BGEU};
+        for (uint32_t f3 : all) {
+            bool t = false;
+            switch (f3) {
+                case rv32::F3_BEQ:  t = a == b; break;
+                case rv32::F3_BNE:  t = a != b; break;
+                case rv32::F3_BLT:  t = static_cast<int32_t>(a) < static_cast<int32_t>(b); break;
+                case rv32::F3_BGE:  t = static_cast<int32_t>(a) >= static_cast<int32_t>(b); break;
+                case rv32::F3_BLTU: t = a < b; break;
+                default:            t = a >= b; break;
+            }
+            if (t == taken) ok.push_back(f3);
+        }
+        emit(rv32::branch(ok[uniform(0, ok.size() - 1)], rs1, rs2, off));
+    } else if (kind < 17) {
+        emit(rv32::jal(chance(0.5) ? REG_LINK : 0, off));
+    } else {
+        // jalr through a register set just before it
+        int32_t bias = uniform(0, 3) * 4;
+        uint32_t target = (words.size() + 2 + skip) * 4;
+        emit(rv32::addi(REG_TMP, 0, target - bias));
+        reg_t link = chance(0.5) ? REG_LINK : 0;
+        if (link == REG_LINK && cfg.fuse_ratio > 0 && chance(cfg.fuse_ratio)) {
+            link = REG_TMP;     // link into the target register: fusible too
+        }
+        emit(rv32::jalr(link, REG_TMP, bias));
+    }
+
+    // Skipped slots are wrong-path work when taken, ordinary body otherwise
+    for (int i = 0; i < skip; i++) {
+        if (chance(cfg.mem_ratio)) {
+            genMem(!taken);
+        } else {
+            genAlu(!taken);
+        }
+    }
+}
+
+void WorkloadGen::genEpilogue() {
+    // a0 = sum of every pool register
+    emit(rv32::addi(REG_A0, 0, 0));
+    for (reg_t r : pool) {
+        emit(rv32::add(REG_A0, REG_A0, r));
+    }
+
+    // a1 = sum of the most recently stored words
+    std::vector<uint32_t> check;
+    for (auto it = store_addrs.rbegin(); it != store_addrs.rend() &&
+         static_cast<int>(check.size()) < MAX_CHECK_STORES; ++it) {
+        if (std::find(check.begin(), check.end(), *it) == check.end()) {
+            check.push_back(*it);
+        }
+    }
+    emit(rv32::lui(REG_LINK, 1));
+    emit(rv32::addi(REG_A1, 0, 0));
+    for (uint32_t addr : check) {
+        if (addr < 2048) {
+            emit(rv32::lw(REG_TMP, 0, addr));
+        } else {
+            emit(rv32::lw(REG_TMP, REG_LINK, static_cast<int32_t>(addr) - 4096));
+        }
+        emit(rv32::add(REG_A1, REG_A1, REG_TMP));
+    }
+
+    // Park
+    emit(rv32::jal(0, 0));
+}
+
+reg_t WorkloadGen::pickDest() {
+    // Any pool register that is not currently a chain head
+    std::vector<reg_t> cand;
+    for (reg_t r : pool) {
+        bool head = false;
+        for (const Chain& c : chains) {
+            if (c.head == r) head = true;
+        }
+        if (!head) cand.push_back(r);
+    }
+    return cand[uniform(0, cand.size() - 1)];
+}
+
+reg_t WorkloadGen::pickSrc() {
+    // The least recently written register: usually committed, so reading
+    // it adds no dependency between chains
+    reg_t best = pool[0];
+    for (reg_t r : pool) {
+        if (last_write[r] < last_write[best]) best = r;
+    }
+    return best;
+}
+
+uint32_t WorkloadGen::pickAddr(LSSize size) {
+    uint32_t addr = uniform(0, 4095);
+    switch (size) {
+        case LSSize::W: return addr & ~0x3u;
+        case LSSize::H: return addr & ~0x1u;
+        default:        return addr;
+    }
+}
+
+void WorkloadGen::addrOperands(uint32_t addr, reg_t& base, int32_t& imm) {
+    // Prefer a chain head as base, so the access depends on in-flight work
+    for (const Chain& c : chains) {
+        if (c.head == 0) continue;
+        int64_t diff = static_cast<int64_t>(addr) - static_cast<int64_t>(iss.getReg(c.head));
+        if (diff >= -2048 && diff <= 2047 && chance(0.5)) {
+            base = c.head;
+            imm = static_cast<int32_t>(diff);
+            return;
+        }
+    }
+    // x0 base; the data memory index wraps, so addr - 4096 hits the same word
+    base = 0;
+    imm = (addr < 2048) ? static_cast<int32_t>(addr) : static_cast<int32_t>(addr) - 4096;
+}
+
+bool WorkloadGen::chance(double p) {
+    return std::generate_canonical<double, 32>(rng) < p;
+}
+
+int WorkloadGen::uniform(int lo, int hi) {
+    return lo + static_cast<int>(rng() % static_cast<uint32_t>(hi - lo + 1));
+}
+
+int WorkloadGen::epilogueSize() const {
+    return 1 + static_cast<int>(pool.size()) + 2 + 2 * MAX_CHECK_STORES + 1;
+}
+
+bool WorkloadGen::writeInstMem(const std::string& filename, const std::vector<uint32_t>& words) {
+    std::ofstream f(filename);
+    if (!f.is_open()) {
+        std::cerr << "[gen] ERROR: Could not open file: " << filename << std::endl;
+        return false;
+    }
+    char buf[8];
+    for (uint32_t w : words) {
+        for (int b = 0; b < 4; b++) {
+            std::snprintf(buf, sizeof(buf), "%02x", (w >> (8 * b)) & 0xFF);
+            f << buf << "\n";
+        }
+    }
+    return true;
+}
+
+bool WorkloadGen::writeExpected(const std::string& filename, const GenProgram& prog,
+                                const std::string& title) {
+    std::ofstream f(filename);
+    if (!f.is_open()) {
+        std::cerr << "[gen] ERROR: Could not open file: " << filename << std::endl;
+        return false;
+    }
+    char buf[64];
+    f << "# " << title << ":\n";
+    for (size_t i = 0; i < prog.words.size(); i++) {
+        std::snprintf(buf, sizeof(buf), "    %zx:        %08x        ", i * 4, prog.words[i]);
+        f << buf << rv32::disasm(prog.words[i]) << "\n";
+    }
+    f << "#end\n\n";
+    f << "(Values are in signed decimal)\n";
+    f << "# a0 = " << static_cast<int32_t>(prog.a0) << "\n";
+    f << "# a1 = " << static_cast<int32_t>(prog.a1) << "\n";
+    return true;
+}
@@ -0,0 +1,115 @@
+#include "free_list.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// Module-level checks that the end-to-end runs cannot reach directly.
+// Prints one line per failure and "UNIT CHECK PASS" / "UNIT CHECK FAIL".
+
+namespace {
+
+int checks = 0;
+int failures = 0;
+
+void expect(bool ok, const std::string& what) {
+    checks++;
+    if (!ok) {
+        failures++;
+        std::cout << "FAIL: " << what << std::endl;
+    }
+}
+
+// The cached pick must be the scan's answer
+void expectPick(const FreeList& fl, const std::string& what) {
+    expect(fl.getAllocPreg() == fl.findFree(),
+           what + ": getAllocPreg() = " + std::to_string(fl.getAllocPreg()) +
+           ", findFree() = " + std::to_string(fl.findFree()));
+}
+
+// tick() arguments for one commit-side free
+void commitFree(FreeList& fl, bool flush, preg_t preg) {
+    fl.tick(flush, false, 0, false, true, preg, false, 0, false, 0);
+}
+
+void testReleaseArchPreg() {
+    FreeList fl;
+    fl.release(5);      // ROB walk undoing a move that shared x5's reset mapping
+    expectPick(fl, "release(P5) after reset");
+    expect(fl.getAllocPreg() == N_ARCH_REGS, "release(P5) must not be allocated next");
+}
+
+void testFlushFreeArchPreg() {
+    FreeList fl;
+    commitFree(fl, true, 7);    // initial mapping of x7 committed over during a flush
+    expectPick(fl, "flush with commit free of P7");
+}
+
+void testFlushFreeAfterDrain() {
+    // Allocate every preg, then free an architectural one and a renamed
+    // one under flush: only the renamed one may become the pick
+    FreeList fl;
+    while (fl.hasFree()) {
+        fl.tick(false, false, 0, true, false, 0, false, 0, false, 0);
+    }
+    expectPick(fl, "drained");
+    commitFree(fl, true, 3);
+    expectPick(fl, "drained, flush free of P3");
+    expect(!fl.hasFree(), "drained, P3 must not count as free");
+    fl.release(40);
+    expectPick(fl, "drained, release(P40)");
+    commitFree(fl, true, 35);
+    expectPick(fl, "drained, flush free of P35");
+    expect(fl.getAllocPreg() == 35, "drained, P35 is the lowest free preg");
+}
+
+void testRandomSequence() {
+    // Mixed allocations, commit frees (with and without flush) and walk
+    // releases of any preg, including architectural ones
+    FreeList fl;
+    uint32_t x = 12345;
+    auto next = [&x]() {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return x;
+    };
+    for (int i = 0; i < 20000; i++) {
+        uint32_t r = next();
+        preg_t p = static_cast<preg_t>(1 + (r >> 8) % (N_PHYS_REGS - 1));
+        switch (r & 3) {
+        case 0:
+            fl.tick(false, false, 0, true, false, 0, false, 0, false, 0);
+            break;
+        case 1:
+            commitFree(fl, (r >> 4) & 1, p);
+            break;
+        case 2:
+            fl.release(p);
+            break;
+        default:
+            fl.tick(false, false, 0, true, true, p, false, 0, false, 0);
+            break;
+        }
+        if (fl.getAllocPreg() != fl.findFree()) {
+            expectPick(fl, "random step " + std::to_string(i));
+            return;
+        }
+    }
+    expect(true, "random sequence");
+}
+
+} // namespace
+
+int main() {
+    testReleaseArchPreg();
+    testFlushFreeArchPreg();
+    testFlushFreeAfterDrain();
+    testRandomSequence();
+
+    if (failures == 0) {
+        std::cout << "UNIT CHECK PASS (" << checks << " checks)" << std::endl;
+        return 0;
+    }
+    std::cout << "UNIT CHECK FAIL (" << failures << " of " << checks << " checks)" << std::endl;
+    return 1;
+}
@@ -0,0 +1,168 @@
+#include "batch_core.h"
+#include "core.h"
+#include "workload_gen.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct BatchOptions {
+    int lanes = 16;
+    int batches = 4;
+    uint64_t cycles = 5000;
+    uint32_t seed = 1;
+    bool verify = true;
+};
+
+void printUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]" << std::endl;
+    std::cerr << "  --lanes N          Lanes per batch: 4, 8, 16, 32 or 64 (default: 16)" << std::endl;
+    std::cerr << "  --batches N        Batches to run, lanes*N instances (default: 4)" << std::endl;
+    std::cerr << "  --cycles N         Cycles per instance (default: 5000)" << std::endl;
+    std::cerr << "  --seed N           First generator seed, one seed per instance (default: 1)" << std::endl;
+    std::cerr << "  --no-verify        Only time, skip the comparison against Core" << std::endl;
+}
+
+// One generated program per instance; the seed also varies the mix
+std::vector<uint32_t> instanceProgram(uint32_t seed) {
+    GenConfig cfg;
+    cfg.seed = seed;
+    cfg.branch_freq = 0.05 + 0.05 * (seed % 4);
+    cfg.mem_ratio = 0.15 + 0.05 * (seed % 5);
+    cfg.ilp = 1 + seed % 3;
+    return WorkloadGen(cfg).generate().words;
+}
+
+double seconds(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+template <int LANES>
+int runBatches(const BatchOptions& opt) {
+    int n = LANES * opt.batches;
+    std::vector<std::vector<uint32_t>> progs;
+    for (int i = 0; i < n; i++) {
+        progs.push_back(instanceProgram(opt.seed + i));
+    }
+
+    // Scalar reference, one Core per instance
+    std::vector<std::unique_ptr<Core>> cores;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        auto core = std::make_unique<Core>();
+        core->loadProgramWords(progs[i]);
+        core->reset();
+        for (uint64_t c = 0; c < opt.cycles; c++) {
+            core->tick();
+        }
+        cores.push_back(std::move(core));
+    }
+    double scalar_sec = seconds(t0);
+
+    // Batched, LANES instances per BatchCore
+    std::vector<std::unique_ptr<BatchCore<LANES>>> batches;
+    t0 = std::chrono::steady_clock::now();
+    for (int b = 0; b < opt.batches; b++) {
+        auto batch = std::make_unique<BatchCore<LANES>>();
+        for (int l = 0; l < LANES; l++) {
+            batch->loadProgramWords(l, progs[b * LANES + l]);
+        }
+        batch->reset();
+        batch->run(opt.cycles);
+        batches.push_back(std::move(batch));
+    }
+    double batch_sec = seconds(t0);
+
+    int mismatches = 0;
+    uint64_t commits = 0;
+    uint64_t halted = 0;
+    if (opt.verify) {
+        for (int i = 0; i < n; i++) {
+            const Core& c = *cores[i];
+            const BatchCore<LANES>& bc = *batches[i / LANES];
+            int l = i % LANES;
+            bool ok = c.getCommitCount() == bc.getCommitCount(l) &&
+                      c.getRecoverCount() == bc.getRecoverCount(l) &&
+                      c.getLastCommitPC() == bc.getLastCommitPC(l) &&
+                      c.getROBCount() == bc.getROBCount(l);
+            for (int r = 1; r < N_ARCH_REGS && ok; r++) {
+                ok = c.getArchRegValue(r) == bc.getArchRegValue(l, r);
+            }
+            for (uint32_t w = 0; w < BatchCore<LANES>::DMEM_WORDS && ok; w++) {
+                ok = c.readMemWord(w * 4) == bc.readMemWord(l, w * 4);
+            }
+            if (!ok) {
+                if (mismatches < 8) {
+                    std::cout << "MISMATCH instance " << i << " (seed " << (opt.seed + i)
+                              << "): commits " << c.getCommitCount() << " vs "
+                              << bc.getCommitCount(l) << ", a0 0x" << std::hex
+                              << c.getArchRegValue(10) << " vs 0x" << bc.getArchRegValue(l, 10)
+                              << std::dec << std::endl;
+                }
+                mismatches++;
+            }
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        commits += batches[i / LANES]->getCommitCount(i % LANES);
+        halted += batches[i / LANES]->isHalted(i % LANES);
+    }
+
+    double inst_cycles = static_cast<double>(n) * opt.cycles;
+    std::cout << "============================================================" << std::endl;
+    std::cout << "OOOP batched lockstep: " << n << " instances, " << LANES << " lanes x "
+              << opt.batches << " batches, " << opt.cycles << " cycles" << std::endl;
+    std::cout << "============================================================" << std::endl;
+    std::cout << "commits = " << commits << ", halted = " << halted << "/" << n << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "scalar Core : " << scalar_sec << " s, "
+              << inst_cycles / scalar_sec / 1e6 << " M instance-cycles/s" << std::endl;
+    std::cout << "BatchCore   : " << batch_sec << " s, "
+              << inst_cycles / batch_sec / 1e6 << " M instance-cycles/s" << std::endl;
+    std::cout << std::setprecision(2) << "speedup     : " << scalar_sec / batch_sec << "x" << std::endl;
+    if (opt.verify) {
+        if (mismatches == 0) {
+            std::cout << "BATCH CHECK PASS (" << n << " instances bit-identical to Core)" << std::endl;
+        } else {
+            std::cout << "BATCH CHECK FAIL (" << mismatches << "/" << n << " instances differ)" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    BatchOptions opt;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                printUsage(argv[0]);
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (a == "--lanes") opt.lanes = std::stoi(next());
+        else if (a == "--batches") opt.batches = std::stoi(next());
+        else if (a == "--cycles") opt.cycles = std::stoull(next());
+        else if (a == "--seed") opt.seed = std::stoul(next());
+        else if (a == "--no-verify") opt.verify = false;
+        else if (a == "-h" || a == "--help") { printUsage(argv[0]); return 0; }
+        else { printUsage(argv[0]); return 1; }
+    }
+
+    switch (opt.lanes) {
+        case 4: return runBatches<4>(opt);
+        case 8: return runBatches<8>(opt);
+        case 16: return runBatches<16>(opt);
+        case 32: return runBatches<32>(opt);
+        case 64: return runBatches<64>(opt);
+        default:
+            std::cerr << "ERROR: --lanes must be 4, 8, 16, 32 or 64" << std::endl;
+            return 1;
+    }
+}
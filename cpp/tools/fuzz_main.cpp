@@ -0,0 +1,113 @@
+#include "fuzz.h"
+#include "rv32i.h"
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+void printUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]" << std::endl;
+    std::cerr << "  --threads N        Host threads, 0 = one per host CPU (default: 0)" << std::endl;
+    std::cerr << "  --programs N       Stop after N cases, 0 = no limit (default: 0)" << std::endl;
+    std::cerr << "  --seconds F        Time limit, 0 = none (default: 10)" << std::endl;
+    std::cerr << "  --seed N           Case generator seed (default: 1)" << std::endl;
+    std::cerr << "  --max-failures N   Stop after N failing cases (default: 1)" << std::endl;
+    std::cerr << "  --no-minimize      Keep failing programs as generated" << std::endl;
+    std::cerr << "  --min-runs N       Executions spent minimizing one failure (default: 2000)" << std::endl;
+    std::cerr << "  --out DIR          Directory for failing programs (default: fuzz_out)" << std::endl;
+    std::cerr << "  --quiet            No per-second progress lines" << std::endl;
+}
+
+void printStats(const FuzzStats& s, std::ostream& os) {
+    os << "[fuzz] " << std::fixed << std::setprecision(1) << s.host_sec << "s  "
+       << s.programs << " programs  " << std::setprecision(0) << s.execsPerSec() << " exec/s  "
+       << "coverage " << s.coverage << "/" << Fuzzer::N_FEATURES << "  corpus " << s.corpus
+       << "  failures " << s.failures << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    FuzzConfig cfg;
+    std::string out_dir = "fuzz_out";
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                printUsage(argv[0]);
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (a == "--threads") cfg.threads = std::stoi(next());
+        else if (a == "--programs") cfg.programs = std::stoull(next());
+        else if (a == "--seconds") cfg.seconds = std::stod(next());
+        else if (a == "--seed") cfg.seed = std::stoul(next());
+        else if (a == "--max-failures") cfg.max_failures = std::stoi(next());
+        else if (a == "--no-minimize") cfg.minimize = false;
+        else if (a == "--min-runs") cfg.minimize_runs = std::stoull(next());
+        else if (a == "--out") out_dir = next();
+        else if (a == "--quiet") quiet = true;
+        else if (a == "-h" || a == "--help") { printUsage(argv[0]); return 0; }
+        else { printUsage(argv[0]); return 1; }
+    }
+    if (cfg.programs == 0 && cfg.seconds <= 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Fuzzer fuzzer(cfg);
+    std::cout << "============================================================" << std::endl;
+    std::cout << "OOOP differential fuzzer: Core vs ISS, " << fuzzer.getNumThreads()
+              << " host threads, seed " << cfg.seed << std::endl;
+    std::cout << "============================================================" << std::endl;
+    if (quiet) {
+        fuzzer.run();
+    } else {
+        fuzzer.run([](const FuzzStats& s) { printStats(s, std::cout); });
+    }
+    FuzzStats st = fuzzer.getStats();
+    printStats(st, std::cout);
+    std::cout << "simulated " << st.cycles << " cycles, " << st.commits << " commits" << std::endl;
+
+    const auto& failures = fuzzer.getFailures();
+    if (!failures.empty()) {
+        std::filesystem::create_directories(out_dir);
+    }
+    for (size_t i = 0; i < failures.size(); i++) {
+        const FuzzFailure& f = failures[i];
+        std::string base = out_dir + "/fail" + std::to_string(i + 1);
+
+        ISS ref;
+        ref.loadWords(f.minimized);
+        ref.run(1000000);
+        GenProgram prog = {f.minimized, ref.getReg(10), ref.getReg(11), ref.getInstCount()};
+        int live = 0;
+        for (uint32_t w : f.minimized) live += w != rv32::NOP;
+
+        std::cout << std::endl << "FAIL #" << i + 1 << ": " << f.what << std::endl;
+        std::cout << "  gen seed " << f.fc.gen.seed << ", " << f.words.size()
+                  << " instructions, " << live << " left after " << f.min_runs
+                  << " minimizing runs" << std::endl;
+        if (f.minimized != f.words) {
+            std::cout << "  minimized: " << Fuzzer::check(f.fc, f.minimized) << std::endl;
+        }
+        if (WorkloadGen::writeInstMem(base + ".txt", f.minimized) &&
+            WorkloadGen::writeExpected(base + ".exp", prog, "fuzz failure " + std::to_string(i + 1))) {
+            std::cout << "  replay: ./ooop_sim " << base << ".txt 20000 " << base << ".exp "
+                      << f.fc.simArgs() << std::endl;
+        }
+    }
+
+    std::cout << std::endl;
+    if (failures.empty()) {
+        std::cout << "FUZZ CHECK PASS (" << st.programs << " programs, " << std::fixed
+                  << std::setprecision(0) << st.execsPerSec() << " exec/s, coverage "
+                  << st.coverage << "/" << Fuzzer::N_FEATURES << ")" << std::endl;
+        return 0;
+    }
+    std::cout << "FUZZ CHECK FAIL (" << failures.size() << " of " << st.programs
+              << " programs)" << std::endl;
+    return 1;
+}
@@ -0,0 +1,83 @@
+#include "workload_gen.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+void printUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " -o <inst_mem_file.txt> [options]" << std::endl;
+    std::cerr << "  -o FILE            Output instruction memory file (byte format)" << std::endl;
+    std::cerr << "  --expected FILE    Also write a listing with the expected a0/a1" << std::endl;
+    std::cerr << "  --seed N           RNG seed (default: 1)" << std::endl;
+    std::cerr << "  --length N         Static instructions, max 512 (default: 256)" << std::endl;
+    std::cerr << "  --chain N          Ops per dependency chain (default: 4)" << std::endl;
+    std::cerr << "  --ilp N            Independent chains interleaved (default: 2)" << std::endl;
+    std::cerr << "  --branch-freq F    Fraction of branches/jumps (default: 0.10)" << std::endl;
+    std::cerr << "  --taken-rate F     Fraction of branches taken (default: 0.30)" << std::endl;
+    std::cerr << "  --mem-ratio F      Fraction of loads/stores (default: 0.25)" << std::endl;
+    std::cerr << "  --store-ratio F    Stores among memory ops (default: 0.40)" << std::endl;
+    std::cerr << "  --alias F          Loads reusing a recent store address (default: 0.50)" << std::endl;
+    std::cerr << "  --muldiv F         RV32M among chained ALU ops (default: 0)" << std::endl;
+    std::cerr << "  --moves F          Moves / zero idioms among chained ALU ops (default: 0)" << std::endl;
+    std::cerr << "  --fusible F        Fusible pairs among ALU ops and control (default: 0)" << std::endl;
+    std::cerr << "  --regs N           Destination registers in use, max 25 (default: 16)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    GenConfig cfg;
+    std::string out_file;
+    std::string expected_file;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                printUsage(argv[0]);
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (a == "-o") out_file = next();
+        else if (a == "--expected") expected_file = next();
+        else if (a == "--seed") cfg.seed = std::stoul(next());
+        else if (a == "--length") cfg.length = std::stoi(next());
+        else if (a == "--chain") cfg.chain_len = std::stoi(next());
+        else if (a == "--ilp") cfg.ilp = std::stoi(next());
+        else if (a == "--branch-freq") cfg.branch_freq = std::stod(next());
+        else if (a == "--taken-rate") cfg.taken_rate = std::stod(next());
+        else if (a == "--mem-ratio") cfg.mem_ratio = std::stod(next());
+        else if (a == "--store-ratio") cfg.store_ratio = std::stod(next());
+        else if (a == "--alias") cfg.alias_rate = std::stod(next());
+        else if (a == "--muldiv") cfg.muldiv_ratio = std::stod(next());
+        else if (a == "--moves") cfg.move_ratio = std::stod(next());
+        else if (a == "--fusible") cfg.fuse_ratio = std::stod(next());
+        else if (a == "--regs") cfg.regs = std::stoi(next());
+        else if (a == "-h" || a == "--help") { printUsage(argv[0]); return 0; }
+        else { printUsage(argv[0]); return 1; }
+    }
+
+    if (out_file.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    WorkloadGen gen(cfg);
+    GenProgram prog = gen.generate();
+
+    if (!WorkloadGen::writeInstMem(out_file, prog.words)) {
+        return 1;
+    }
+    if (!expected_file.empty() &&
+        !WorkloadGen::writeExpected(expected_file, prog, "gen seed " + std::to_string(cfg.seed))) {
+        return 1;
+    }
+
+    std::cout << "[gen] Wrote " << prog.words.size() << " instructions to " << out_file
+              << " (" << prog.dyn_insts << " retire before the final loop)" << std::endl;
+    std::cout << "a0 (x10) = 0x" << std::hex << std::setw(8) << std::setfill('0')
+              << prog.a0 << " (" << std::dec << static_cast<int32_t>(prog.a0) << ")" << std::endl;
+    std::cout << "a1 (x11) = 0x" << std::hex << std::setw(8) << std::setfill('0')
+              << prog.a1 << " (" << std::dec << static_cast<int32_t>(prog.a1) << ")" << std::endl;
+
+    return 0;
+}
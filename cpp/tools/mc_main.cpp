@@ -0,0 +1,99 @@
+#include "multicore.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+void printUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " <inst_mem_file.txt> [options]" << std::endl;
+    std::cerr << "  --cores N          Harts, each with its hart id in a0 (default: 2)" << std::endl;
+    std::cerr << "  --threads N        Host threads, 0 = one per host CPU (default: 0)" << std::endl;
+    std::cerr << "  --quantum N        Cycles between barriers / store publication (default: 1)" << std::endl;
+    std::cerr << "  --cycles N         Maximum cycles (default: 20000)" << std::endl;
+    std::cerr << "  --deterministic    Single host thread, quantum 1 (debugging)" << std::endl;
+    std::cerr << "  --no-stop          Keep running after every hart halted" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    MultiCoreConfig cfg;
+    std::string inst_file;
+    uint64_t max_cycles = 20000;
+    bool stop_when_halted = true;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                printUsage(argv[0]);
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (a == "--cores") cfg.cores = std::stoi(next());
+        else if (a == "--threads") cfg.threads = std::stoi(next());
+        else if (a == "--quantum") cfg.quantum = std::stoull(next());
+        else if (a == "--cycles") max_cycles = std::stoull(next());
+        else if (a == "--deterministic") { cfg.threads = 1; cfg.quantum = 1; }
+        else if (a == "--no-stop") stop_when_halted = false;
+        else if (a == "-h" || a == "--help") { printUsage(argv[0]); return 0; }
+        else if (inst_file.empty() && a[0] != '-') inst_file = a;
+        else { printUsage(argv[0]); return 1; }
+    }
+
+    if (inst_file.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (cfg.cores < 1) {
+        std::cerr << "ERROR: --cores must be at least 1" << std::endl;
+        return 1;
+    }
+
+    MultiCore mc(cfg);
+    if (!mc.loadProgram(inst_file)) {
+        std::cerr << "ERROR: Failed to load program" << std::endl;
+        return 1;
+    }
+    mc.reset();
+    mc.run(max_cycles, stop_when_halted);
+
+    MultiCoreStats st = mc.getStats();
+    std::cout << "============================================================" << std::endl;
+    std::cout << "OOOP multi-core: " << mc.getNumCores() << " harts, "
+              << mc.getNumThreads() << " host threads, quantum " << cfg.quantum << std::endl;
+    std::cout << "============================================================" << std::endl;
+    std::cout << "hart  commits    ipc     recoveries  halted  a0          a1" << std::endl;
+
+    // Order-sensitive fingerprint of the final architectural and memory state
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&](uint32_t v) { hash = (hash ^ v) * 1099511628211ull; };
+
+    for (int h = 0; h < mc.getNumCores(); h++) {
+        const Core& c = mc.getCore(h);
+        uint32_t a0 = c.getArchRegValue(10);
+        uint32_t a1 = c.getArchRegValue(11);
+        std::cout << std::setw(4) << h << "  " << std::setw(9) << c.getCommitCount() << "  "
+                  << std::fixed << std::setprecision(3) << std::setw(6)
+                  << static_cast<double>(c.getCommitCount()) / std::max<uint64_t>(1, st.cycles)
+                  << "  " << std::setw(10) << c.getRecoverCount() << "  "
+                  << std::setw(6) << (c.isHalted() ? "yes" : "no") << "  0x"
+                  << std::hex << std::setw(8) << std::setfill('0') << a0 << "  0x"
+                  << std::setw(8) << a1 << std::dec << std::setfill(' ') << std::endl;
+        for (reg_t r = 1; r < N_ARCH_REGS; r++) mix(c.getArchRegValue(r));
+        mix(static_cast<uint32_t>(c.getCommitCount()));
+    }
+    for (int w = 0; w < SharedMem::DEPTH_WORDS; w++) mix(mc.readMemWord(w * 4));
+
+    std::cout << "------------------------------------------------------------" << std::endl;
+    std::cout << "cycles=" << st.cycles << " commits=" << st.commits << " recoveries="
+              << st.recoveries << " halted=" << st.halted << "/" << mc.getNumCores() << std::endl;
+    std::cout << "aggregate IPC = " << std::setprecision(3)
+              << static_cast<double>(st.commits) / std::max<uint64_t>(1, st.cycles) << std::endl;
+    std::cout << "state hash = 0x" << std::hex << std::setw(16) << std::setfill('0') << hash
+              << std::dec << std::setfill(' ') << std::endl;
+    std::cout << "host: " << std::setprecision(3) << st.host_sec << " s, "
+              << std::setprecision(1) << (st.cycles * mc.getNumCores()) / std::max(1e-9, st.host_sec) / 1e3
+              << " kHz core-cycles" << std::endl;
+
+    return 0;
+}
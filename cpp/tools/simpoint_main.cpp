@@ -0,0 +1,185 @@
+#include "simpoint.h"
+#include "rv32i.h"
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+void printUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [inst_mem_file.txt] [options]" << std::endl;
+    std::cerr << "  (no file: built-in three-phase loop program)" << std::endl;
+    std::cerr << "  --interval N       Instructions per interval (default: 1000)" << std::endl;
+    std::cerr << "  --max-insts N      Functional pass limit (default: 10000000)" << std::endl;
+    std::cerr << "  --max-k N          Largest cluster count tried (default: 10)" << std::endl;
+    std::cerr << "  --dims N           Random projection dimensions (default: 15)" << std::endl;
+    std::cerr << "  --warmup N         Detailed warmup instructions per pick (default: 500)" << std::endl;
+    std::cerr << "  --seed N           Projection / k-means seed (default: 1)" << std::endl;
+    std::cerr << "  --reps N           Outer iterations of the built-in program (default: 8)" << std::endl;
+    std::cerr << "  --bbv FILE         Write the BBVs in SimPoint .bb format" << std::endl;
+    std::cerr << "  --out PREFIX       Write PREFIX.simpoints and PREFIX.weights" << std::endl;
+    std::cerr << "  --full             Also run the whole program on Core and compare" << std::endl;
+    std::cerr << "  --tolerance X      With --full, max relative IPC error to pass (default: 0.05)" << std::endl;
+}
+
+// A dependent ALU chain, a load/store stream and a loop whose inner
+// branch is taken every other iteration, run back to back `reps` times
+std::vector<uint32_t> phasedProgram(int reps) {
+    std::vector<uint32_t> p;
+    auto back = [&](size_t target) { return -4 * static_cast<int32_t>(p.size() - target); };
+
+    p.push_back(rv32::addi(20, 0, reps));
+    size_t outer = p.size();
+
+    // Phase A: 300 x 10
+    p.push_back(rv32::addi(9, 0, 300));
+    size_t loop_a = p.size();
+    for (int i = 0; i < 4; i++) {
+        p.push_back(rv32::add(6, 5, 5));
+        p.push_back(rv32::addi(5, 6, -3));
+    }
+    p.push_back(rv32::addi(9, 9, -1));
+    p.push_back(rv32::branch(rv32::F3_BNE, 9, 0, back(loop_a)));
+
+    // Phase B: 200 x 10, two words per iteration over 2 KB
+    p.push_back(rv32::addi(9, 0, 200));
+    p.push_back(rv32::addi(7, 0, 0));
+    size_t loop_b = p.size();
+    p.push_back(rv32::lw(6, 7, 0));
+    p.push_back(rv32::lw(8, 7, 1024));
+    p.push_back(rv32::add(6, 6, 9));
+    p.push_back(rv32::add(8, 8, 6));
+    p.push_back(rv32::sw(6, 7, 0));
+    p.push_back(rv32::sw(8, 7, 1024));
+    p.push_back(rv32::addi(7, 7, 4));
+    p.push_back(rv32::andi(7, 7, 0x3FC));
+    p.push_back(rv32::addi(9, 9, -1));
+    p.push_back(rv32::branch(rv32::F3_BNE, 9, 0, back(loop_b)));
+
+    // Phase C: 250 x 4 or 6, the bne skips two instructions on odd counts
+    p.push_back(rv32::addi(9, 0, 250));
+    size_t loop_c = p.size();
+    p.push_back(rv32::andi(11, 9, 1));
+    p.push_back(rv32::branch(rv32::F3_BNE, 11, 0, 12));
+    p.push_back(rv32::addi(12, 12, 3));
+    p.push_back(rv32::add(13, 13, 12));
+    p.push_back(rv32::addi(9, 9, -1));
+    p.push_back(rv32::branch(rv32::F3_BNE, 9, 0, back(loop_c)));
+
+    p.push_back(rv32::addi(20, 20, -1));
+    p.push_back(rv32::branch(rv32::F3_BNE, 20, 0, back(outer)));
+
+    // a0 = x5 + x8 + x13, then park
+    p.push_back(rv32::add(10, 5, 8));
+    p.push_back(rv32::add(10, 10, 13));
+    p.push_back(rv32::jal(0, 0));
+    return p;
+}
+
+int main(int argc, char* argv[]) {
+    SimPointConfig cfg;
+    std::string inst_file;
+    std::string bbv_file;
+    std::string out_prefix;
+    int reps = 8;
+    bool full = false;
+    double tolerance = 0.05;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                printUsage(argv[0]);
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (a == "--interval") cfg.interval = std::stoull(next());
+        else if (a == "--max-insts") cfg.max_insts = std::stoull(next());
+        else if (a == "--max-k") cfg.max_k = std::stoi(next());
+        else if (a == "--dims") cfg.dims = std::stoi(next());
+        else if (a == "--warmup") cfg.warmup = std::stoull(next());
+        else if (a == "--seed") cfg.seed = std::stoul(next());
+        else if (a == "--reps") reps = std::stoi(next());
+        else if (a == "--bbv") bbv_file = next();
+        else if (a == "--out") out_prefix = next();
+        else if (a == "--full") full = true;
+        else if (a == "--tolerance") tolerance = std::stod(next());
+        else if (a == "-h" || a == "--help") { printUsage(argv[0]); return 0; }
+        else if (inst_file.empty() && a[0] != '-') inst_file = a;
+        else { printUsage(argv[0]); return 1; }
+    }
+
+    if (cfg.interval == 0 || cfg.max_k < 1 || cfg.dims < 1) {
+        std::cerr << "ERROR: --interval, --max-k and --dims must be positive" << std::endl;
+        return 1;
+    }
+
+    SimPoint sp(cfg);
+    if (inst_file.empty()) {
+        sp.loadProgramWords(phasedProgram(reps));
+    } else if (!sp.loadProgram(inst_file)) {
+        std::cerr << "ERROR: Failed to load program" << std::endl;
+        return 1;
+    }
+
+    sp.profile();
+    int k = sp.cluster();
+    sp.simulate();
+
+    if (!bbv_file.empty() && !sp.writeBBV(bbv_file)) {
+        std::cerr << "ERROR: Failed to write " << bbv_file << std::endl;
+        return 1;
+    }
+    if (!out_prefix.empty() && !sp.writeSimPoints(out_prefix)) {
+        std::cerr << "ERROR: Failed to write " << out_prefix << ".simpoints/.weights" << std::endl;
+        return 1;
+    }
+
+    const auto& ivs = sp.getIntervals();
+    std::cout << "============================================================" << std::endl;
+    std::cout << "OOOP SimPoint: " << (inst_file.empty() ? "built-in phased program" : inst_file)
+              << ", " << sp.getTotalInsts() << " instructions"
+              << (sp.isHalted() ? "" : " (not halted)") << std::endl;
+    std::cout << ivs.size() << " intervals of " << cfg.interval << ", "
+              << sp.getNumBlocks() << " basic blocks" << std::endl;
+    std::cout << "============================================================" << std::endl;
+
+    std::cout << std::fixed << std::setprecision(1) << "BIC:";
+    for (size_t i = 0; i < sp.getBIC().size(); i++) {
+        std::cout << " k" << (i + 1) << "=" << sp.getBIC()[i];
+    }
+    std::cout << std::endl << "k = " << k << std::endl;
+
+    std::cout << std::setw(10) << "interval" << std::setw(12) << "start"
+              << std::setw(9) << "cluster" << std::setw(9) << "weight"
+              << std::setw(10) << "cycles" << std::setw(8) << "IPC" << std::endl;
+    for (const SimPointPick& p : sp.getPicks()) {
+        std::cout << std::setw(10) << p.interval << std::setw(12) << ivs[p.interval].start
+                  << std::setw(9) << p.cluster << std::setprecision(3) << std::setw(9) << p.weight
+                  << std::setw(10) << p.cycles << std::setw(8) << p.ipc << std::endl;
+    }
+
+    double est = sp.estimateIPC();
+    double detailed = 100.0 * sp.getDetailedInsts() / sp.getTotalInsts();
+    std::cout << std::setprecision(4) << "estimated IPC = " << est << " ("
+              << sp.getDetailedInsts() << " detailed instructions, "
+              << std::setprecision(1) << detailed << "%)" << std::endl;
+
+    if (!full) {
+        return 0;
+    }
+
+    uint64_t cycles = 0;
+    double ipc = sp.fullIPC(&cycles);
+    double err = ipc > 0.0 ? std::fabs(est - ipc) / ipc : 1.0;
+    std::cout << std::setprecision(4) << "full IPC      = " << ipc << " (" << cycles
+              << " cycles), error " << std::setprecision(2) << 100.0 * err << "%" << std::endl;
+    if (err <= tolerance) {
+        std::cout << "SIMPOINT CHECK PASS (k = " << k << ", IPC error " << 100.0 * err << "%)" << std::endl;
+        return 0;
+    }
+    std::cout << "SIMPOINT CHECK FAIL (IPC error " << 100.0 * err << "% > "
+              << 100.0 * tolerance << "%)" << std::endl;
+    return 1;
+}
@@ -0,0 +1,225 @@
+#include "core.h"
+#include "iss.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+void printUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " <inst_mem_file.txt> [more files] [options]" << std::endl;
+    std::cerr << "  (thread t runs file t, reusing the list in turn; a0 = t)" << std::endl;
+    std::cerr << "  --threads N        Hardware threads, 1.." << Core::MAX_THREADS << " (default: 2)" << std::endl;
+    std::cerr << "  --fetch-policy P   rr or icount (default: rr)" << std::endl;
+    std::cerr << "  --rob M            shared or partitioned (default: shared)" << std::endl;
+    std::cerr << "  --walk W           ROB-walk recovery, W entries per cycle (default: 0, snapshots)" << std::endl;
+    std::cerr << "  --ras N            Per-thread JAL/JALR prediction, N-entry RAS (default: 0)" << std::endl;
+    std::cerr << "  --fetch-buffer N   Per-thread decoupled fetch buffer (default: 0)" << std::endl;
+    std::cerr << "  --move-elim        Move / zero-idiom elimination at rename" << std::endl;
+    std::cerr << "  --fuse             Macro-op fusion in decode, every rule" << std::endl;
+    std::cerr << "  --cycles N         Maximum cycles (default: 20000)" << std::endl;
+    std::cerr << "  --check            Require each thread's registers and memory to match its"
+              << std::endl;
+    std::cerr << "                     program run alone on Core for as many instructions" << std::endl;
+}
+
+namespace {
+
+struct Options {
+    int threads = 2;
+    FetchPolicy fetch_policy = FetchPolicy::ROUND_ROBIN;
+    bool partition_rob = false;
+    int walk = 0;
+    int ras = 0;
+    int fetch_buffer = 0;
+    bool move_elim = false;
+    uint32_t fuse = 0;
+};
+
+// The per-thread options; the SMT core also gets the arbitration ones
+void configure(Core& c, const Options& opt) {
+    c.setRecoveryWalk(opt.walk);
+    c.setRASDepth(opt.ras);
+    c.setFetchBuffer(opt.fetch_buffer);
+    c.setMoveElimination(opt.move_elim);
+    c.setFusion(opt.fuse);
+}
+
+// One program alone on Core with the same options, for as many
+// instructions as its thread committed (or up to its halt)
+struct AloneRun {
+    uint64_t cycles;
+    uint64_t commits;
+    uint64_t issues;
+    bool halted;
+    Core core;
+};
+
+void runAlone(AloneRun& r, const std::string& file, int thread, const Options& opt,
+              uint64_t commits, uint64_t max_cycles) {
+    Core& c = r.core;
+    c.loadProgram(file);
+    c.setHartId(static_cast<uint32_t>(thread));
+    configure(c, opt);
+    c.reset();
+    while (c.getCommitCount() < commits && !c.isHalted() && c.getCycleCount() < max_cycles) {
+        c.tick();
+    }
+    r.cycles = c.getCycleCount();
+    r.commits = c.getCommitCount();
+    r.issues = c.getActivity().rs_select;
+    r.halted = c.isHalted();
+}
+
+double ratio(uint64_t a, uint64_t b) {
+    return static_cast<double>(a) / static_cast<double>(std::max<uint64_t>(b, 1));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    std::vector<std::string> files;
+    uint64_t max_cycles = 20000;
+    bool check = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                printUsage(argv[0]);
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (a == "--threads") opt.threads = std::stoi(next());
+        else if (a == "--fetch-policy") {
+            std::string p = next();
+            if (p == "rr") opt.fetch_policy = FetchPolicy::ROUND_ROBIN;
+            else if (p == "icount") opt.fetch_policy = FetchPolicy::ICOUNT;
+            else { printUsage(argv[0]); return 1; }
+        }
+        else if (a == "--rob") {
+            std::string m = next();
+            if (m == "shared") opt.partition_rob = false;
+            else if (m == "partitioned") opt.partition_rob = true;
+            else { printUsage(argv[0]); return 1; }
+        }
+        else if (a == "--walk") opt.walk = std::stoi(next());
+        else if (a == "--ras") opt.ras = std::stoi(next());
+        else if (a == "--fetch-buffer") opt.fetch_buffer = std::stoi(next());
+        else if (a == "--move-elim") opt.move_elim = true;
+        else if (a == "--fuse") opt.fuse = (1u << N_FUSE_RULES) - 1;
+        else if (a == "--cycles") max_cycles = std::stoull(next());
+        else if (a == "--check") check = true;
+        else if (a == "-h" || a == "--help") { printUsage(argv[0]); return 0; }
+        else if (a[0] != '-') files.push_back(a);
+        else { printUsage(argv[0]); return 1; }
+    }
+
+    if (files.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (opt.threads < 1 || opt.threads > Core::MAX_THREADS) {
+        std::cerr << "ERROR: --threads must be 1.." << Core::MAX_THREADS << std::endl;
+        return 1;
+    }
+
+    Core smt;
+    smt.setThreads(opt.threads);
+    smt.setFetchPolicy(opt.fetch_policy);
+    smt.setROBPartition(opt.partition_rob);
+    configure(smt, opt);
+    int n = smt.getThreads();
+    for (int t = 0; t < n; t++) {
+        if (!smt.loadProgram(t, files[t % files.size()])) {
+            std::cerr << "ERROR: Failed to load " << files[t % files.size()] << std::endl;
+            return 1;
+        }
+    }
+    smt.reset();
+    while (smt.getCycleCount() < max_cycles && !smt.isHalted()) {
+        smt.tick();
+    }
+
+    std::vector<std::unique_ptr<AloneRun>> alone;
+    uint64_t alone_cycles = 0;
+    uint64_t alone_commits = 0;
+    uint64_t alone_issues = 0;
+    for (int t = 0; t < n; t++) {
+        alone.push_back(std::make_unique<AloneRun>());
+        runAlone(*alone[t], files[t % files.size()], t, opt, smt.getThreadStats(t).commits,
+                 max_cycles * n);
+        alone_cycles += alone[t]->cycles;
+        alone_commits += alone[t]->commits;
+        alone_issues += alone[t]->issues;
+    }
+
+    uint64_t cycles = smt.getCycleCount();
+    uint64_t commits = 0;
+    for (int t = 0; t < n; t++) {
+        commits += smt.getThreadStats(t).commits;
+    }
+    std::cout << "============================================================" << std::endl;
+    std::cout << "OOOP SMT: " << n << " threads, fetch "
+              << (opt.fetch_policy == FetchPolicy::ICOUNT ? "icount" : "round robin") << ", ROB "
+              << (opt.partition_rob ? "partitioned" : "shared") << ", recovery "
+              << (opt.walk > 0 ? "walk " + std::to_string(opt.walk) : std::string("snapshot"))
+              << std::endl;
+    std::cout << "============================================================" << std::endl;
+    std::cout << "thread  commits  cycles   ipc    alone-ipc  recoveries  fetch%  a0          a1"
+              << std::endl;
+    int failures = 0;
+    for (int t = 0; t < n; t++) {
+        const ThreadStats& st = smt.getThreadStats(t);
+        const AloneRun& r = *alone[t];
+        uint64_t tc = st.halt_cycle ? st.halt_cycle : cycles;
+        std::cout << std::setw(6) << t << "  " << std::setw(7) << st.commits << "  "
+                  << std::setw(6) << tc << std::fixed << std::setprecision(3) << "  "
+                  << std::setw(5) << ratio(st.commits, tc) << "  " << std::setw(9)
+                  << ratio(r.commits, r.cycles) << "  " << std::setw(10) << st.recoveries << "  "
+                  << std::setprecision(1) << std::setw(6) << 100.0 * ratio(st.fetches, cycles)
+                  << "  0x" << std::hex << std::setw(8) << std::setfill('0')
+                  << smt.getArchRegValue(t, 10) << "  0x" << std::setw(8)
+                  << smt.getArchRegValue(t, 11) << std::dec << std::setfill(' ')
+                  << (smt.isHalted(t) ? "" : "  (running)") << std::endl;
+
+        // Same instructions, same architectural outcome as alone
+        bool match = st.commits == r.commits && smt.isHalted(t) == r.halted;
+        for (reg_t reg = 1; reg < N_ARCH_REGS; reg++) {
+            match = match && smt.getArchRegValue(t, reg) == r.core.getArchRegValue(reg);
+        }
+        for (int w = 0; w < ISS::DMEM_WORDS; w++) {
+            match = match && smt.readMemWord(t, w * 4) == r.core.readMemWord(w * 4);
+        }
+        failures += !match;
+    }
+
+    std::cout << "------------------------------------------------------------" << std::endl;
+    std::cout << std::setprecision(3)
+              << "combined: cycles=" << cycles << " commits=" << commits
+              << " IPC=" << ratio(commits, cycles)
+              << " issue slots used=" << std::setprecision(1)
+              << 100.0 * ratio(smt.getActivity().rs_select, cycles) << "%" << std::endl;
+    std::cout << std::setprecision(3)
+              << "alone, back to back: cycles=" << alone_cycles
+              << " IPC=" << ratio(alone_commits, alone_cycles)
+              << " issue slots used=" << std::setprecision(1)
+              << 100.0 * ratio(alone_issues, alone_cycles) << "%" << std::endl;
+    std::cout << std::setprecision(3) << "SMT speedup = " << ratio(alone_cycles, cycles) << std::endl;
+
+    if (check) {
+        if (failures == 0) {
+            std::cout << "SMT CHECK PASS (" << n << " threads, " << commits
+                      << " commits in " << cycles << " cycles)" << std::endl;
+        } else {
+            std::cout << "SMT CHECK FAIL (" << failures << " of " << n
+                      << " threads differ from their run alone)" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -4,6 +4,10 @@ Compare Verilog and Python model outputs
 Helps identify where simulations diverge
 
 Usage: python3 compare_outputs.py verilog_output.txt python_output.txt
+       python3 compare_outputs.py verilog_output.txt --cpp inst_mem.txt [max_cycles]
+
+With --cpp the second side is the C++ model, run in-process via libooop.so
+(see ooop_lib.py) instead of a saved log.
 """
 
 import sys
@@ -32,12 +36,12 @@ def parse_output(filename):
                 results['commits'] = int(m.group(1))
             
             # Match a0
-            m = re.search(r'a0.*?(?:0x)?([0-9a-fA-F]+)', line, re.I)
+            m = re.search(r'\ba0\b[^=]*=\s*(?:0x)?([0-9a-fA-F]+)', line, re.I)
             if m:
                 results['a0'] = int(m.group(1), 16)
             
             # Match a1  
-            m = re.search(r'a1.*?(?:0x)?([0-9a-fA-F]+)', line, re.I)
+            m = re.search(r'\ba1\b[^=]*=\s*(?:0x)?([0-9a-fA-F]+)', line, re.I)
             if m:
                 results['a1'] = int(m.group(1), 16)
             
@@ -47,7 +51,22 @@ def parse_output(filename):
     
     return results
 
-def compare_results(verilog, python):
+def run_cpp(trace, max_cycles):
+    """Run the C++ model through libooop and return parse_output-style results"""
+    from ooop_lib import CppCore
+    core = CppCore()
+    core.load_program(trace)
+    core.step(max_cycles)
+    st = core.stats()
+    return {
+        'cycles': st['cycles'],
+        'commits': st['commits'],
+        'a0': core.arch_reg(10),
+        'a1': core.arch_reg(11),
+        'trace': []
+    }
+
+def compare_results(verilog, python, other_name="Python"):
     """Compare two result dictionaries"""
     print("="*60)
     print("COMPARISON RESULTS")
@@ -55,7 +74,7 @@ def compare_results(verilog, python):
     
     # Compare final values
     print("\\nFinal Values:")
-    print(f"{'Metric':<15} {'Verilog':<20} {'Python':<20} {'Match':<10}")
+    print(f"{'Metric':<15} {'Verilog':<20} {other_name:<20} {'Match':<10}")
     print("-"*60)
     
     def cmp(name, v_val, p_val):
@@ -97,13 +116,24 @@ if __name__ == '__main__':
         sys.exit(1)
     
     verilog_file = sys.argv[1]
-    python_file = sys.argv[2]
     
     print(f"Loading Verilog output: {verilog_file}")
     verilog = parse_output(verilog_file)
     
-    print(f"Loading Python output:  {python_file}")
-    python = parse_output(python_file)
+    if sys.argv[2] == '--cpp':
+        if len(sys.argv) < 4:
+            print(f"Usage: {sys.argv[0]} <verilog_output.txt> --cpp <inst_mem.txt> [max_cycles]")
+            sys.exit(1)
+        max_cycles = int(sys.argv[4]) if len(sys.argv) > 4 else 10000
+        print(f"Running C++ model:      {sys.argv[3]} ({max_cycles} cycles)")
+        other = run_cpp(sys.argv[3], max_cycles)
+        name = "C++"
+    else:
+        python_file = sys.argv[2]
+        print(f"Loading Python output:  {python_file}")
+        other = parse_output(python_file)
+        name = "Python"
     
     print()
-    compare_results(verilog, python)
+    ok = compare_results(verilog, other, name)
+    sys.exit(0 if ok else 1)
@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+"""
+ctypes wrapper for the C++ model's C API (cpp/libooop.so)
+
+Build the library first:  cd ../cpp && make lib
+Set OOOP_LIB to use a library somewhere else.
+
+Usage:
+    from ooop_lib import CppCore
+    core = CppCore()
+    core.load_program('../trace/25instMem-r.txt')
+    core.run_until_halt(20000)
+    print(hex(core.arch_reg(10)), core.stats())
+
+Run directly for the same report format as ooop_sim.py:
+    python3 ooop_lib.py <inst_mem.txt> [max_cycles]
+"""
+
+import ctypes
+import os
+import sys
+
+API_VERSION = 1
+
+UNTIL_HALT, UNTIL_COMMITS, UNTIL_PC, UNTIL_CYCLE = 0, 1, 2, 3
+RS_ALU, RS_BRU, RS_LSU, RS_MDU = 0, 1, 2, 3
+
+
+class Stats(ctypes.Structure):
+    _fields_ = [('cycles', ctypes.c_uint64),
+                ('commits', ctypes.c_uint64),
+                ('recoveries', ctypes.c_uint64),
+                ('last_commit_pc', ctypes.c_uint32),
+                ('halted', ctypes.c_uint32)]
+
+    def as_dict(self):
+        return {name: getattr(self, name) for name, _ in self._fields_}
+
+
+PREDICATE = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p)
+
+_lib = None
+
+
+def load_library(path=None):
+    """Load libooop.so once and declare the function signatures"""
+    global _lib
+    if _lib is not None:
+        return _lib
+
+    if path is None:
+        here = os.path.dirname(os.path.abspath(__file__))
+        path = os.environ.get('OOOP_LIB', os.path.join(here, '..', 'cpp', 'libooop.so'))
+    lib = ctypes.CDLL(path)
+
+    P = ctypes.c_void_p
+    U32, U64, UINT, INT = ctypes.c_uint32, ctypes.c_uint64, ctypes.c_uint, ctypes.c_int
+    sigs = {
+        'ooop_api_version': (INT, []),
+        'ooop_create': (P, []),
+        'ooop_destroy': (None, [P]),
+        'ooop_reset': (None, [P]),
+        'ooop_load_program': (INT, [P, ctypes.c_char_p]),
+        'ooop_load_words': (INT, [P, ctypes.POINTER(U32), ctypes.c_size_t]),
+        'ooop_step': (U64, [P, U64]),
+        'ooop_run_until': (U64, [P, INT, U64, U64]),
+        'ooop_run_while': (U64, [P, PREDICATE, P, U64]),
+        'ooop_arch_reg': (U32, [P, UINT]),
+        'ooop_arch_mapping': (UINT, [P, UINT]),
+        'ooop_phys_reg': (U32, [P, UINT]),
+        'ooop_phys_valid': (INT, [P, UINT]),
+        'ooop_read_mem': (U32, [P, U32]),
+        'ooop_rob_count': (INT, [P]),
+        'ooop_rs_count': (INT, [P, INT]),
+        'ooop_get_stats': (None, [P, ctypes.POINTER(Stats)]),
+        'ooop_time_travel': (INT, [P, U64, INT]),
+        'ooop_goto_cycle': (INT, [P, U64]),
+        'ooop_step_back': (INT, [P, U64]),
+        'ooop_state_hash': (U64, [P]),
+    }
+    for name, (res, args) in sigs.items():
+        fn = getattr(lib, name)
+        fn.restype = res
+        fn.argtypes = args
+
+    if lib.ooop_api_version() != API_VERSION:
+        raise RuntimeError(f"libooop API version {lib.ooop_api_version()}, expected {API_VERSION}")
+
+    _lib = lib
+    return lib
+
+
+class CppCore:
+    """One simulated core in the C++ model"""
+
+    def __init__(self, lib_path=None):
+        self._lib = load_library(lib_path)
+        self._h = self._lib.ooop_create()
+        if not self._h:
+            raise MemoryError("ooop_create failed")
+
+    def close(self):
+        if self._h:
+            self._lib.ooop_destroy(self._h)
+            self._h = None
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    # Program / control
+    def load_program(self, fname):
+        if self._lib.ooop_load_program(self._h, fname.encode()) != 0:
+            raise IOError(f"could not load {fname}")
+        self.reset()
+
+    def load_words(self, words):
+        arr = (ctypes.c_uint32 * len(words))(*words)
+        if self._lib.ooop_load_words(self._h, arr, len(words)) != 0:
+            raise ValueError("ooop_load_words failed")
+        self.reset()
+
+    def reset(self):
+        self._lib.ooop_reset(self._h)
+
+    def step(self, cycles=1):
+        return self._lib.ooop_step(self._h, cycles)
+
+    def run_until(self, cond, arg=0, max_cycles=1 << 32):
+        return self._lib.ooop_run_until(self._h, cond, arg, max_cycles)
+
+    def run_until_halt(self, max_cycles=1 << 32):
+        return self.run_until(UNTIL_HALT, 0, max_cycles)
+
+    def run_while(self, pred, max_cycles=1 << 32):
+        """pred(core) -> bool, checked every cycle (slow: one Python call per cycle)"""
+        cb = PREDICATE(lambda _h, _u: 1 if pred(self) else 0)
+        return self._lib.ooop_run_while(self._h, cb, None, max_cycles)
+
+    # Time travel
+    def time_travel(self, interval=1000, max_snapshots=32):
+        """Snapshot every interval cycles from now on (0 disables)"""
+        if self._lib.ooop_time_travel(self._h, interval, max_snapshots) != 0:
+            raise MemoryError("ooop_time_travel failed")
+
+    def goto_cycle(self, cycle):
+        if self._lib.ooop_goto_cycle(self._h, cycle) != 0:
+            raise ValueError(f"cannot go to cycle {cycle} (time travel off or no snapshot that old)")
+
+    def step_back(self, cycles=1):
+        if self._lib.ooop_step_back(self._h, cycles) != 0:
+            raise ValueError(f"cannot step back {cycles} cycles")
+
+    def state_hash(self):
+        return self._lib.ooop_state_hash(self._h)
+
+    # State
+    def arch_reg(self, r):
+        return self._lib.ooop_arch_reg(self._h, r)
+
+    def arch_regs(self):
+        return [self.arch_reg(r) for r in range(32)]
+
+    def arch_mapping(self, r):
+        return self._lib.ooop_arch_mapping(self._h, r)
+
+    def phys_reg(self, p):
+        return self._lib.ooop_phys_reg(self._h, p)
+
+    def phys_valid(self, p):
+        return bool(self._lib.ooop_phys_valid(self._h, p))
+
+    def read_mem(self, addr):
+        return self._lib.ooop_read_mem(self._h, addr)
+
+    def rob_count(self):
+        return self._lib.ooop_rob_count(self._h)
+
+    def rs_count(self, rs):
+        return self._lib.ooop_rs_count(self._h, rs)
+
+    def stats(self):
+        s = Stats()
+        self._lib.ooop_get_stats(self._h, ctypes.byref(s))
+        return s.as_dict()
+
+
+def s32(val):
+    return val - (1 << 32) if val & 0x80000000 else val
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        print(f"Usage: {sys.argv[0]} <inst_mem.txt> [max_cycles]")
+        sys.exit(1)
+
+    core = CppCore()
+    core.load_program(sys.argv[1])
+
+    max_cyc = int(sys.argv[2]) if len(sys.argv) > 2 else 20000
+    core.step(max_cyc)
+    st = core.stats()
+
+    print(f"\n{'='*60}")
+    print(f"FINAL @ cycle={st['cycles']} commits={st['commits']}")
+    print(f"a0 (x10) = 0x{core.arch_reg(10):08x} ({s32(core.arch_reg(10))})")
+    print(f"a1 (x11) = 0x{core.arch_reg(11):08x} ({s32(core.arch_reg(11))})")
+    print('='*60)